@@ -1,32 +1,150 @@
-"""Converts resource files into C++ code to be embedded in the compiled binary."""
-
-import json
-
-def generate_code():
-    """Create Resource.cc containing all the binary data from files listed in reouces.json"""
-    with open("resources.json", 'r') as file:
-        resource_list = json.load(file)
-
-    with open('src/Resources.cc', 'w') as output:
-        print('#include "Resources.hh"\n', file=output)
-        print('using namespace Animate;\n', file=output)
-        print('std::map<std::string,std::vector<uint8_t> > Resources::resources;\n', file=output)
-        print('void Resources::initialise(){', file=output)
-        i = 0
-        for path in resource_list:
-            print('std::vector<uint8_t> data_%d = {' % i, file=output)
-            with open(path, "rb") as resource:
-                data = resource.read()
-                byte_data = bytearray(data)
-                print(', '.join("0x%02x" % x for x in byte_data), file=output)
-            print('\n};', file=output)
-            print(
-                'Resources::resources.insert('
-                + 'std::pair<std::string,std::vector<uint8_t> >("%s", data_%d));'
-                % (path, i),
-                file=output
-            )
-            i += 1
-        print('}', file=output)
-
-generate_code()
+"""Packs resource files into a single binary to be embedded in the compiled binary.
+
+Layout, all integers little endian:
+    header      magic "ANPK", version, entry count, string table size, data offset, total size
+    index       one entry per resource: name offset, name length, data offset, data size, crc32, alignment, type
+    strings     resource names, not null terminated
+    data        resource contents, each starting on an ALIGNMENT byte boundary
+
+Offsets are relative to the start of the pack. Must match src/Resources.hh.
+
+Images are baked into block compressed textures (see src/VK/TextureContainer.hh)
+by the texture-baker tool, whose path is given as the first argument. They keep
+their original resource names.
+
+Resources named like data/Cat/pattern-4x4.pdb aren't files, they're sliding
+puzzle pattern databases (see src/Animation/Cat/PatternDatabaseFormat.hh) built
+for that board size by the pattern-db-builder tool given as the second argument.
+
+Usage: python3 GenerateResources.py <path to texture-baker> <path to pattern-db-builder>
+"""
+
+import concurrent.futures
+import json
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+
+MAGIC = b"ANPK"
+VERSION = 2
+ALIGNMENT = 64
+
+HEADER_FORMAT = "<4sIIIQQ"
+ENTRY_FORMAT = "<IIQQIHH"
+
+TYPE_RAW = 0
+TYPE_TEXTURE = 1
+
+IMAGE_EXTENSIONS = (".jpg", ".jpeg", ".png")
+PATTERN_DATABASE = re.compile(r"pattern-(\d+)x\1\.pdb$")
+
+
+def align(offset, alignment=ALIGNMENT):
+    """Round an offset up to the next multiple of the alignment."""
+    return (offset + alignment - 1) // alignment * alignment
+
+
+def bake_texture(baker, path):
+    """Run the texture baker on an image, returning the baked texture."""
+    with tempfile.TemporaryDirectory() as directory:
+        output_path = os.path.join(directory, "texture")
+        subprocess.run([baker, path, output_path], check=True)
+        with open(output_path, "rb") as output:
+            return output.read()
+
+
+def build_pattern_database(builder, width):
+    """Run the pattern database builder for a board size, returning the databases."""
+    with tempfile.TemporaryDirectory() as directory:
+        output_path = os.path.join(directory, "patterns")
+        subprocess.run([builder, width, output_path], check=True)
+        with open(output_path, "rb") as output:
+            return output.read()
+
+
+def generate_pack(baker, builder):
+    """Create resources.pack containing all the files listed in resources.json"""
+    with open("resources.json", 'r') as file:
+        resource_list = json.load(file)
+
+    names = [path.encode("utf-8") for path in resource_list]
+    images = [path for path in resource_list if path.lower().endswith(IMAGE_EXTENSIONS)]
+    if images and baker is None:
+        sys.exit("A texture baker is needed to pack " + images[0])
+
+    databases = {path: PATTERN_DATABASE.search(path) for path in resource_list}
+    databases = {path: match.group(1) for path, match in databases.items() if match}
+    if databases and builder is None:
+        sys.exit("A pattern database builder is needed to pack " + next(iter(databases)))
+
+    # Block compression and database building are slow, so they run in parallel
+    with concurrent.futures.ThreadPoolExecutor() as executor:
+        baked = dict(zip(images, executor.map(lambda path: bake_texture(baker, path), images)))
+        built = dict(zip(databases, executor.map(lambda width: build_pattern_database(builder, width), databases.values())))
+
+    blobs = []
+    types = []
+    for path in resource_list:
+        if path in baked:
+            blobs.append(baked[path])
+            types.append(TYPE_TEXTURE)
+        elif path in built:
+            blobs.append(built[path])
+            types.append(TYPE_RAW)
+        else:
+            with open(path, "rb") as resource:
+                blobs.append(resource.read())
+            types.append(TYPE_RAW)
+
+    string_table = b"".join(names)
+    index_offset = struct.calcsize(HEADER_FORMAT)
+    string_offset = index_offset + struct.calcsize(ENTRY_FORMAT) * len(names)
+    data_offset = align(string_offset + len(string_table))
+
+    entries = []
+    name_offset = 0
+    offset = data_offset
+    for name, blob, resource_type in zip(names, blobs, types):
+        offset = align(offset)
+        entries.append(struct.pack(
+            ENTRY_FORMAT,
+            name_offset,
+            len(name),
+            offset,
+            len(blob),
+            zlib.crc32(blob) & 0xffffffff,
+            ALIGNMENT,
+            resource_type
+        ))
+        name_offset += len(name)
+        offset += len(blob)
+
+    total_size = offset
+
+    with open("resources.pack", "wb") as output:
+        output.write(struct.pack(
+            HEADER_FORMAT,
+            MAGIC,
+            VERSION,
+            len(entries),
+            len(string_table),
+            data_offset,
+            total_size
+        ))
+        output.write(b"".join(entries))
+        output.write(string_table)
+
+        for entry, blob in zip(entries, blobs):
+            blob_offset = struct.unpack(ENTRY_FORMAT, entry)[2]
+            output.write(b"\0" * (blob_offset - output.tell()))
+            output.write(blob)
+
+
+generate_pack(
+    sys.argv[1] if len(sys.argv) > 1 else None,
+    sys.argv[2] if len(sys.argv) > 2 else None
+)
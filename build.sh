@@ -1,8 +1,9 @@
 #!/bin/sh
 
 autoreconf --install;
-find ./data -regex ".*shader\.\(frag\|vert\)" -exec glslangValidator -V \{\} -o \{\}.spv  \;
-python3 GenerateResources.py
+find ./data -regex ".*\.\(frag\|vert\|comp\)" -exec glslangValidator -V \{\} -o \{\}.spv  \;
 ./configure;
+make -C src texture-baker pattern-db-builder;
+python3 GenerateResources.py src/texture-baker src/pattern-db-builder;
 make;
 make check;
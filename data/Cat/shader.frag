@@ -1,13 +1,19 @@
 #version 450
 
+layout (constant_id = 0) const uint TEXTURE_SLOTS = 1;
+
 layout (location = 1) in vec3 tex_coords;
 layout (location = 3) in vec4 colour;
 
 layout (location = 0) out vec4 output_colour;
 
-layout(binding = 1) uniform sampler2DArray tex;
+layout (push_constant) uniform texture_slot {
+    layout (offset = 64) uint slot;
+} push_constants;
+
+layout (set = 1, binding = 0) uniform sampler2DArray textures[TEXTURE_SLOTS];
 
 void main() {
-    vec4 tex = texture(tex, tex_coords);
+    vec4 tex = texture(textures[push_constants.slot], tex_coords);
     output_colour = colour*tex;
 }
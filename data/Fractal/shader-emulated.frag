@@ -0,0 +1,87 @@
+#version 450
+
+precision highp float;
+layout (location = 0) in vec3 vertex;
+layout (location = 0) out vec4 output_colour;
+
+//View parameters, each double is split into a high and low float
+layout (binding = 0) uniform variables {
+    vec2 centre_x;
+    vec2 centre_y;
+    vec2 scale;
+    float rotation;
+    int max_iterations;
+} uniforms;
+
+//Double-float arithmetic, a value is the unevaluated sum of its high (x) and low (y) parts.
+//The error terms rely on exact rounding so every step is marked precise.
+vec2 quick_two_sum(float a, float b) {
+	precise float s = a + b;
+	precise float e = b - (s - a);
+	return vec2(s, e);
+}
+
+vec2 two_sum(float a, float b) {
+	precise float s = a + b;
+	precise float v = s - a;
+	precise float e = (a - (s - v)) + (b - v);
+	return vec2(s, e);
+}
+
+vec2 two_product(float a, float b) {
+	precise float p = a * b;
+	precise float e = fma(a, b, -p);
+	return vec2(p, e);
+}
+
+vec2 df_add(vec2 a, vec2 b) {
+	precise vec2 s = two_sum(a.x, b.x);
+	precise float e = s.y + a.y + b.y;
+	return quick_two_sum(s.x, e);
+}
+
+vec2 df_mul(vec2 a, vec2 b) {
+	precise vec2 p = two_product(a.x, b.x);
+	precise float e = p.y + (a.x*b.y + a.y*b.x);
+	return quick_two_sum(p.x, e);
+}
+
+void main() {
+	//Rotate the position on the quad about its centre, this is fine in single precision
+	vec2 offset = vertex.xy - vec2(0.5);
+	float s = sin(uniforms.rotation);
+	float k = cos(uniforms.rotation);
+	offset = vec2(offset.x*k - offset.y*s, offset.x*s + offset.y*k);
+
+	//Scale into the complex plane in double-float precision
+	vec2 cx = df_add(uniforms.centre_x, df_mul(uniforms.scale, vec2(offset.x, 0.0)));
+	vec2 cy = df_add(uniforms.centre_y, df_mul(uniforms.scale, vec2(offset.y, 0.0)));
+	vec2 px = cx;
+	vec2 py = cy;
+
+	//Set default color to HSV value for black
+	vec3 color=vec3(0.0,0.0,0.0);
+
+	for(int i=0;i<uniforms.max_iterations;i++){
+		//Perform complex number arithmetic
+		vec2 xx = df_mul(px, px);
+		vec2 yy = df_mul(py, py);
+		vec2 xy = df_mul(px, py);
+		px = df_add(df_add(xx, -yy), cx);
+		py = df_add(df_add(xy, xy), cy);
+
+		float magnitude = px.x*px.x + py.x*py.x;
+		if (magnitude>4.0){
+			//The point, c, is not part of the set, so smoothly color it. colorRegulator increases linearly by 1 for every extra step it takes to break free.
+			float colorRegulator = float(i-1)-log(((log(magnitude))/log(2.0)))/log(2.0);
+			color = vec3(0.95 + .012*colorRegulator , 1.0, .2+.4*(1.0+sin(.3*colorRegulator)));
+			break;
+		}
+	}
+	//Change color from HSV to RGB. Algorithm from https://gist.github.com/patriciogonzalezvivo/114c1653de9e3da6e1e3
+	vec4 K = vec4(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
+	vec3 m = abs(fract(color.xxx + K.xyz) * 6.0 - K.www);
+	output_colour.rgb = color.z * mix(K.xxx, clamp(m - K.xxx, 0.0, 1.0), color.y);
+
+	output_colour.a=1.0;
+}
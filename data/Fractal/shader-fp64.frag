@@ -0,0 +1,53 @@
+#version 450
+
+precision highp float;
+layout (location = 0) in vec3 vertex;
+layout (location = 0) out vec4 output_colour;
+
+//View parameters, each double is split into a high and low float
+layout (binding = 0) uniform variables {
+    vec2 centre_x;
+    vec2 centre_y;
+    vec2 scale;
+    float rotation;
+    int max_iterations;
+} uniforms;
+
+double join(vec2 value) {
+    return double(value.x) + double(value.y);
+}
+
+void main() {
+	//Rotate the position on the quad about its centre, this is fine in single precision
+	vec2 offset = vertex.xy - vec2(0.5);
+	float s = sin(uniforms.rotation);
+	float k = cos(uniforms.rotation);
+	offset = vec2(offset.x*k - offset.y*s, offset.x*s + offset.y*k);
+
+	//Scale into the complex plane in double precision
+	double scale = join(uniforms.scale);
+	dvec2 c = dvec2(join(uniforms.centre_x), join(uniforms.centre_y)) + dvec2(offset)*scale;
+	dvec2 p = c;
+
+	//Set default color to HSV value for black
+	vec3 color=vec3(0.0,0.0,0.0);
+
+	for(int i=0;i<uniforms.max_iterations;i++){
+		//Perform complex number arithmetic
+		p = dvec2(p.x*p.x-p.y*p.y,2.0*p.x*p.y)+c;
+
+		float magnitude = float(dot(p,p));
+		if (magnitude>4.0){
+			//The point, c, is not part of the set, so smoothly color it. colorRegulator increases linearly by 1 for every extra step it takes to break free.
+			float colorRegulator = float(i-1)-log(((log(magnitude))/log(2.0)))/log(2.0);
+			color = vec3(0.95 + .012*colorRegulator , 1.0, .2+.4*(1.0+sin(.3*colorRegulator)));
+			break;
+		}
+	}
+	//Change color from HSV to RGB. Algorithm from https://gist.github.com/patriciogonzalezvivo/114c1653de9e3da6e1e3
+	vec4 K = vec4(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
+	vec3 m = abs(fract(color.xxx + K.xyz) * 6.0 - K.www);
+	output_colour.rgb = color.z * mix(K.xxx, clamp(m - K.xxx, 0.0, 1.0), color.y);
+
+	output_colour.a=1.0;
+}
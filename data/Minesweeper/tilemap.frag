@@ -0,0 +1,44 @@
+#version 450
+
+layout (constant_id = 0) const uint TEXTURE_SLOTS = 1;
+
+//Most kinds of cell, matches TileMap::max_tile_types
+const uint TILE_TYPES = 32;
+
+layout (location = 1) in vec3 tex_coords;
+layout (location = 3) in vec4 colour;
+
+layout (location = 0) out vec4 output_colour;
+
+layout (push_constant) uniform texture_slot {
+    layout (offset = 64) uint slot;
+} push_constants;
+
+//Grid size and where each kind of cell's image is
+layout (set = 0, binding = 0) uniform tile_types {
+    uvec2 size;
+    vec4 regions[TILE_TYPES];
+    vec4 pages[TILE_TYPES];
+} tile_map;
+
+//The kind of each cell
+layout (set = 0, binding = 1) uniform usampler2D cells;
+
+layout (set = 1, binding = 0) uniform sampler2DArray textures[TEXTURE_SLOTS];
+
+void main() {
+    //Cells are numbered from the bottom row up, images are sampled from the top down
+    vec2 position = vec2(tex_coords.x, 1. - tex_coords.y) * vec2(tile_map.size);
+    uvec2 cell = min(uvec2(position), tile_map.size - 1);
+    uint type = min(texelFetch(cells, ivec2(cell), 0).r, TILE_TYPES - 1);
+
+    vec4 region = tile_map.regions[type];
+    vec2 within = vec2(fract(position.x), 1. - fract(position.y));
+    vec3 coords = vec3(region.xy + within * region.zw, tile_map.pages[type].x);
+
+    //Take derivatives before wrapping, so the mip level doesn't jump at cell edges
+    vec2 scale = region.zw * vec2(1., -1.);
+    vec4 tex = textureGrad(textures[push_constants.slot], coords, dFdx(position) * scale, dFdy(position) * scale);
+
+    output_colour = colour*tex;
+}
@@ -0,0 +1,10 @@
+#version 450
+
+layout (binding = 1) uniform sampler2D noise;
+
+layout (location = 0) out vec4 out_colour;
+
+void main() {
+    //The noise image matches the swap chain, so each pixel reads exactly one texel
+    out_colour = texelFetch(noise, ivec2(gl_FragCoord.xy), 0);
+}
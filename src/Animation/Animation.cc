@@ -1,9 +1,11 @@
 #include <iostream>
 #include <stdlib.h>
-#include <unistd.h>
+#include <chrono>
 
 #include "Animation.hh"
 #include "Utilities.hh"
+#include "../VK/Pipeline.hh"
+#include "../VK/TextureCache.hh"
 
 using namespace Animate::Animation;
 using namespace Animate::Object;
@@ -22,29 +24,156 @@ Animation::~Animation()
 {
 }
 
-void Animation::load()
+/**
+ * Get ready to be shown on the thread pool: make the textures resident then run on_load.
+ * Does nothing if already prepared or preparing, so the animation after the current one can
+ * be prepared while the current one plays and switching to it is immediate.
+ *
+ * @param thread_pool The pool to prepare on, which outlives the animation.
+ */
+void Animation::prepare(Tasks::ThreadPool &thread_pool)
 {
-    std::thread load_thread(&Animation::on_load, this);
-    load_thread.detach();
+    std::lock_guard<std::mutex> guard(this->preparation_mutex);
+    this->wanted = true;
+
+    if (this->preparation.valid()) {
+        return;
+    }
+
+    this->preparation = thread_pool.submit([this]() {
+        this->pin_textures();
+        this->on_load();
+
+        //Unloaded while preparing, give up the textures and start over next time
+        std::lock_guard<std::mutex> guard(this->preparation_mutex);
+        if (!this->wanted) {
+            this->unpin_textures();
+            this->preparation = std::shared_future<void>();
+        }
+    }).share();
 }
 
 /**
- * Perform functions in the tick thread that should occur before we call ourselves "loaded".
+ * Perform functions that should occur before we call ourselves "loaded".
+ * Runs on the thread pool.
  */
 void Animation::on_load()
 {
-    usleep(300000);
-    this->loaded = true;
 }
 
+/**
+ * Stop being shown, the textures may be evicted from now on.
+ * A preparation still running finishes in the background.
+ */
 void Animation::unload()
 {
-    this->loaded = false;
+    std::lock_guard<std::mutex> guard(this->preparation_mutex);
+    this->wanted = false;
+
+    if (this->preparation.valid() && this->preparation.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        this->unpin_textures();
+        this->preparation = std::shared_future<void>();
+    }
 }
 
+/**
+ * Whether preparation has finished, rethrowing anything it threw.
+ */
 bool Animation::check_loaded()
 {
-    return this->loaded;
+    std::lock_guard<std::mutex> guard(this->preparation_mutex);
+
+    if (!this->wanted || !this->preparation.valid()) {
+        return false;
+    }
+
+    if (this->preparation.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return false;
+    }
+
+    this->preparation.get();
+    return true;
+}
+
+/**
+ * The textures of every pipeline this animation created.
+ */
+std::vector< std::shared_ptr<Animate::VK::Textures> > Animation::get_textures()
+{
+    std::vector< std::shared_ptr<VK::Textures> > textures;
+
+    for (auto const& pipeline : this->pipelines) {
+        if (std::shared_ptr<VK::Pipeline> shared_pipeline = pipeline.lock()) {
+            if (std::shared_ptr<VK::Textures> pipeline_textures = shared_pipeline->get_textures().lock()) {
+                textures.push_back(pipeline_textures);
+            }
+        }
+    }
+
+    return textures;
+}
+
+/**
+ * Create a pipeline through the graphics context, tracking its textures for residency.
+ */
+std::weak_ptr<Animate::VK::Pipeline> Animation::create_pipeline(
+    std::string fragment_code_id,
+    std::string vertex_code_id,
+    std::vector<std::string> resources,
+    size_t uniform_size,
+    VK::RenderSettings settings
+) {
+    std::weak_ptr<VK::Pipeline> pipeline = this->context.lock()->get_graphics_context().lock()->create_pipeline(
+        fragment_code_id,
+        vertex_code_id,
+        resources,
+        uniform_size,
+        settings
+    );
+
+    this->pipelines.push_back(pipeline);
+
+    return pipeline;
+}
+
+/**
+ * Keep this animation's textures on the GPU while it's loaded, loading any that were evicted.
+ */
+void Animation::pin_textures()
+{
+    std::shared_ptr<VK::TextureCache> texture_cache =
+        this->context.lock()->get_graphics_context().lock()->get_texture_cache();
+    std::vector< std::shared_ptr<VK::Textures> > textures = this->get_textures();
+
+    {
+        std::lock_guard<std::mutex> guard(this->residency_mutex);
+        if (this->textures_pinned) {
+            return;
+        }
+
+        texture_cache->pin(textures);
+        this->textures_pinned = true;
+    }
+
+    //Outside the lock so unloading doesn't wait for the upload
+    texture_cache->load(textures);
+}
+
+/**
+ * Let the cache evict this animation's textures once it needs the room.
+ */
+void Animation::unpin_textures()
+{
+    std::shared_ptr<VK::TextureCache> texture_cache =
+        this->context.lock()->get_graphics_context().lock()->get_texture_cache();
+
+    std::lock_guard<std::mutex> guard(this->residency_mutex);
+    if (!this->textures_pinned) {
+        return;
+    }
+
+    texture_cache->unpin(this->get_textures());
+    this->textures_pinned = false;
 }
 
 /**
@@ -3,6 +3,9 @@
 #include <thread>
 #include <string>
 #include <atomic>
+#include <mutex>
+#include <vector>
+#include <future>
 
 #include "../AppContext.hh"
 #include "../Object/Object.hh"
@@ -15,13 +18,15 @@ namespace Animate::Animation
             Animation(std::weak_ptr<AppContext> context);
             ~Animation();
 
-            void load();
+            void prepare(Tasks::ThreadPool &thread_pool);
             virtual void on_tick(uint64_t time_delta);
             virtual void initialise() = 0;
 
             bool check_loaded();
             void unload();
 
+            std::vector< std::shared_ptr<VK::Textures> > get_textures();
+
         protected:
             std::weak_ptr<AppContext> context;
             std::map< std::string, std::shared_ptr<Object::Object> > objects;
@@ -31,9 +36,28 @@ namespace Animate::Animation
             bool object_exists(std::string name);
             void clear_objects();
 
+            std::weak_ptr<VK::Pipeline> create_pipeline(
+                std::string fragment_code_id,
+                std::string vertex_code_id,
+                std::vector<std::string> resources = {},
+                size_t uniform_size = sizeof(float),
+                VK::RenderSettings settings = VK::RenderSettings()
+            );
+
             virtual void on_load();
 
         private:
-            std::atomic_bool loaded = false;
+            //Guards the preparation and whether it's still wanted
+            std::mutex preparation_mutex;
+            std::shared_future<void> preparation;
+            bool wanted = false;
+
+            //Pipelines created by this animation, their textures are pinned while it's loaded
+            std::vector< std::weak_ptr<VK::Pipeline> > pipelines;
+            std::mutex residency_mutex;
+            bool textures_pinned = false;
+
+            void pin_textures();
+            void unpin_textures();
     };
 }
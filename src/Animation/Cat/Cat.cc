@@ -20,8 +20,12 @@ using namespace Animate::Object;
 /**
  * Constructor.
  * Seed the RNG.
+ *
+ * @param playback_settings How quickly solutions are played.
  */
-Cat::Cat(std::weak_ptr<AppContext> context) : Animation::Animation(context)
+Cat::Cat(std::weak_ptr<AppContext> context, PlaybackSettings playback_settings) :
+    Animation::Animation(context),
+    playback(playback_settings)
 {
     srand(time(NULL));
 }
@@ -32,7 +36,7 @@ Cat::Cat(std::weak_ptr<AppContext> context) : Animation::Animation(context)
 void Cat::initialise()
 {
     //Set shaders
-    this->shader = this->context.lock()->get_graphics_context().lock()->create_pipeline(
+    this->shader = this->create_pipeline(
         "data/Cat/shader.frag.spv",
         "data/Cat/shader.vert.spv",
         {
@@ -43,7 +47,9 @@ void Cat::initialise()
             "data/Cat/4.jpg",
             "data/Cat/5.jpg",
             "data/Cat/6.jpg"
-        }
+        },
+        sizeof(float),
+        VK::RenderSettings::streamed()
     );
 
     //Look at
@@ -56,16 +62,20 @@ void Cat::initialise()
     Matrix projection_matrix = Matrix::orthographic(0, this->grid_size, 0, this->grid_size, 0, 1);
 
     this->shader.lock()->set_matrices(view_matrix, projection_matrix);
+
+    this->solver = std::make_unique<Solver>(this->grid_size);
 }
 
 /**
  * Recreate the appropriate tiles in their new positions, ready to be solved.
+ *
+ * @param move_sequence The solution to play.
  */
-void Cat::reset_puzzle()
+void Cat::reset_puzzle(std::queue<TaquinSolve::Moves> move_sequence)
 {
     //Clear tiles
     this->clear_objects();
-    this->tile_position_map.clear();
+    this->tiles.assign(this->grid_size * this->grid_size, nullptr);
 
     //Set puzzle values
     std::string texture_name = "data/Cat/" + std::to_string(this->texture_index++) + ".jpg";
@@ -78,21 +88,27 @@ void Cat::reset_puzzle()
     std::shared_ptr<Pipeline> pipeline = this->shader.lock();
     for (int i = 0; i < this->grid_size * this->grid_size; i++) {
         if (this->initial_position[i] == 0) {
-            this->zero_position = i;
             continue;
         }
         tile = new Tile(graphics_context, Point(), Scale(1., 1., 1.));
         tile->initialise(
             pipeline,
-            pipeline->get_textures().lock()->get_layer(texture_name),
+            pipeline->get_textures().lock()->get_region(texture_name),
             this->initial_position[i], //board position
             this->grid_size  //Grid size
         );
         tile->set_board_position(Position(i%this->grid_size, i/this->grid_size));
+        tile->set_model_matrix(Matrix::identity());
 
         this->add_object("tile"+std::to_string(i), tile);
-        this->tile_position_map.insert(std::pair<int, Tile *> (i, tile));
+        this->tiles[this->initial_position[i]] = tile;
     }
+
+    this->playback.start(
+        std::vector<uint32_t>(this->initial_position.begin(), this->initial_position.end()),
+        this->grid_size,
+        std::move(move_sequence)
+    );
 }
 
 /**
@@ -100,15 +116,24 @@ void Cat::reset_puzzle()
  */
 void Cat::on_load()
 {
-    if (this->move_sequence.empty()) {
-        this->initial_position = taquin_generate_vector(this->grid_size);
-        this->move_sequence = taquin_solve(this->initial_position, this->grid_size);
-
-        this->reset_puzzle();
+    //Runs on the thread pool, so it can wait for the first puzzle
+    Puzzle puzzle;
+    if (this->playback.is_finished() && this->solver->take(puzzle)) {
+        this->start_puzzle(std::move(puzzle));
     }
     Animation::on_load();
 }
 
+/**
+ * Show a solved puzzle in its shuffled state.
+ */
+void Cat::start_puzzle(Puzzle puzzle)
+{
+    this->initial_position = std::move(puzzle.initial_position);
+
+    this->reset_puzzle(std::move(puzzle.move_sequence));
+}
+
 /**
  * Compute a tick
  */
@@ -116,60 +141,21 @@ void Cat::on_tick(uint64_t time_delta)
 {
     Animation::on_tick(time_delta);
 
-    //Update all model matrices and add all to the scene
-    for(auto const& object: this->objects) {
-        object.second->set_model_matrix(Matrix::identity());
-    }
-
-    //Check if any tiles are moving
-    bool in_motion = false;
-    for(auto const& object: this->objects) {
-        in_motion |= ((Tile *)object.second.get())->is_moving();
-    }
+    if (this->playback.is_finished()) {
+        //Keep showing the finished picture until the next puzzle is solved
+        Puzzle puzzle;
+        if (!this->solver->try_take(puzzle)) {
+            return;
+        }
 
-    //If tiles are moving, skip
-    if (in_motion) {
-        return;
+        this->start_puzzle(std::move(puzzle));
     }
 
-    if (this->move_sequence.empty()) {
-        this->initial_position = taquin_generate_vector(this->grid_size);
-        this->move_sequence = taquin_solve(this->initial_position, this->grid_size);
+    this->playback.advance(time_delta);
 
-        this->reset_puzzle();
+    //Only tiles that moved need new model matrices
+    for (uint32_t tile : this->playback.get_changed()) {
+        this->tiles[tile]->set_position(this->playback.get_position(tile));
+        this->tiles[tile]->set_model_matrix(Matrix::identity());
     }
-
-    TaquinSolve::Moves move = this->move_sequence.front();
-    this->move_sequence.pop();
-
-    int from_position = this->zero_position;
-    int to_position = 0;
-    switch (move) {
-        case TaquinSolve::Moves::UP:
-            to_position = from_position - this->grid_size;
-            break;
-
-        case TaquinSolve::Moves::DOWN:
-            to_position = from_position + this->grid_size;
-            break;
-
-        case TaquinSolve::Moves::LEFT:
-            to_position = from_position - 1;
-            break;
-
-        case TaquinSolve::Moves::RIGHT:
-            to_position = from_position + 1;
-            break;
-    }
-
-    std::map<int, Tile *>::iterator it = this->tile_position_map.find(to_position);
-    Tile *tile = it->second;
-    it->second->move_to_board_position(Position(
-        from_position % this->grid_size,
-        from_position / this->grid_size
-    ));
-    this->tile_position_map.erase(it);
-    this->tile_position_map.insert(std::pair<int, Tile *>(from_position, tile));
-
-    this->zero_position = to_position;
 }
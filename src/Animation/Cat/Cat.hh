@@ -1,6 +1,6 @@
 #pragma once
 
-#include <map>
+#include <vector>
 #include <taquinsolve.hh>
 #include <atomic>
 
@@ -10,6 +10,8 @@
 #include "../../Geometry/Definitions.hh"
 #include "../../Object/Object.hh"
 #include "Object/Tile.hh"
+#include "Solver.hh"
+#include "Playback.hh"
 
 using namespace Animate::Object;
 using namespace Animate::Geometry;
@@ -20,7 +22,7 @@ namespace Animate::Animation::Cat
     class Cat : public Animation
     {
         public:
-            Cat(std::weak_ptr<AppContext> context);
+            Cat(std::weak_ptr<AppContext> context, PlaybackSettings playback_settings = PlaybackSettings());
 
             void initialise() override;
             void on_load() override;
@@ -29,12 +31,20 @@ namespace Animate::Animation::Cat
         protected:
             std::weak_ptr<VK::Pipeline> shader;
             std::vector<uint8_t> initial_position;
-            std::queue<TaquinSolve::Moves> move_sequence;
-            std::map<int, Tile *> tile_position_map;
-            int zero_position = 0;
+
+            //Indexed by tile, the blank's entry is null
+            std::vector<Tile *> tiles;
+
+            //Owns the board and which tiles are sliding
+            Playback playback;
+
             int grid_size = 4;
             int texture_index = 0;
 
-            void reset_puzzle();
+            //Solves upcoming puzzles off the tick thread
+            std::unique_ptr<Solver> solver;
+
+            void reset_puzzle(std::queue<TaquinSolve::Moves> move_sequence);
+            void start_puzzle(Puzzle puzzle);
     };
 }
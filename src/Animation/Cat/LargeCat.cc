@@ -0,0 +1,251 @@
+#define VULKAN_HPP_DISABLE_ENHANCED_MODE 1
+#include <vulkan/vulkan.hpp>
+#include <GLFW/glfw3.h>
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+
+#include "LargeCat.hh"
+#include "../../Utilities.hh"
+#include "../../Geometry/Matrix.hh"
+#include "../../VK/Context.hh"
+#include "../../Object/Object.hh"
+
+using namespace Animate::Animation::Cat;
+using namespace Animate::Geometry;
+using namespace Animate::VK;
+
+//Moves scrambled per row of the board
+static const int scramble_moves_per_row = 50;
+
+static TaquinSolve::Moves inverse(TaquinSolve::Moves move)
+{
+    switch (move) {
+        case TaquinSolve::Moves::UP:
+            return TaquinSolve::Moves::DOWN;
+        case TaquinSolve::Moves::DOWN:
+            return TaquinSolve::Moves::UP;
+        case TaquinSolve::Moves::LEFT:
+            return TaquinSolve::Moves::RIGHT;
+        case TaquinSolve::Moves::RIGHT:
+            return TaquinSolve::Moves::LEFT;
+    }
+    return move;
+}
+
+/**
+ * Constructor.
+ * Seed the RNG.
+ *
+ * @param grid_size         Width and height of the board, up to max_grid_size.
+ * @param playback_settings How quickly solutions are played.
+ */
+LargeCat::LargeCat(std::weak_ptr<AppContext> context, int grid_size, PlaybackSettings playback_settings) :
+    Animation::Animation(context),
+    grid_size(grid_size),
+    playback(playback_settings)
+{
+    if (grid_size < 2 || grid_size > LargeCat::max_grid_size) {
+        throw std::runtime_error("Invalid grid size given.");
+    }
+
+    srand(time(NULL));
+}
+
+/**
+ * Perform initialisations.
+ */
+void LargeCat::initialise()
+{
+    //Set shaders
+    this->shader = this->create_pipeline(
+        "data/Cat/shader.frag.spv",
+        "data/Cat/instanced.vert.spv",
+        {
+            "data/Cat/0.jpg",
+            "data/Cat/1.jpg",
+            "data/Cat/2.jpg",
+            "data/Cat/3.jpg",
+            "data/Cat/4.jpg",
+            "data/Cat/5.jpg",
+            "data/Cat/6.jpg"
+        },
+        sizeof(float),
+        VK::RenderSettings::instanced_streamed()
+    );
+
+    //Look at
+    Matrix view_matrix = Matrix::look_at(
+        Vector3(0., 0., 1.), // Eye
+        Vector3()            // Center (looking at)
+    );
+
+    //Ortho
+    Matrix projection_matrix = Matrix::orthographic(0, this->grid_size, 0, this->grid_size, 0, 1);
+
+    this->shader.lock()->set_matrices(view_matrix, projection_matrix);
+}
+
+/**
+ * Create the instanced quad every tile is drawn with, then scramble the first puzzle.
+ */
+void LargeCat::on_load()
+{
+    if (!this->object_exists("tiles")) {
+        std::shared_ptr<Pipeline> pipeline = this->shader.lock();
+        float tile_size = 1.f / this->grid_size;
+
+        //Each tile keeps the same instance, tile t is instance t-1
+        std::shared_ptr<InstancedQuad> tiles = std::make_shared<InstancedQuad>(
+            this->context.lock()->get_graphics_context(),
+            this->grid_size * this->grid_size - 1
+        );
+        tiles->set_texture_position(
+            pipeline->get_textures().lock()->get_region("data/Cat/0.jpg"),
+            Vector3(0., 0., 0.),
+            Vector3(tile_size, tile_size, 0.)
+        );
+        tiles->initialise(pipeline);
+
+        Object::Object *object = new Object::Object(this->context.lock()->get_graphics_context());
+        object->add_component(tiles);
+        object->set_model_matrix(Matrix::identity());
+
+        this->add_object("tiles", object);
+        this->tiles = tiles;
+    }
+
+    if (this->playback.is_finished()) {
+        this->start_puzzle();
+    }
+
+    Animation::on_load();
+}
+
+/**
+ * Scramble a solved board with a random walk of the blank, to be solved by walking it back.
+ */
+void LargeCat::start_puzzle()
+{
+    int cells = this->grid_size * this->grid_size;
+
+    std::vector<uint32_t> board(cells);
+    for (int cell = 0; cell < cells - 1; cell++) {
+        board[cell] = cell + 1;
+    }
+    board[cells - 1] = 0;
+    int zero_position = cells - 1;
+
+    static const TaquinSolve::Moves moves[4] = {
+        TaquinSolve::Moves::UP,
+        TaquinSolve::Moves::DOWN,
+        TaquinSolve::Moves::LEFT,
+        TaquinSolve::Moves::RIGHT
+    };
+
+    //Each move is stored as the move undoing it
+    size_t scramble_moves = this->grid_size * scramble_moves_per_row;
+    std::vector<TaquinSolve::Moves> undo_moves;
+    undo_moves.reserve(scramble_moves);
+
+    while (undo_moves.size() < scramble_moves) {
+        TaquinSolve::Moves move = moves[rand() % 4];
+        int to_position = this->get_neighbour(zero_position, move);
+        if (to_position < 0) {
+            continue;
+        }
+
+        //Don't step straight back
+        if (!undo_moves.empty() && undo_moves.back() == move) {
+            continue;
+        }
+
+        board[zero_position] = board[to_position];
+        board[to_position] = 0;
+        zero_position = to_position;
+        undo_moves.push_back(inverse(move));
+    }
+
+    std::queue<TaquinSolve::Moves> move_sequence;
+    for (auto it = undo_moves.rbegin(); it != undo_moves.rend(); it++) {
+        move_sequence.push(*it);
+    }
+
+    this->playback.start(std::move(board), this->grid_size, std::move(move_sequence));
+
+    //Set puzzle values
+    std::string texture_name = "data/Cat/" + std::to_string(this->texture_index++) + ".jpg";
+    this->texture_index %= 7;
+
+    std::shared_ptr<InstancedQuad> tiles = this->tiles.lock();
+    this->texture_region = this->shader.lock()->get_textures().lock()->get_region(texture_name);
+    tiles->set_texture_region(this->texture_region);
+
+    //The only time every instance is written
+    std::vector<Instance> instances(cells - 1);
+    for (uint32_t tile = 1; tile < static_cast<uint32_t>(cells); tile++) {
+        instances[tile - 1] = this->get_instance(tile, this->playback.get_position(tile));
+    }
+    tiles->set_instances(instances);
+}
+
+/**
+ * A tile drawn somewhere, showing its own part of the picture.
+ */
+Instance LargeCat::get_instance(uint32_t tile, Point position) const
+{
+    int home = tile - 1;
+    float tile_size = 1.f / this->grid_size;
+
+    return Instance(
+        position,
+        Vector3(
+            (home % this->grid_size) * tile_size * this->texture_region.width,
+            (home / this->grid_size) * tile_size * this->texture_region.height,
+            0.
+        )
+    );
+}
+
+/**
+ * The cell the blank moves to, -1 if it would leave the board.
+ */
+int LargeCat::get_neighbour(int cell, TaquinSolve::Moves move) const
+{
+    switch (move) {
+        case TaquinSolve::Moves::UP:
+            return cell >= this->grid_size ? cell - this->grid_size : -1;
+        case TaquinSolve::Moves::DOWN:
+            return cell < this->grid_size * (this->grid_size - 1) ? cell + this->grid_size : -1;
+        case TaquinSolve::Moves::LEFT:
+            return cell % this->grid_size > 0 ? cell - 1 : -1;
+        case TaquinSolve::Moves::RIGHT:
+            return cell % this->grid_size < this->grid_size - 1 ? cell + 1 : -1;
+    }
+    return -1;
+}
+
+/**
+ * Compute a tick
+ */
+void LargeCat::on_tick(uint64_t time_delta)
+{
+    Animation::on_tick(time_delta);
+
+    std::shared_ptr<InstancedQuad> tiles = this->tiles.lock();
+    if (!tiles) {
+        return;
+    }
+
+    if (this->playback.is_finished()) {
+        this->start_puzzle();
+        return;
+    }
+
+    this->playback.advance(time_delta);
+
+    //Nothing else on the board changed
+    for (uint32_t tile : this->playback.get_changed()) {
+        tiles->set_instance(tile - 1, this->get_instance(tile, this->playback.get_position(tile)));
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <taquinsolve.hh>
+#include <vector>
+
+#include "../Animation.hh"
+#include "../../VK/InstancedQuad.hh"
+#include "../../VK/Pipeline.hh"
+#include "../../VK/TextureRegion.hh"
+#include "../../Geometry/Definitions.hh"
+#include "../../Geometry/Instance.hh"
+#include "Playback.hh"
+
+using namespace Animate::Geometry;
+
+namespace Animate::Animation::Cat
+{
+    /**
+     * The Cat puzzle on boards too large for a drawable per tile.
+     * The board is a flat array of tile ids and every tile is an instance of one quad, drawn
+     * together. Only the moving tile's instance changes each tick.
+     */
+    class LargeCat : public Animation
+    {
+        public:
+            static const int max_grid_size = 256;
+
+            LargeCat(
+                std::weak_ptr<AppContext> context,
+                int grid_size = 64,
+                PlaybackSettings playback_settings = PlaybackSettings::overlapped(60.f, 4.f)
+            );
+
+            void initialise() override;
+            void on_load() override;
+            void on_tick(uint64_t time_delta) override;
+
+        protected:
+            std::weak_ptr<VK::Pipeline> shader;
+            std::weak_ptr<VK::InstancedQuad> tiles;
+            TextureRegion texture_region;
+            int grid_size;
+            int texture_index = 0;
+
+            //Owns the board and which tiles are sliding
+            Playback playback;
+
+            void start_puzzle();
+            Instance get_instance(uint32_t tile, Point position) const;
+            int get_neighbour(int cell, TaquinSolve::Moves move) const;
+    };
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Animate::Animation::Cat
+{
+    /**
+     * A board of up to 5x5 packed five bits per cell, cell i at bit 5i.
+     * Cheap to copy, compare and hash, so searches can keep many of them.
+     */
+    class PackedBoard
+    {
+        public:
+            static const int max_cells = 25;
+
+            PackedBoard() = default;
+
+            PackedBoard(std::vector<uint8_t> const& tiles)
+            {
+                for (size_t cell = 0; cell < tiles.size(); cell++) {
+                    this->set(static_cast<int>(cell), tiles[cell]);
+                }
+            }
+
+            uint8_t get(int cell) const
+            {
+                return static_cast<uint8_t>((this->bits >> (cell * 5)) & 31);
+            }
+
+            void set(int cell, uint8_t tile)
+            {
+                this->bits &= ~(static_cast<unsigned __int128>(31) << (cell * 5));
+                this->bits |= static_cast<unsigned __int128>(tile) << (cell * 5);
+            }
+
+            /**
+             * Slide the tile at to into the blank.
+             */
+            void slide(int blank, int to)
+            {
+                this->set(blank, this->get(to));
+                this->set(to, 0);
+            }
+
+            uint64_t hash() const
+            {
+                uint64_t low = static_cast<uint64_t>(this->bits);
+                uint64_t high = static_cast<uint64_t>(this->bits >> 64);
+                return (low ^ (high * 0x9e3779b97f4a7c15ull)) * 0xff51afd7ed558ccdull;
+            }
+
+            bool operator==(PackedBoard const& other) const
+            {
+                return this->bits == other.bits;
+            }
+
+            bool operator!=(PackedBoard const& other) const
+            {
+                return !(*this == other);
+            }
+
+        private:
+            unsigned __int128 bits = 0;
+    };
+}
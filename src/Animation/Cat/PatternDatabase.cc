@@ -0,0 +1,101 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "PatternDatabase.hh"
+
+using namespace Animate::Animation::Cat;
+
+/**
+ * Constructor.
+ * Validates the database, the tables are used where they lie.
+ *
+ * @param data Start of the database, which must outlive this.
+ * @param size Size of the database in bytes.
+ */
+PatternDatabase::PatternDatabase(uint8_t const *data, size_t size)
+{
+    PatternDatabaseFormat::Header header;
+    if (size < sizeof(header)) {
+        throw std::runtime_error("Pattern database is truncated.");
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, PatternDatabaseFormat::magic, sizeof(header.magic)) != 0 ||
+        header.version != PatternDatabaseFormat::version) {
+        throw std::runtime_error("Pattern database has an unknown format.");
+    }
+
+    this->width = static_cast<int>(header.width);
+    this->cells = this->width * this->width;
+    this->tile_groups.assign(this->cells, -1);
+
+    if (sizeof(header) + sizeof(PatternDatabaseFormat::Group) * static_cast<uint64_t>(header.group_count) > size) {
+        throw std::runtime_error("Pattern database is truncated.");
+    }
+
+    for (uint32_t i = 0; i < header.group_count; i++) {
+        PatternDatabaseFormat::Group stored;
+        std::memcpy(&stored, data + sizeof(header) + sizeof(stored) * i, sizeof(stored));
+
+        if (stored.tile_count > PatternDatabaseFormat::max_group_tiles ||
+            stored.size != PatternDatabaseFormat::placements(stored.tile_count, this->cells) ||
+            stored.offset + stored.size > size) {
+            throw std::runtime_error("Pattern database group is invalid.");
+        }
+
+        Group group;
+        group.tiles.assign(stored.tiles, stored.tiles + stored.tile_count);
+        group.table = data + stored.offset;
+
+        for (uint8_t tile : group.tiles) {
+            if (tile == 0 || tile >= this->cells || this->tile_groups[tile] != -1) {
+                throw std::runtime_error("Pattern database groups overlap.");
+            }
+            this->tile_groups[tile] = static_cast<int>(this->groups.size());
+        }
+
+        this->groups.push_back(group);
+    }
+}
+
+int PatternDatabase::get_width() const
+{
+    return this->width;
+}
+
+/**
+ * Lower bound on the moves to solve a board.
+ *
+ * @param positions The cell each tile is in, indexed by tile.
+ */
+int PatternDatabase::estimate(uint8_t const *positions) const
+{
+    int total = 0;
+    for (size_t group = 0; group < this->groups.size(); group++) {
+        total += this->estimate_group(static_cast<int>(group), positions);
+    }
+    return total;
+}
+
+/**
+ * One group's part of the estimate, searches update this for the group of the tile that moved.
+ */
+int PatternDatabase::estimate_group(int group, uint8_t const *positions) const
+{
+    Group const& entry = this->groups[group];
+
+    uint8_t placement[PatternDatabaseFormat::max_group_tiles];
+    for (size_t i = 0; i < entry.tiles.size(); i++) {
+        placement[i] = positions[entry.tiles[i]];
+    }
+
+    return entry.table[PatternDatabaseFormat::rank(placement, static_cast<uint32_t>(entry.tiles.size()), this->cells)];
+}
+
+/**
+ * The group a tile is in, -1 if it isn't in any.
+ */
+int PatternDatabase::get_group(uint8_t tile) const
+{
+    return this->tile_groups[tile];
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include "PatternDatabaseFormat.hh"
+
+namespace Animate::Animation::Cat
+{
+    /**
+     * Disjoint additive pattern databases for one board size, read in place wherever they're
+     * stored. See PatternDatabaseFormat.hh.
+     */
+    class PatternDatabase
+    {
+        public:
+            PatternDatabase(uint8_t const *data, size_t size);
+
+            int get_width() const;
+            int estimate(uint8_t const *positions) const;
+            int estimate_group(int group, uint8_t const *positions) const;
+            int get_group(uint8_t tile) const;
+
+        private:
+            struct Group {
+                std::vector<uint8_t> tiles;
+                uint8_t const *table;
+            };
+
+            int width;
+            int cells;
+            std::vector<Group> groups;
+
+            //Which group each tile is in, -1 for the blank
+            std::vector<int> tile_groups;
+    };
+}
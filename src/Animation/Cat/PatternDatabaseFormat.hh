@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Animate::Animation::Cat
+{
+    /**
+     * Layout of pattern databases built by the pattern-db-builder tool.
+     *
+     * A header, one Group per disjoint set of tiles, then each group's table. A group's table
+     * holds one byte per placement of its tiles, indexed by rank(), giving the fewest moves of
+     * those tiles needed to bring them home. Moves of other tiles aren't counted, so the
+     * groups' values can be added together without overestimating.
+     *
+     * Tile t belongs at cell t-1 and the blank in the last cell.
+     */
+    namespace PatternDatabaseFormat
+    {
+        static const char magic[4] = {'A', 'N', 'P', 'D'};
+        static const uint32_t version = 1;
+
+        static const uint32_t max_group_tiles = 8;
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint32_t width;
+            uint32_t group_count;
+        };
+
+        struct Group {
+            uint32_t tile_count;
+            uint32_t reserved;
+            uint8_t tiles[max_group_tiles];
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        static_assert(sizeof(Header) == 16, "Pattern database header layout is fixed");
+        static_assert(sizeof(Group) == 32, "Pattern database group layout is fixed");
+
+        /**
+         * Index of a placement of count tiles among cells cells, each tile's position counted
+         * among the cells the tiles before it don't occupy.
+         */
+        inline uint64_t rank(uint8_t const *positions, uint32_t count, uint32_t cells)
+        {
+            uint64_t index = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t position = positions[i];
+                for (uint32_t j = 0; j < i; j++) {
+                    if (positions[j] < positions[i]) {
+                        position--;
+                    }
+                }
+                index = index * (cells - i) + position;
+            }
+            return index;
+        }
+
+        /**
+         * Number of placements of count tiles among cells cells.
+         */
+        inline uint64_t placements(uint32_t count, uint32_t cells)
+        {
+            uint64_t total = 1;
+            for (uint32_t i = 0; i < count; i++) {
+                total *= cells - i;
+            }
+            return total;
+        }
+    }
+}
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "Playback.hh"
+
+using namespace Animate::Animation::Cat;
+
+//Longer ticks are cut short so a stalled frame doesn't start a burst of moves at once
+static const uint64_t max_time_delta = 250000;
+
+/**
+ * Fraction of a slide's distance covered after some fraction of its time.
+ */
+static float ease(Easing easing, float t)
+{
+    switch (easing) {
+        case Easing::LINEAR:
+            return t;
+        case Easing::EASE_OUT:
+            return 1.f - (1.f - t) * (1.f - t);
+        case Easing::EASE_IN_OUT:
+            return t * t * (3.f - 2.f * t);
+    }
+    return t;
+}
+
+/**
+ * Constructor.
+ */
+Playback::Playback(PlaybackSettings settings)
+{
+    this->set_settings(settings);
+}
+
+/**
+ * Change how quickly moves are played, taking effect from the next move.
+ */
+void Playback::set_settings(PlaybackSettings settings)
+{
+    if (settings.moves_per_second <= 0.f || settings.overlap <= 0.f) {
+        throw std::runtime_error("Invalid playback settings given.");
+    }
+
+    this->settings = settings;
+}
+
+/**
+ * Show a board in its shuffled state, ready to play its solution.
+ *
+ * @param board         The tile in each cell, 0 for the blank.
+ * @param grid_size     Width and height of the board.
+ * @param move_sequence The moves of the blank.
+ */
+void Playback::start(std::vector<uint32_t> board, int grid_size, std::queue<TaquinSolve::Moves> move_sequence)
+{
+    size_t cells = static_cast<size_t>(grid_size) * grid_size;
+    if (board.size() != cells) {
+        throw std::runtime_error("Board doesn't match the grid size.");
+    }
+
+    this->board = std::move(board);
+    this->grid_size = grid_size;
+    this->move_sequence = std::move(move_sequence);
+
+    this->positions.assign(cells, Point());
+    this->slides.assign(cells, Slide());
+    this->marked.assign(cells, false);
+    this->sliding.clear();
+    this->sliding.reserve(cells);
+    this->changed.clear();
+    this->changed.reserve(cells);
+
+    for (size_t cell = 0; cell < cells; cell++) {
+        uint32_t tile = this->board[cell];
+        if (tile >= cells) {
+            throw std::runtime_error("Invalid tile on board.");
+        }
+
+        if (tile == 0) {
+            this->zero_position = static_cast<int>(cell);
+        } else {
+            this->positions[tile] = this->get_cell_point(static_cast<int>(cell));
+        }
+    }
+
+    this->time = 0;
+    this->next_move_time = 0;
+}
+
+/**
+ * Start every move due in this tick and move the sliding tiles along.
+ *
+ * @param time_delta The time in microseconds since the last tick.
+ */
+void Playback::advance(uint64_t time_delta)
+{
+    for (uint32_t tile : this->changed) {
+        this->marked[tile] = false;
+    }
+    this->changed.clear();
+
+    this->time += std::min(time_delta, max_time_delta);
+
+    //Moves start on their own schedule rather than at the tick, so each keeps its place in
+    //the overlap however the ticks fall
+    while (!this->move_sequence.empty() && this->next_move_time <= this->time) {
+        TaquinSolve::Moves move = this->move_sequence.front();
+        this->move_sequence.pop();
+
+        this->apply_move(move, this->next_move_time);
+        this->next_move_time += this->get_move_interval();
+    }
+
+    //Don't bank time while idle
+    if (this->move_sequence.empty()) {
+        this->next_move_time = std::max(this->next_move_time, this->time);
+    }
+
+    uint64_t duration = this->get_slide_duration();
+    for (size_t i = 0; i < this->sliding.size();) {
+        uint32_t tile = this->sliding[i];
+        Slide &slide = this->slides[tile];
+
+        float t = std::min(1.f, static_cast<float>(this->time - slide.start) / duration);
+        this->positions[tile] = slide.from + (slide.to - slide.from) * ease(this->settings.easing, t);
+        this->mark_changed(tile);
+
+        if (t < 1.f) {
+            i++;
+            continue;
+        }
+
+        slide.active = false;
+        this->sliding[i] = this->sliding.back();
+        this->sliding.pop_back();
+    }
+}
+
+/**
+ * Slide the tile next to the blank into it.
+ *
+ * @param start When the slide starts, at or before the current time.
+ */
+void Playback::apply_move(TaquinSolve::Moves move, uint64_t start)
+{
+    int from_position = this->zero_position;
+    int to_position = -1;
+    switch (move) {
+        case TaquinSolve::Moves::UP:
+            to_position = from_position >= this->grid_size ? from_position - this->grid_size : -1;
+            break;
+
+        case TaquinSolve::Moves::DOWN:
+            to_position = from_position < this->grid_size * (this->grid_size - 1) ? from_position + this->grid_size : -1;
+            break;
+
+        case TaquinSolve::Moves::LEFT:
+            to_position = from_position % this->grid_size > 0 ? from_position - 1 : -1;
+            break;
+
+        case TaquinSolve::Moves::RIGHT:
+            to_position = from_position % this->grid_size < this->grid_size - 1 ? from_position + 1 : -1;
+            break;
+    }
+
+    if (to_position < 0) {
+        throw std::runtime_error("Tried to move a tile off the board.");
+    }
+
+    uint32_t tile = this->board[to_position];
+    this->board[from_position] = tile;
+    this->board[to_position] = 0;
+    this->zero_position = to_position;
+
+    if (this->settings.batch) {
+        this->positions[tile] = this->get_cell_point(from_position);
+        this->mark_changed(tile);
+        return;
+    }
+
+    //A tile moved again before it arrived carries on from wherever it got to
+    Slide &slide = this->slides[tile];
+    slide.from = this->positions[tile];
+    slide.to = this->get_cell_point(from_position);
+    slide.start = start;
+
+    if (!slide.active) {
+        slide.active = true;
+        this->sliding.push_back(tile);
+    }
+}
+
+void Playback::mark_changed(uint32_t tile)
+{
+    if (!this->marked[tile]) {
+        this->marked[tile] = true;
+        this->changed.push_back(tile);
+    }
+}
+
+/**
+ * Microseconds between the starts of consecutive moves.
+ */
+uint64_t Playback::get_move_interval() const
+{
+    return std::max<uint64_t>(1, static_cast<uint64_t>(1000000.f / this->settings.moves_per_second));
+}
+
+uint64_t Playback::get_slide_duration() const
+{
+    return std::max<uint64_t>(1, static_cast<uint64_t>(this->get_move_interval() * this->settings.overlap));
+}
+
+/**
+ * Whether every move has been made and every tile has arrived.
+ */
+bool Playback::is_finished() const
+{
+    return this->move_sequence.empty() && this->sliding.empty();
+}
+
+std::vector<uint32_t> const& Playback::get_board() const
+{
+    return this->board;
+}
+
+std::vector<uint32_t> const& Playback::get_changed() const
+{
+    return this->changed;
+}
+
+/**
+ * Where a tile is drawn, it may be between cells.
+ */
+Point Playback::get_position(uint32_t tile) const
+{
+    return this->positions[tile];
+}
+
+/**
+ * Where a cell's tile is drawn when it's at rest, rows count down from the top.
+ */
+Point Playback::get_cell_point(int cell) const
+{
+    return Point(cell % this->grid_size, this->grid_size - cell / this->grid_size - 1);
+}
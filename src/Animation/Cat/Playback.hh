@@ -0,0 +1,117 @@
+#pragma once
+
+#include <taquinsolve.hh>
+#include <vector>
+#include <queue>
+#include <cstdint>
+
+#include "../../Geometry/Definitions.hh"
+
+using namespace Animate::Geometry;
+
+namespace Animate::Animation::Cat
+{
+    enum class Easing {
+        LINEAR,
+        EASE_OUT,
+        EASE_IN_OUT
+    };
+
+    /**
+     * How quickly solutions are played.
+     */
+    struct PlaybackSettings {
+        float moves_per_second = 10.f;
+
+        //How many moves each slide lasts, above 1 consecutive slides overlap
+        float overlap = 1.5f;
+
+        Easing easing = Easing::EASE_IN_OUT;
+
+        //Apply moves without sliding, to get through long solutions quickly
+        bool batch = false;
+
+        /**
+         * Many slides under way at once, easing out so tiles don't seem to wait on each other.
+         */
+        static PlaybackSettings overlapped(float moves_per_second, float overlap)
+        {
+            PlaybackSettings settings;
+            settings.moves_per_second = moves_per_second;
+            settings.overlap = overlap;
+            settings.easing = Easing::EASE_OUT;
+            return settings;
+        }
+
+        /**
+         * Moves as fast as they're given, with nothing drawn in between.
+         */
+        static PlaybackSettings fast_forward(float moves_per_second)
+        {
+            PlaybackSettings settings;
+            settings.moves_per_second = moves_per_second;
+            settings.batch = true;
+            return settings;
+        }
+    };
+
+    /**
+     * Plays a solution back on a board, starting moves at a steady rate whether or not the
+     * previous tile has finished sliding.
+     *
+     * Tiles are drawn in board units with row 0 at the top. After each advance, get_changed
+     * lists the tiles whose drawn position changed, and every other tile stayed where it was.
+     */
+    class Playback
+    {
+        public:
+            Playback(PlaybackSettings settings = PlaybackSettings());
+
+            void set_settings(PlaybackSettings settings);
+
+            void start(std::vector<uint32_t> board, int grid_size, std::queue<TaquinSolve::Moves> move_sequence);
+            void advance(uint64_t time_delta);
+            bool is_finished() const;
+
+            std::vector<uint32_t> const& get_board() const;
+            std::vector<uint32_t> const& get_changed() const;
+            Point get_position(uint32_t tile) const;
+            Point get_cell_point(int cell) const;
+
+        private:
+            struct Slide {
+                Point from;
+                Point to;
+                uint64_t start;
+                bool active = false;
+            };
+
+            PlaybackSettings settings;
+            int grid_size = 0;
+
+            //The tile in each cell, 0 for the blank
+            std::vector<uint32_t> board;
+            int zero_position = 0;
+            std::queue<TaquinSolve::Moves> move_sequence;
+
+            //Indexed by tile
+            std::vector<Point> positions;
+            std::vector<Slide> slides;
+
+            //Tiles with an active slide
+            std::vector<uint32_t> sliding;
+
+            //Tiles moved by the last advance, each listed once
+            std::vector<uint32_t> changed;
+            std::vector<bool> marked;
+
+            //Microseconds since the playback started
+            uint64_t time = 0;
+            uint64_t next_move_time = 0;
+
+            uint64_t get_move_interval() const;
+            uint64_t get_slide_duration() const;
+            void apply_move(TaquinSolve::Moves move, uint64_t start);
+            void mark_changed(uint32_t tile);
+    };
+}
@@ -0,0 +1,690 @@
+#include <limits>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include <mutex>
+
+#include "Search.hh"
+#include "PackedBoard.hh"
+#include "TranspositionTable.hh"
+#include "../../Tasks/ThreadPool.hh"
+
+using namespace Animate::Animation::Cat;
+
+static const TaquinSolve::Moves all_moves[4] = {
+    TaquinSolve::Moves::UP,
+    TaquinSolve::Moves::DOWN,
+    TaquinSolve::Moves::LEFT,
+    TaquinSolve::Moves::RIGHT
+};
+
+/**
+ * The cell the blank moves to, -1 if it would leave the board.
+ */
+static int neighbour(int cell, TaquinSolve::Moves move, int grid_size)
+{
+    switch (move) {
+        case TaquinSolve::Moves::UP:
+            return cell >= grid_size ? cell - grid_size : -1;
+        case TaquinSolve::Moves::DOWN:
+            return cell < grid_size * (grid_size - 1) ? cell + grid_size : -1;
+        case TaquinSolve::Moves::LEFT:
+            return cell % grid_size > 0 ? cell - 1 : -1;
+        case TaquinSolve::Moves::RIGHT:
+            return cell % grid_size < grid_size - 1 ? cell + 1 : -1;
+    }
+    return -1;
+}
+
+static TaquinSolve::Moves inverse(TaquinSolve::Moves move)
+{
+    switch (move) {
+        case TaquinSolve::Moves::UP:
+            return TaquinSolve::Moves::DOWN;
+        case TaquinSolve::Moves::DOWN:
+            return TaquinSolve::Moves::UP;
+        case TaquinSolve::Moves::LEFT:
+            return TaquinSolve::Moves::RIGHT;
+        case TaquinSolve::Moves::RIGHT:
+            return TaquinSolve::Moves::LEFT;
+    }
+    return move;
+}
+
+static int tile_distance(int tile, int cell, int grid_size)
+{
+    return std::abs(cell % grid_size - (tile - 1) % grid_size) +
+        std::abs(cell / grid_size - (tile - 1) / grid_size);
+}
+
+/**
+ * Whether the board can reach the solved board.
+ * Sliding a tile vertically jumps it over grid_size - 1 others, so the inversion count's parity
+ * (plus the blank's row on even widths) never changes.
+ */
+bool Search::is_solvable(std::vector<uint8_t> const& initial_position, int grid_size)
+{
+    int inversions = 0;
+    int blank_row = 0;
+    for (size_t i = 0; i < initial_position.size(); i++) {
+        if (initial_position[i] == 0) {
+            blank_row = static_cast<int>(i) / grid_size;
+            continue;
+        }
+
+        for (size_t j = i + 1; j < initial_position.size(); j++) {
+            if (initial_position[j] != 0 && initial_position[j] < initial_position[i]) {
+                inversions++;
+            }
+        }
+    }
+
+    if (grid_size % 2 == 1) {
+        return inversions % 2 == 0;
+    }
+
+    return (inversions + grid_size - 1 - blank_row) % 2 == 0;
+}
+
+/**
+ * What the threads searching one IDA* iteration share.
+ */
+struct SharedSearch {
+    TranspositionTable *table;
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic_bool const *cancelled;
+
+    std::atomic_bool solved = false;
+    std::mutex solution_mutex;
+    std::vector<TaquinSolve::Moves> solution;
+};
+
+/**
+ * State of an IDA* search, changed in place as it goes deeper and restored on the way back.
+ */
+struct OptimalSearch {
+    int grid_size;
+    PatternDatabase const *database;
+    SharedSearch *shared;
+
+    PackedBoard board;
+    int blank;
+
+    //The cell each tile is in
+    uint8_t positions[PackedBoard::max_cells];
+
+    //Each pattern group's estimate, or each tile's distance without a database
+    int estimates[PackedBoard::max_cells];
+    int estimate;
+
+    std::vector<TaquinSolve::Moves> path;
+    uint64_t nodes;
+    bool aborted;
+};
+
+static const int found = -1;
+
+//Only boards with at least this many moves left to search are looked up in the transposition
+//table, below that searching again is cheaper than locking
+static const int transposition_depth = 12;
+
+/**
+ * Update the estimate for a tile that moved.
+ */
+static void update_estimate(OptimalSearch &search, uint8_t tile)
+{
+    int part = tile;
+    int value;
+
+    if (search.database != nullptr) {
+        part = search.database->get_group(tile);
+        if (part < 0) {
+            return;
+        }
+        value = search.database->estimate_group(part, search.positions);
+    } else {
+        value = tile_distance(tile, search.positions[tile], search.grid_size);
+    }
+
+    search.estimate += value - search.estimates[part];
+    search.estimates[part] = value;
+}
+
+/**
+ * Move the blank to a neighbouring cell.
+ */
+static void apply(OptimalSearch &search, int to, TaquinSolve::Moves move)
+{
+    uint8_t tile = search.board.get(to);
+
+    search.board.slide(search.blank, to);
+    search.positions[tile] = static_cast<uint8_t>(search.blank);
+    search.blank = to;
+    update_estimate(search, tile);
+    search.path.push_back(move);
+}
+
+static bool is_solved(OptimalSearch const& search)
+{
+    if (search.estimate != 0) {
+        return false;
+    }
+
+    for (int tile = 1; tile < search.grid_size * search.grid_size; tile++) {
+        if (search.positions[tile] != tile - 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Search below a node for a solution costing at most threshold.
+ * Moves that undo the last move are pruned, as are boards other branches already reached in
+ * as few moves.
+ *
+ * @return found, or the lowest cost beyond the threshold for the next iteration.
+ */
+static int depth_first(OptimalSearch &search, int threshold)
+{
+    int cost = static_cast<int>(search.path.size());
+    int bound = cost + search.estimate;
+    if (bound > threshold) {
+        return bound;
+    }
+
+    if (is_solved(search)) {
+        std::lock_guard<std::mutex> guard(search.shared->solution_mutex);
+        if (!search.shared->solved) {
+            search.shared->solution = search.path;
+            search.shared->solved = true;
+        }
+        return found;
+    }
+
+    //Checking the clock every node would cost more than the search
+    if ((++search.nodes & 0xffff) == 0 && (
+        search.shared->solved ||
+        *search.shared->cancelled ||
+        std::chrono::steady_clock::now() >= search.shared->deadline
+    )) {
+        search.aborted = true;
+        return std::numeric_limits<int>::max();
+    }
+
+    if (search.shared->table != nullptr && threshold - cost >= transposition_depth &&
+        !search.shared->table->visit(search.board, static_cast<uint32_t>(cost))) {
+        return std::numeric_limits<int>::max();
+    }
+
+    int blank = search.blank;
+    int next = std::numeric_limits<int>::max();
+    for (TaquinSolve::Moves move : all_moves) {
+        if (!search.path.empty() && move == inverse(search.path.back())) {
+            continue;
+        }
+
+        int to = neighbour(blank, move, search.grid_size);
+        if (to < 0) {
+            continue;
+        }
+
+        uint8_t tile = search.board.get(to);
+        int previous_estimate = search.estimate;
+        int previous_part = search.database != nullptr ? search.database->get_group(tile) : tile;
+        int previous_part_estimate = previous_part >= 0 ? search.estimates[previous_part] : 0;
+
+        apply(search, to, move);
+
+        int result = depth_first(search, threshold);
+        if (result == found) {
+            return found;
+        }
+
+        search.path.pop_back();
+        search.board.slide(to, blank);
+        search.positions[tile] = static_cast<uint8_t>(to);
+        search.blank = blank;
+        search.estimate = previous_estimate;
+        if (previous_part >= 0) {
+            search.estimates[previous_part] = previous_part_estimate;
+        }
+
+        if (search.aborted) {
+            return next;
+        }
+
+        next = std::min(next, result);
+    }
+
+    return next;
+}
+
+/**
+ * Expand the root breadth first until there are enough boards for every thread to take
+ * several, so threads that finish early pick up more.
+ *
+ * @return The boards, or just the solution if one is this shallow.
+ */
+static std::vector<OptimalSearch> expand_frontier(OptimalSearch const& root, size_t target)
+{
+    std::vector<OptimalSearch> frontier = {root};
+
+    while (frontier.size() < target) {
+        std::vector<OptimalSearch> next_frontier;
+
+        for (OptimalSearch const& node : frontier) {
+            for (TaquinSolve::Moves move : all_moves) {
+                if (!node.path.empty() && move == inverse(node.path.back())) {
+                    continue;
+                }
+
+                int to = neighbour(node.blank, move, node.grid_size);
+                if (to < 0) {
+                    continue;
+                }
+
+                OptimalSearch child = node;
+                apply(child, to, move);
+
+                //Levels are expanded in order, so this is a shortest solution
+                if (is_solved(child)) {
+                    return {child};
+                }
+
+                next_frontier.push_back(child);
+            }
+        }
+
+        frontier.swap(next_frontier);
+    }
+
+    return frontier;
+}
+
+/**
+ * Find a shortest solution with IDA*, for boards of up to 5x5.
+ *
+ * With a thread pool each iteration is split between its threads, starting from the boards a
+ * few moves from the initial one.
+ *
+ * @param initial_position The board to solve.
+ * @param grid_size        Width and height of the board.
+ * @param database         Pattern databases for the board size, Manhattan distance is used without.
+ * @param deadline         When to give up.
+ * @param cancelled        Gives up once set.
+ * @param move_sequence    Where the solution is written.
+ * @param thread_pool      Threads to search with besides the calling one, may be null.
+ * @param table            Boards already reached, may be null.
+ *
+ * @return False if the board is too large or unsolvable, or the search gave up.
+ */
+bool Search::solve_optimal(
+    std::vector<uint8_t> const& initial_position,
+    int grid_size,
+    PatternDatabase const *database,
+    std::chrono::steady_clock::time_point deadline,
+    std::atomic_bool const& cancelled,
+    std::queue<TaquinSolve::Moves> &move_sequence,
+    Tasks::ThreadPool *thread_pool,
+    TranspositionTable *table
+) {
+    int cells = grid_size * grid_size;
+    if (cells > PackedBoard::max_cells || !Search::is_solvable(initial_position, grid_size)) {
+        return false;
+    }
+
+    SharedSearch shared;
+    shared.table = table;
+    shared.deadline = deadline;
+    shared.cancelled = &cancelled;
+
+    OptimalSearch root;
+    root.grid_size = grid_size;
+    root.database = (database != nullptr && database->get_width() == grid_size) ? database : nullptr;
+    root.shared = &shared;
+    root.board = PackedBoard(initial_position);
+    root.nodes = 0;
+    root.aborted = false;
+
+    for (int cell = 0; cell < cells; cell++) {
+        if (initial_position[cell] == 0) {
+            root.blank = cell;
+        } else {
+            root.positions[initial_position[cell]] = static_cast<uint8_t>(cell);
+        }
+    }
+
+    root.estimate = 0;
+    std::fill(std::begin(root.estimates), std::end(root.estimates), 0);
+    for (int tile = 1; tile < cells; tile++) {
+        update_estimate(root, static_cast<uint8_t>(tile));
+    }
+
+    std::vector<OptimalSearch> frontier = {root};
+    if (thread_pool != nullptr && !is_solved(root)) {
+        frontier = expand_frontier(root, (thread_pool->get_thread_count() + 1) * 16);
+    }
+
+    for (int threshold = root.estimate;;) {
+        if (table != nullptr) {
+            table->next_iteration();
+        }
+
+        std::atomic_int next = std::numeric_limits<int>::max();
+        std::atomic_bool aborted = false;
+
+        auto search_from = [&](size_t i) {
+            OptimalSearch search = frontier[i];
+            int result = depth_first(search, threshold);
+
+            if (search.aborted) {
+                aborted = true;
+            }
+            for (int current = next; result != found && result < current;) {
+                if (next.compare_exchange_weak(current, result)) {
+                    break;
+                }
+            }
+        };
+
+        if (thread_pool != nullptr) {
+            thread_pool->parallel_for(frontier.size(), search_from);
+        } else {
+            search_from(0);
+        }
+
+        if (shared.solved) {
+            move_sequence = std::queue<TaquinSolve::Moves>();
+            for (TaquinSolve::Moves move : shared.solution) {
+                move_sequence.push(move);
+            }
+            return true;
+        }
+
+        if (aborted || next == std::numeric_limits<int>::max()) {
+            return false;
+        }
+
+        threshold = next;
+    }
+}
+
+/**
+ * A board being solved a few tiles at a time, cells holding solved tiles are locked.
+ */
+struct RealtimeBoard {
+    int grid_size;
+    std::vector<uint8_t> tiles;
+    std::vector<int> positions;
+    std::vector<bool> locked;
+    int blank;
+    std::vector<TaquinSolve::Moves> moves;
+
+    void apply(TaquinSolve::Moves move)
+    {
+        int to = neighbour(this->blank, move, this->grid_size);
+        uint8_t tile = this->tiles[to];
+
+        this->tiles[this->blank] = tile;
+        this->positions[tile] = this->blank;
+        this->tiles[to] = 0;
+        this->blank = to;
+
+        this->moves.push_back(move);
+    }
+};
+
+/**
+ * Breadth first search over the cells of some tiles and the blank for the shortest moves
+ * reaching the goal. Neither the blank nor the tracked tiles leave the region, other tiles in
+ * the region are shuffled freely.
+ *
+ * @return False if the goal can't be reached within the region.
+ */
+static bool move_tiles(
+    RealtimeBoard &board,
+    std::vector<uint8_t> const& tracked,
+    std::vector<bool> const& region,
+    std::function<bool(std::vector<int> const&)> const& goal
+) {
+    uint64_t cells = static_cast<uint64_t>(board.grid_size) * board.grid_size;
+
+    //Tracked tiles' cells then the blank's
+    std::vector<int> start;
+    for (uint8_t tile : tracked) {
+        start.push_back(board.positions[tile]);
+    }
+    start.push_back(board.blank);
+
+    if (goal(start)) {
+        return true;
+    }
+
+    auto encode = [cells](std::vector<int> const& state) {
+        uint64_t key = 0;
+        for (auto it = state.rbegin(); it != state.rend(); it++) {
+            key = key * cells + *it;
+        }
+        return key;
+    };
+
+    auto decode = [cells, &start](uint64_t key) {
+        std::vector<int> state(start.size());
+        for (size_t i = 0; i < state.size(); i++) {
+            state[i] = static_cast<int>(key % cells);
+            key /= cells;
+        }
+        return state;
+    };
+
+    uint64_t start_key = encode(start);
+    std::unordered_map< uint64_t, std::pair<uint64_t, TaquinSolve::Moves> > parents;
+    std::queue<uint64_t> open;
+
+    parents.insert(std::pair(start_key, std::pair(start_key, TaquinSolve::Moves::UP)));
+    open.push(start_key);
+
+    while (!open.empty()) {
+        uint64_t key = open.front();
+        open.pop();
+
+        std::vector<int> state = decode(key);
+        int blank = state.back();
+
+        for (TaquinSolve::Moves move : all_moves) {
+            int to = neighbour(blank, move, board.grid_size);
+            if (to < 0 || !region[to]) {
+                continue;
+            }
+
+            std::vector<int> next = state;
+            for (size_t i = 0; i < tracked.size(); i++) {
+                if (next[i] == to) {
+                    next[i] = blank;
+                }
+            }
+            next.back() = to;
+
+            uint64_t next_key = encode(next);
+            if (parents.count(next_key) > 0) {
+                continue;
+            }
+            parents.insert(std::pair(next_key, std::pair(key, move)));
+
+            if (goal(next)) {
+                std::vector<TaquinSolve::Moves> path;
+                for (uint64_t at = next_key; at != start_key; at = parents[at].first) {
+                    path.push_back(parents[at].second);
+                }
+
+                for (auto it = path.rbegin(); it != path.rend(); it++) {
+                    board.apply(*it);
+                }
+                return true;
+            }
+
+            open.push(next_key);
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Unlocked cells, less some that must stay put.
+ */
+static std::vector<bool> free_cells(RealtimeBoard const& board, std::vector<int> const& excluded = {})
+{
+    std::vector<bool> region(board.locked.size());
+    for (size_t cell = 0; cell < region.size(); cell++) {
+        region[cell] = !board.locked[cell];
+    }
+
+    for (int cell : excluded) {
+        region[cell] = false;
+    }
+
+    return region;
+}
+
+/**
+ * Move a tile home, searching around it first and the whole board only if that fails.
+ */
+static void place_tile(RealtimeBoard &board, uint8_t tile)
+{
+    int grid_size = board.grid_size;
+    int home = tile - 1;
+    auto goal = [home](std::vector<int> const& state) {
+        return state[0] == home;
+    };
+
+    int cells[3] = {board.positions[tile], board.blank, home};
+    int left = grid_size, right = 0, top = grid_size, bottom = 0;
+    for (int cell : cells) {
+        left = std::min(left, cell % grid_size);
+        right = std::max(right, cell % grid_size);
+        top = std::min(top, cell / grid_size);
+        bottom = std::max(bottom, cell / grid_size);
+    }
+
+    std::vector<bool> region = free_cells(board);
+    std::vector<bool> nearby = region;
+    for (int cell = 0; cell < grid_size * grid_size; cell++) {
+        int x = cell % grid_size, y = cell / grid_size;
+        nearby[cell] = nearby[cell] && x >= left - 1 && x <= right + 1 && y >= top - 1 && y <= bottom + 1;
+    }
+
+    if (!move_tiles(board, {tile}, nearby, goal) && !move_tiles(board, {tile}, region, goal)) {
+        throw std::runtime_error("Couldn't place tile " + std::to_string(tile) + ".");
+    }
+
+    board.locked[home] = true;
+}
+
+/**
+ * Move two or three tiles home together within a region, for the ends of rows and columns
+ * that can't be placed one at a time.
+ */
+static void place_tiles(RealtimeBoard &board, std::vector<uint8_t> const& tiles, std::vector<bool> const& region)
+{
+    auto goal = [&tiles](std::vector<int> const& state) {
+        for (size_t i = 0; i < tiles.size(); i++) {
+            if (state[i] != tiles[i] - 1) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (!move_tiles(board, tiles, region, goal)) {
+        throw std::runtime_error("Couldn't place tile " + std::to_string(tiles[0]) + ".");
+    }
+
+    for (uint8_t tile : tiles) {
+        board.locked[tile - 1] = true;
+    }
+}
+
+/**
+ * Solve quickly but not optimally, for any board size.
+ *
+ * Rows are solved top to bottom until two are left, then those two column by column, each
+ * step a small breadth first search. The last two tiles of a row are first brought into the
+ * three rows below and including it, then placed together within those rows.
+ *
+ * @return The moves of the blank.
+ */
+std::queue<TaquinSolve::Moves> Search::solve_realtime(std::vector<uint8_t> const& initial_position, int grid_size)
+{
+    if (!Search::is_solvable(initial_position, grid_size)) {
+        throw std::runtime_error("Puzzle can't be solved.");
+    }
+
+    int cells = grid_size * grid_size;
+
+    RealtimeBoard board;
+    board.grid_size = grid_size;
+    board.tiles = initial_position;
+    board.positions.resize(cells);
+    board.locked.assign(cells, false);
+    for (int cell = 0; cell < cells; cell++) {
+        board.positions[initial_position[cell]] = cell;
+        if (initial_position[cell] == 0) {
+            board.blank = cell;
+        }
+    }
+
+    for (int row = 0; row < grid_size - 2; row++) {
+        for (int column = 0; column < grid_size - 2; column++) {
+            place_tile(board, static_cast<uint8_t>(row * grid_size + column + 1));
+        }
+
+        uint8_t first = static_cast<uint8_t>(row * grid_size + grid_size - 1);
+        uint8_t second = static_cast<uint8_t>(first + 1);
+        int last_row = row + 2;
+        auto in_band = [grid_size, last_row](std::vector<int> const& state) {
+            return state[0] / grid_size <= last_row;
+        };
+
+        //Bring both tiles and the blank into the band, holding the first still while the second moves
+        if (!move_tiles(board, {first}, free_cells(board), in_band)) {
+            throw std::runtime_error("Couldn't place tile " + std::to_string(first) + ".");
+        }
+        if (!move_tiles(board, {second}, free_cells(board, {board.positions[first]}), in_band)) {
+            if (!move_tiles(board, {second}, free_cells(board), in_band) ||
+                !move_tiles(board, {first}, free_cells(board, {board.positions[second]}), in_band)) {
+                throw std::runtime_error("Couldn't place tile " + std::to_string(second) + ".");
+            }
+        }
+        auto blank_in_band = [grid_size, last_row](std::vector<int> const& state) {
+            return state.back() / grid_size <= last_row;
+        };
+        if (!move_tiles(board, {}, free_cells(board, {board.positions[first], board.positions[second]}), blank_in_band)) {
+            throw std::runtime_error("Couldn't place tile " + std::to_string(first) + ".");
+        }
+
+        std::vector<bool> band = free_cells(board);
+        for (int cell = (last_row + 1) * grid_size; cell < cells; cell++) {
+            band[cell] = false;
+        }
+        place_tiles(board, {first, second}, band);
+    }
+
+    //The last two rows, column by column
+    for (int column = 0; column < grid_size - 2; column++) {
+        uint8_t top = static_cast<uint8_t>((grid_size - 2) * grid_size + column + 1);
+        place_tiles(board, {top, static_cast<uint8_t>(top + grid_size)}, free_cells(board));
+    }
+
+    uint8_t last = static_cast<uint8_t>(cells - 1);
+    place_tiles(board, {static_cast<uint8_t>(last - grid_size), static_cast<uint8_t>(last - grid_size + 1), last}, free_cells(board));
+
+    std::queue<TaquinSolve::Moves> move_sequence;
+    for (TaquinSolve::Moves move : board.moves) {
+        move_sequence.push(move);
+    }
+    return move_sequence;
+}
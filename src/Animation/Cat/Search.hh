@@ -0,0 +1,41 @@
+#pragma once
+
+#include <taquinsolve.hh>
+#include <vector>
+#include <queue>
+#include <atomic>
+#include <chrono>
+
+#include "PatternDatabase.hh"
+
+namespace Animate::Tasks
+{
+    class ThreadPool;
+}
+
+namespace Animate::Animation::Cat
+{
+    class TranspositionTable;
+
+    /**
+     * Sliding puzzle searches. Boards list the tile in each cell, 0 for the blank, and are solved
+     * with tile t in cell t-1 and the blank last. Solutions are the moves of the blank.
+     */
+    namespace Search
+    {
+        bool is_solvable(std::vector<uint8_t> const& initial_position, int grid_size);
+
+        bool solve_optimal(
+            std::vector<uint8_t> const& initial_position,
+            int grid_size,
+            PatternDatabase const *database,
+            std::chrono::steady_clock::time_point deadline,
+            std::atomic_bool const& cancelled,
+            std::queue<TaquinSolve::Moves> &move_sequence,
+            Tasks::ThreadPool *thread_pool = nullptr,
+            TranspositionTable *table = nullptr
+        );
+
+        std::queue<TaquinSolve::Moves> solve_realtime(std::vector<uint8_t> const& initial_position, int grid_size);
+    }
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+
+#include "Solver.hh"
+#include "Search.hh"
+#include "../../Utilities.hh"
+
+using namespace Animate;
+using namespace Animate::Animation::Cat;
+
+/**
+ * The pattern databases in the resource pack for a board size, or null if none were built for it.
+ */
+static std::shared_ptr<PatternDatabase> load_database(int grid_size)
+{
+    std::string key = "data/Cat/pattern-" + std::to_string(grid_size) + "x" + std::to_string(grid_size) + ".pdb";
+
+    ResourceSpan resource;
+    try {
+        resource = Utilities::get_resource_as_bytes(key);
+    } catch (std::runtime_error const& e) {
+        std::cout << "No pattern database for " << grid_size << "x" << grid_size << " boards: " << e.what() << std::endl;
+        return nullptr;
+    }
+
+    std::shared_ptr<PatternDatabase> database = std::make_shared<PatternDatabase>(resource.data, resource.size);
+    if (database->get_width() != grid_size) {
+        throw std::runtime_error("Pattern database is for the wrong board size: " + key);
+    }
+
+    return database;
+}
+
+/**
+ * Constructor.
+ * Loads the pattern databases for the board size and starts solving straight away.
+ *
+ * @param grid_size    Width and height of the boards.
+ * @param capacity     How many solved puzzles to keep ready.
+ * @param timeout      How long an optimal solve may take before falling back.
+ * @param thread_count How many threads each optimal solve searches with.
+ */
+Solver::Solver(int grid_size, size_t capacity, std::chrono::milliseconds timeout, size_t thread_count) :
+    grid_size(grid_size),
+    timeout(timeout),
+    database(load_database(grid_size)),
+    //The solver's own thread searches too
+    search_pool(thread_count > 1 ? std::make_unique<Tasks::ThreadPool>(thread_count - 1) : nullptr),
+    solve_times("Cat", "fallbacks"),
+    puzzles(capacity, [this](std::atomic_bool const& cancelled) {
+        return this->solve(cancelled);
+    })
+{
+}
+
+/**
+ * Destructor.
+ * Cancels the search in progress and waits for it to stop.
+ */
+Solver::~Solver()
+{
+    this->cancel();
+}
+
+/**
+ * Take a solved puzzle if one is ready, without waiting.
+ */
+bool Solver::try_take(Puzzle &puzzle)
+{
+    return this->puzzles.try_take(puzzle);
+}
+
+/**
+ * Take a solved puzzle, waiting for one.
+ *
+ * @return False if cancelled before one was ready.
+ */
+bool Solver::take(Puzzle &puzzle)
+{
+    return this->puzzles.take(puzzle);
+}
+
+/**
+ * Stop solving, a search in progress is abandoned.
+ */
+void Solver::cancel()
+{
+    this->puzzles.cancel();
+}
+
+/**
+ * Shuffle a solvable board and solve it optimally, or quickly if that takes too long.
+ */
+Puzzle Solver::solve(std::atomic_bool const& cancelled)
+{
+    std::vector<uint8_t> initial_position;
+    do {
+        initial_position = taquin_generate_vector(this->grid_size);
+    } while (!Search::is_solvable(initial_position, this->grid_size));
+
+    uint64_t start_time = Utilities::get_micro_time();
+
+    Puzzle puzzle;
+    puzzle.initial_position = initial_position;
+
+    bool solved = Search::solve_optimal(
+        initial_position,
+        this->grid_size,
+        this->database.get(),
+        std::chrono::steady_clock::now() + this->timeout,
+        cancelled,
+        puzzle.move_sequence,
+        this->search_pool.get(),
+        &this->transpositions
+    );
+
+    if (!solved) {
+        puzzle.move_sequence = Search::solve_realtime(initial_position, this->grid_size);
+        puzzle.optimal = false;
+    }
+
+    this->solve_times.record((Utilities::get_micro_time() - start_time) / 1000, !puzzle.optimal);
+
+    return puzzle;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <taquinsolve.hh>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include "../../Tasks/BackgroundSolver.hh"
+#include "../../Tasks/SolveTimes.hh"
+#include "../../Tasks/ThreadPool.hh"
+#include "PatternDatabase.hh"
+#include "TranspositionTable.hh"
+
+namespace Animate::Animation::Cat
+{
+    /**
+     * A shuffled board and the moves of the blank that solve it.
+     */
+    struct Puzzle {
+        std::vector<uint8_t> initial_position;
+        std::queue<TaquinSolve::Moves> move_sequence;
+        bool optimal = true;
+    };
+
+    /**
+     * Generates and solves puzzles on its own thread, keeping a few ready so the tick thread
+     * never waits on a search.
+     *
+     * Optimal solves that take longer than the timeout, as most 5x5 boards do, are abandoned
+     * for a quicker real-time solution. See Search.hh.
+     */
+    class Solver
+    {
+        public:
+            Solver(
+                int grid_size,
+                size_t capacity = 4,
+                std::chrono::milliseconds timeout = std::chrono::milliseconds(1000),
+                size_t thread_count = std::thread::hardware_concurrency()
+            );
+            ~Solver();
+
+            bool try_take(Puzzle &puzzle);
+            bool take(Puzzle &puzzle);
+            void cancel();
+
+        private:
+            int grid_size;
+            std::chrono::milliseconds timeout;
+
+            std::shared_ptr<PatternDatabase> database;
+            TranspositionTable transpositions;
+
+            //Helps the worker search, null when it searches alone
+            std::unique_ptr<Tasks::ThreadPool> search_pool;
+
+            Tasks::SolveTimes solve_times;
+
+            //Last, so its worker stops before anything it searches with is destroyed
+            Tasks::BackgroundSolver<Puzzle> puzzles;
+
+            Puzzle solve(std::atomic_bool const& cancelled);
+    };
+}
@@ -0,0 +1,53 @@
+#include "TranspositionTable.hh"
+
+using namespace Animate::Animation::Cat;
+
+/**
+ * Constructor.
+ *
+ * @param entry_count How many boards to remember, rounded up to a power of two.
+ */
+TranspositionTable::TranspositionTable(size_t entry_count) : stripes(TranspositionTable::stripe_count)
+{
+    size_t size = TranspositionTable::stripe_count;
+    while (size < entry_count) {
+        size <<= 1;
+    }
+
+    this->entries.resize(size);
+    this->mask = size - 1;
+}
+
+/**
+ * Forget everything, called before each iteration of a search.
+ */
+void TranspositionTable::next_iteration()
+{
+    this->iteration++;
+}
+
+/**
+ * Record reaching a board.
+ *
+ * @param board The board.
+ * @param cost  Moves taken to reach it.
+ *
+ * @return False if it was already reached this iteration in as few moves.
+ */
+bool TranspositionTable::visit(PackedBoard const& board, uint32_t cost)
+{
+    uint32_t iteration = this->iteration;
+    size_t index = board.hash() & this->mask;
+
+    std::lock_guard<std::mutex> guard(this->stripes[index % TranspositionTable::stripe_count]);
+    Entry &entry = this->entries[index];
+
+    if (entry.iteration == iteration && entry.board == board && entry.cost <= cost) {
+        return false;
+    }
+
+    entry.board = board;
+    entry.cost = cost;
+    entry.iteration = iteration;
+    return true;
+}
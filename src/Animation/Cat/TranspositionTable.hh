@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "PackedBoard.hh"
+
+namespace Animate::Animation::Cat
+{
+    /**
+     * Boards reached by an IDA* iteration and the fewest moves they were reached in, shared by
+     * every thread searching it. A board reached again in no fewer moves has already been
+     * searched, so it can be skipped.
+     *
+     * Fixed size, newer entries replace older ones. Entries are locked in stripes.
+     */
+    class TranspositionTable
+    {
+        public:
+            TranspositionTable(size_t entry_count = 1 << 18);
+
+            void next_iteration();
+            bool visit(PackedBoard const& board, uint32_t cost);
+
+        private:
+            struct Entry {
+                PackedBoard board;
+                uint32_t cost = 0;
+                uint32_t iteration = 0;
+            };
+
+            static const size_t stripe_count = 256;
+
+            std::vector<Entry> entries;
+            std::vector<std::mutex> stripes;
+            size_t mask;
+
+            //Entries from earlier iterations are ignored rather than cleared
+            std::atomic<uint32_t> iteration = 0;
+    };
+}
@@ -30,10 +30,18 @@ void Fractal::initialise()
 {
     std::weak_ptr<VK::Context> graphics_context = this->context.lock()->get_graphics_context();
 
-    //Set shaders
-    this->shader = this->context.lock()->get_graphics_context().lock()->create_pipeline(
-        "data/Fractal/shader.frag.spv",
-        "data/Fractal/shader.vert.spv"
+    //Use native doubles where the device supports them, otherwise emulate them with pairs of floats
+    std::string fragment_code_id = graphics_context.lock()->shader_float64 ?
+        "data/Fractal/shader-fp64.frag.spv" :
+        "data/Fractal/shader-emulated.frag.spv";
+
+    //Set shaders, a full screen quad gains nothing from multisampling
+    this->shader = this->create_pipeline(
+        fragment_code_id,
+        "data/Fractal/shader.vert.spv",
+        {},
+        sizeof(FractalUniforms),
+        VK::RenderSettings::single_sampled()
     );
 
     //Look at
@@ -43,30 +51,41 @@ void Fractal::initialise()
     );
 
     //Ortho
-    Matrix projection_matrix = Matrix::orthographic(-2., 1., -1.5, 1.5, 0, 1);
+    Matrix projection_matrix = Matrix::orthographic(0, 1, 0, 1, 0, 1);
 
     this->shader.lock()->set_matrices(view_matrix, projection_matrix);
 
-    //Add a Quad
+    //Add a Quad, the view into the complex plane is applied in the fragment shader
     Object::Object *object = new Object::Object(graphics_context);
     std::shared_ptr<Quad> quad(new Quad(graphics_context));
-    quad->set_buffer_transform(
-        Matrix::identity()
-            .scale(Vector3(3., 3., 1.))
-            .translate(Vector3(-2, -1.5, 0.))
-    );
     quad->initialise(
         this->shader
     );
     object->add_component(quad);
     this->add_object("quad", object);
 
+    //Points on the boundary of the set, so there's detail at any depth
     this->zoom_points = {
-        Point(0.42884,-0.231345),
-        Point(-1.62917,-0.0203968),
-        Point(-0.761574,-0.0847596),
-        Point(-0.170337,-1.06506)
+        std::make_pair(-0.743643887037151, 0.131825904205330),
+        std::make_pair(0.001643721971153, -0.822467633298876),
+        std::make_pair(-0.101096363845622, 0.956286510809142),
+        std::make_pair(-1.768778833, -0.001738996)
     };
+
+    //Double precision gives about 1e6 times more zoom before the image breaks down
+    this->max_zoom = 8. + log(1e6);
+}
+
+/**
+ * Split a double into a float and the float remainder.
+ *
+ * @param value The value to split.
+ * @param parts Output array of two floats.
+ */
+void Fractal::split_double(double value, float *parts)
+{
+    parts[0] = static_cast<float>(value);
+    parts[1] = static_cast<float>(value - static_cast<double>(parts[0]));
 }
 
 /**
@@ -75,27 +94,33 @@ void Fractal::initialise()
 void Fractal::on_tick(uint64_t time_delta)
 {
     this->timer += time_delta;
-    float zoom_factor = static_cast<float>(this->timer / 10000) / 100.;
-    if (zoom_factor > 16.) {
+    double zoom_factor = static_cast<double>(this->timer / 10000) / 100.;
+    if (zoom_factor > 2. * this->max_zoom) {
         zoom_factor = 0;
         this->timer = 0;
 
         //Pick a new zoom point
-        this->current_zoom_point = (this->current_zoom_point+1)%4;
-    } else if (zoom_factor > 8.) {
-        zoom_factor = 16. - zoom_factor;
+        this->current_zoom_point = (this->current_zoom_point+1)%this->zoom_points.size();
+    } else if (zoom_factor > this->max_zoom) {
+        zoom_factor = 2. * this->max_zoom - zoom_factor;
     }
 
-    auto object = this->get_object("quad");
+    //Move from the full view toward the zoom point while zooming in, all in double precision
+    std::pair<double, double> zoom_point = this->zoom_points[this->current_zoom_point];
+    double shrink = exp(-zoom_factor);
+    double centre_x = zoom_point.first + (-0.5 - zoom_point.first) * shrink;
+    double centre_y = zoom_point.second + (0. - zoom_point.second) * shrink;
 
-    object.lock()->set_model_matrix(
-        Matrix::identity()
-            .translate(Vector3()-this->zoom_points[this->current_zoom_point])
-            .scale(Vector2(exp(zoom_factor), exp(zoom_factor)))
-            .rotate(Vector3(0.,0.,zoom_factor))
-            .translate(this->zoom_points[this->current_zoom_point])
-            .translate(Vector3(zoom_factor/32., zoom_factor/32.))
-    );
+    FractalUniforms uniforms;
+    Fractal::split_double(centre_x, uniforms.centre_x);
+    Fractal::split_double(centre_y, uniforms.centre_y);
+    Fractal::split_double(3. * shrink, uniforms.scale);
+    uniforms.rotation = static_cast<float>(zoom_factor);
+    uniforms.max_iterations = 256 + static_cast<int32_t>(zoom_factor * 48.);
+
+    this->shader.lock()->set_uniform_data(&uniforms, sizeof(FractalUniforms));
+
+    this->get_object("quad").lock()->set_model_matrix(Matrix::identity());
 
     Animation::on_tick(time_delta);
 }
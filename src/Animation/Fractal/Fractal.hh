@@ -1,5 +1,7 @@
 #pragma once
 
+#include <utility>
+
 #include "../Animation.hh"
 #include "../../VK/Pipeline.hh"
 #include "../../Geometry/Definitions.hh"
@@ -9,6 +11,18 @@ using namespace Animate::Geometry;
 
 namespace Animate::Animation::Fractal
 {
+    /**
+     * Layout of the fractal shaders' uniform block.
+     * Doubles are split into high and low floats so both shader variants can share it.
+     */
+    struct FractalUniforms {
+        float centre_x[2];
+        float centre_y[2];
+        float scale[2];
+        float rotation;
+        int32_t max_iterations;
+    };
+
     class Fractal : public Animation
     {
         public:
@@ -19,8 +33,11 @@ namespace Animate::Animation::Fractal
 
         protected:
             std::weak_ptr<VK::Pipeline> shader;
-            std::vector<Point> zoom_points;
+            std::vector< std::pair<double, double> > zoom_points;
             uint8_t current_zoom_point = 0;
             uint64_t timer = 0;
+            double max_zoom = 8.;
+
+            static void split_double(double value, float *parts);
     };
 }
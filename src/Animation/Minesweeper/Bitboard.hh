@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+namespace Animate::Animation::Minesweeper
+{
+    /**
+     * One bit per cell of a board, each row starting on a fresh 64 bit word so whole rows can
+     * be shifted and combined a word at a time.
+     */
+    class Bitboard
+    {
+        public:
+            Bitboard() = default;
+
+            Bitboard(uint32_t width, uint32_t height) :
+                width(width),
+                height(height),
+                stride((width + 63) / 64),
+                words(static_cast<size_t>((width + 63) / 64) * height, 0)
+            {
+            }
+
+            bool get(uint32_t cell) const
+            {
+                return (this->words[this->word(cell)] >> ((cell % this->width) & 63)) & 1;
+            }
+
+            void set(uint32_t cell)
+            {
+                this->words[this->word(cell)] |= uint64_t(1) << ((cell % this->width) & 63);
+            }
+
+            void reset(uint32_t cell)
+            {
+                this->words[this->word(cell)] &= ~(uint64_t(1) << ((cell % this->width) & 63));
+            }
+
+            void clear()
+            {
+                std::fill(this->words.begin(), this->words.end(), 0);
+            }
+
+            /**
+             * Set every cell.
+             */
+            void fill()
+            {
+                std::fill(this->words.begin(), this->words.end(), ~uint64_t(0));
+
+                //Bits past the end of each row don't belong to any cell
+                if (this->width % 64 != 0) {
+                    for (uint32_t row = 0; row < this->height; row++) {
+                        this->words[row * this->stride + this->stride - 1] = (uint64_t(1) << (this->width % 64)) - 1;
+                    }
+                }
+            }
+
+            size_t count() const
+            {
+                size_t total = 0;
+                for (uint64_t word : this->words) {
+                    total += __builtin_popcountll(word);
+                }
+                return total;
+            }
+
+            Bitboard& operator|=(Bitboard const& other)
+            {
+                for (size_t i = 0; i < this->words.size(); i++) {
+                    this->words[i] |= other.words[i];
+                }
+                return *this;
+            }
+
+            /**
+             * Clear every cell set in other.
+             */
+            Bitboard& remove(Bitboard const& other)
+            {
+                for (size_t i = 0; i < this->words.size(); i++) {
+                    this->words[i] &= ~other.words[i];
+                }
+                return *this;
+            }
+
+            /**
+             * Every cell set, or next to one that is.
+             */
+            Bitboard dilate() const
+            {
+                Bitboard across(this->width, this->height);
+
+                for (uint32_t row = 0; row < this->height; row++) {
+                    uint64_t const *in = &this->words[row * this->stride];
+                    uint64_t *out = &across.words[row * this->stride];
+
+                    for (uint32_t i = 0; i < this->stride; i++) {
+                        uint64_t right = (in[i] << 1) | (i > 0 ? in[i - 1] >> 63 : 0);
+                        uint64_t left = (in[i] >> 1) | (i + 1 < this->stride ? in[i + 1] << 63 : 0);
+                        out[i] = in[i] | left | right;
+                    }
+
+                    if (this->width % 64 != 0) {
+                        out[this->stride - 1] &= (uint64_t(1) << (this->width % 64)) - 1;
+                    }
+                }
+
+                Bitboard result = across;
+                for (uint32_t row = 0; row < this->height; row++) {
+                    for (uint32_t i = 0; i < this->stride; i++) {
+                        uint64_t &word = result.words[row * this->stride + i];
+                        if (row > 0) {
+                            word |= across.words[(row - 1) * this->stride + i];
+                        }
+                        if (row + 1 < this->height) {
+                            word |= across.words[(row + 1) * this->stride + i];
+                        }
+                    }
+                }
+
+                return result;
+            }
+
+            /**
+             * The cell of the nth set bit, counting from zero.
+             */
+            uint32_t nth(size_t n) const
+            {
+                for (size_t i = 0; i < this->words.size(); i++) {
+                    size_t bits = __builtin_popcountll(this->words[i]);
+                    if (n >= bits) {
+                        n -= bits;
+                        continue;
+                    }
+
+                    uint64_t word = this->words[i];
+                    for (; n > 0; n--) {
+                        word &= word - 1;
+                    }
+
+                    uint32_t row = static_cast<uint32_t>(i / this->stride);
+                    uint32_t column = static_cast<uint32_t>((i % this->stride) * 64 + __builtin_ctzll(word));
+                    return row * this->width + column;
+                }
+
+                return this->width * this->height;
+            }
+
+        private:
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t stride = 0;
+            std::vector<uint64_t> words;
+
+            size_t word(uint32_t cell) const
+            {
+                return (cell / this->width) * this->stride + (cell % this->width) / 64;
+            }
+    };
+}
@@ -0,0 +1,225 @@
+#include <stdexcept>
+#include <algorithm>
+
+#include "Field.hh"
+
+using namespace Animate::Animation::Minesweeper;
+
+/**
+ * Constructor.
+ * An empty field, nothing flipped.
+ */
+Field::Field(uint32_t width, uint32_t height) :
+    width(width),
+    height(height),
+    mines(width, height),
+    flipped(width, height),
+    flagged(width, height),
+    values(static_cast<size_t>(width) * height, 0)
+{
+}
+
+/**
+ * Lay mines at random, none on or next to the first cell flipped so it opens an area.
+ */
+Field Field::generate(uint32_t width, uint32_t height, uint32_t mine_count, uint32_t first_flip, std::mt19937 &generator)
+{
+    uint32_t cells = width * height;
+    if (first_flip >= cells || mine_count + 9 > cells) {
+        throw std::runtime_error("Invalid minefield requested.");
+    }
+
+    Field field(width, height);
+    field.mine_count = mine_count;
+
+    uint32_t safe[9];
+    int safe_count = field.get_neighbours(first_flip, safe);
+    safe[safe_count++] = first_flip;
+
+    std::uniform_int_distribution<uint32_t> distribution(0, cells - 1);
+    for (uint32_t placed = 0; placed < mine_count;) {
+        uint32_t position = distribution(generator);
+        if (field.mines.get(position) || std::find(safe, safe + safe_count, position) != safe + safe_count) {
+            continue;
+        }
+
+        field.mines.set(position);
+        placed++;
+
+        uint32_t neighbours[8];
+        int neighbour_count = field.get_neighbours(position, neighbours);
+        for (int i = 0; i < neighbour_count; i++) {
+            field.values[neighbours[i]]++;
+        }
+    }
+
+    return field;
+}
+
+/**
+ * Uncover a cell. Cells with no mines around them uncover their neighbours too.
+ *
+ * @param position The cell.
+ * @param flipped  Where to list every cell uncovered, may be null.
+ */
+void Field::flip(uint32_t position, std::vector<uint32_t> *flipped)
+{
+    if (this->status != MapStatus::IN_PROGRESS || this->flipped.get(position) || this->flagged.get(position)) {
+        return;
+    }
+
+    std::vector<uint32_t> pending = {position};
+    this->flipped.set(position);
+
+    while (!pending.empty()) {
+        uint32_t cell = pending.back();
+        pending.pop_back();
+
+        this->flipped_count++;
+        if (flipped != nullptr) {
+            flipped->push_back(cell);
+        }
+
+        if (this->mines.get(cell)) {
+            this->status = MapStatus::FAILED;
+            return;
+        }
+
+        if (this->values[cell] != 0) {
+            continue;
+        }
+
+        uint32_t neighbours[8];
+        int neighbour_count = this->get_neighbours(cell, neighbours);
+        for (int i = 0; i < neighbour_count; i++) {
+            uint32_t neighbour = neighbours[i];
+            if (!this->flipped.get(neighbour) && !this->flagged.get(neighbour)) {
+                this->flipped.set(neighbour);
+                pending.push_back(neighbour);
+            }
+        }
+    }
+
+    if (this->flipped_count + this->mine_count == this->width * this->height) {
+        this->status = MapStatus::COMPLETE;
+    }
+}
+
+/**
+ * Mark a cell as a mine.
+ */
+void Field::flag(uint32_t position)
+{
+    if (this->status != MapStatus::IN_PROGRESS || this->flipped.get(position)) {
+        return;
+    }
+
+    this->flagged.set(position);
+}
+
+void Field::apply(Operation operation, std::vector<uint32_t> *flipped)
+{
+    switch (operation.type) {
+        case OperationType::FLIP:
+            this->flip(operation.position, flipped);
+            break;
+        case OperationType::FLAG:
+            this->flag(operation.position);
+            break;
+    }
+}
+
+/**
+ * Cover every cell again, keeping the mines.
+ */
+void Field::reset()
+{
+    this->flipped.clear();
+    this->flagged.clear();
+    this->flipped_count = 0;
+    this->status = MapStatus::IN_PROGRESS;
+}
+
+uint32_t Field::get_width() const
+{
+    return this->width;
+}
+
+uint32_t Field::get_height() const
+{
+    return this->height;
+}
+
+uint32_t Field::get_mine_count() const
+{
+    return this->mine_count;
+}
+
+MapStatus Field::get_status() const
+{
+    return this->status;
+}
+
+TileState Field::get_tile(uint32_t position) const
+{
+    return TileState{
+        this->mines.get(position),
+        this->flagged.get(position),
+        this->flipped.get(position),
+        this->values[position]
+    };
+}
+
+/**
+ * How many of a cell's neighbours are mines.
+ */
+uint8_t Field::get_value(uint32_t position) const
+{
+    return this->values[position];
+}
+
+bool Field::is_flipped(uint32_t position) const
+{
+    return this->flipped.get(position);
+}
+
+bool Field::is_flagged(uint32_t position) const
+{
+    return this->flagged.get(position);
+}
+
+Bitboard const& Field::get_flipped() const
+{
+    return this->flipped;
+}
+
+Bitboard const& Field::get_flagged() const
+{
+    return this->flagged;
+}
+
+/**
+ * The cells around one, fewer at the edges.
+ *
+ * @param neighbours Room for eight cells.
+ *
+ * @return How many were written.
+ */
+int Field::get_neighbours(uint32_t position, uint32_t *neighbours) const
+{
+    uint32_t x = position % this->width;
+    uint32_t y = position / this->width;
+
+    int count = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            if ((dx == 0 && dy == 0) ||
+                (dx < 0 && x == 0) || (dx > 0 && x + 1 == this->width) ||
+                (dy < 0 && y == 0) || (dy > 0 && y + 1 == this->height)) {
+                continue;
+            }
+            neighbours[count++] = (y + dy) * this->width + (x + dx);
+        }
+    }
+    return count;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <random>
+
+#include "Bitboard.hh"
+
+namespace Animate::Animation::Minesweeper
+{
+    enum class MapStatus {
+        IN_PROGRESS,
+        COMPLETE,
+        FAILED
+    };
+
+    enum class OperationType {
+        FLIP,
+        FLAG
+    };
+
+    /**
+     * One step of a solution.
+     */
+    struct Operation {
+        OperationType type;
+        uint32_t position;
+    };
+
+    /**
+     * What's known about one cell, and what's under it.
+     */
+    struct TileState {
+        bool mine;
+        bool flagged;
+        bool flipped;
+        uint8_t value;
+    };
+
+    /**
+     * A minefield and how much of it has been uncovered. Cells are numbered row by row.
+     */
+    class Field
+    {
+        public:
+            Field() = default;
+            Field(uint32_t width, uint32_t height);
+
+            static Field generate(uint32_t width, uint32_t height, uint32_t mine_count, uint32_t first_flip, std::mt19937 &generator);
+
+            void flip(uint32_t position, std::vector<uint32_t> *flipped = nullptr);
+            void flag(uint32_t position);
+            void apply(Operation operation, std::vector<uint32_t> *flipped = nullptr);
+            void reset();
+
+            uint32_t get_width() const;
+            uint32_t get_height() const;
+            uint32_t get_mine_count() const;
+            MapStatus get_status() const;
+            TileState get_tile(uint32_t position) const;
+            uint8_t get_value(uint32_t position) const;
+            bool is_flipped(uint32_t position) const;
+            bool is_flagged(uint32_t position) const;
+
+            Bitboard const& get_flipped() const;
+            Bitboard const& get_flagged() const;
+
+            int get_neighbours(uint32_t position, uint32_t *neighbours) const;
+
+        private:
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t mine_count = 0;
+            uint32_t flipped_count = 0;
+            MapStatus status = MapStatus::IN_PROGRESS;
+
+            Bitboard mines;
+            Bitboard flipped;
+            Bitboard flagged;
+
+            //Mines around each cell
+            std::vector<uint8_t> values;
+    };
+}
@@ -0,0 +1,290 @@
+#define VULKAN_HPP_DISABLE_ENHANCED_MODE 1
+#include <vulkan/vulkan.hpp>
+#include <GLFW/glfw3.h>
+#include <cmath>
+#include <algorithm>
+
+#include "LargeMinesweeper.hh"
+#include "Minesweeper.hh"
+#include "../../Utilities.hh"
+#include "../../Geometry/Matrix.hh"
+#include "../../VK/Context.hh"
+#include "../../Object/Object.hh"
+
+using namespace Animate::Animation::Minesweeper;
+using namespace Animate::Geometry;
+using namespace Animate::VK;
+
+//Width and height of a chunk in cells. Every chunk owns three buffers, each with its own
+//allocation, so they're kept large enough for a 1024x1024 board to need only a few hundred
+static const uint32_t chunk_size = 64;
+
+//Microseconds between operations, fast enough to clear a 1024x1024 field in a few minutes
+static const uint64_t move_time = 200;
+
+//Microseconds to show a finished field before the next, long enough to see it whole
+static const uint64_t finished_time = 2000000;
+
+//Width of the view in cells when fully zoomed in
+static const float zoomed_size = 48.f;
+
+//Microseconds to zoom in and back out again
+static const uint64_t zoom_period = 30000000;
+
+//Microseconds for the camera to cover most of the way to the play
+static const float camera_lag = 400000.f;
+
+/**
+ * Constructor.
+ *
+ * @param grid_size Width and height of the board, up to max_grid_size.
+ */
+LargeMinesweeper::LargeMinesweeper(std::weak_ptr<AppContext> context, int grid_size) :
+    Animation::Animation(context),
+    grid_size(grid_size),
+    playback(move_time, finished_time)
+{
+    if (grid_size < 4 || grid_size > LargeMinesweeper::max_grid_size) {
+        throw std::runtime_error("Invalid grid size given.");
+    }
+
+    this->camera_x = this->focus_x = grid_size / 2.f;
+    this->camera_y = this->focus_y = grid_size / 2.f;
+    this->camera_size = grid_size;
+}
+
+/**
+ * Perform initialisations.
+ */
+void LargeMinesweeper::initialise()
+{
+    //Set shaders
+    this->shader = this->create_pipeline(
+        "data/Minesweeper/shader.frag.spv",
+        "data/Minesweeper/instanced.vert.spv",
+        Minesweeper::texture_names,
+        sizeof(float),
+        VK::RenderSettings::instanced_streamed()
+    );
+
+    this->update_camera(0);
+
+    this->solver = std::make_unique<Solver>(
+        this->grid_size,
+        this->grid_size,
+        static_cast<uint32_t>(this->grid_size * this->grid_size * Solver::mine_density),
+        1
+    );
+}
+
+/**
+ * Create a chunk for every square of the board, then show the first field.
+ */
+void LargeMinesweeper::on_load()
+{
+    //Chunks are kept between loads
+    if (!this->chunks.empty()) {
+        Animation::on_load();
+        return;
+    }
+
+    //Waits for the first field before building chunks, so a cancelled solver leaves none
+    if (!this->playback.start(*this->solver)) {
+        Animation::on_load();
+        return;
+    }
+
+    std::shared_ptr<Pipeline> pipeline = this->shader.lock();
+    std::shared_ptr<Textures> textures = pipeline->get_textures().lock();
+    std::weak_ptr<VK::Context> graphics_context = this->context.lock()->get_graphics_context();
+
+    //Every image is the same size, so each cell only needs to shift the unflipped one
+    TextureRegion unflipped = textures->get_region(Minesweeper::texture_names[0]);
+    for (std::string const& texture_name : Minesweeper::texture_names) {
+        TextureRegion region = textures->get_region(texture_name);
+        this->texture_offsets.push_back(Vector3(
+            region.u - unflipped.u,
+            region.v - unflipped.v,
+            static_cast<float>(region.page) - static_cast<float>(unflipped.page)
+        ));
+    }
+
+    this->chunks_across = (this->grid_size + chunk_size - 1) / chunk_size;
+    for (uint32_t row = 0; row < this->chunks_across; row++) {
+        for (uint32_t column = 0; column < this->chunks_across; column++) {
+            Chunk chunk;
+            chunk.column = column * chunk_size;
+            chunk.row = row * chunk_size;
+            chunk.width = std::min<uint32_t>(chunk_size, this->grid_size - chunk.column);
+            chunk.height = std::min<uint32_t>(chunk_size, this->grid_size - chunk.row);
+            chunk.dirty = true;
+
+            std::shared_ptr<InstancedQuad> cells = std::make_shared<InstancedQuad>(
+                graphics_context,
+                chunk.width * chunk.height
+            );
+            cells->set_texture_position(unflipped, Vector3(0., 0., 0.), Vector3(1., 1., 0.));
+            cells->initialise(pipeline);
+
+            Animate::Object::Object *object = new Animate::Object::Object(graphics_context);
+            object->add_component(cells);
+            object->set_model_matrix(Matrix::identity());
+
+            this->add_object("chunk" + std::to_string(this->chunks.size()), object);
+
+            chunk.object = this->get_object("chunk" + std::to_string(this->chunks.size()));
+            chunk.cells = cells;
+            this->chunks.push_back(chunk);
+        }
+    }
+
+    Animation::on_load();
+}
+
+/**
+ * Compute a tick
+ */
+void LargeMinesweeper::on_tick(uint64_t time_delta)
+{
+    //Objects aren't ticked through Animation::on_tick, only chunks in view are drawn
+    if (this->chunks.empty()) {
+        return;
+    }
+
+    this->playback.advance(time_delta, *this->solver);
+
+    if (this->playback.needs_full_redraw()) {
+        for (Chunk &chunk : this->chunks) {
+            chunk.dirty = true;
+        }
+    } else {
+        for (uint32_t position : this->playback.get_changed()) {
+            this->mark_dirty(position);
+        }
+    }
+
+    //Follow the latest operation
+    this->focus_x = this->playback.get_last_position() % this->grid_size + .5f;
+    this->focus_y = this->playback.get_last_position() / this->grid_size + .5f;
+
+    //Each field zooms in from the whole board
+    if (this->playback.has_started_field()) {
+        this->camera_time = 0;
+    }
+
+    this->update_chunks();
+    this->update_camera(time_delta);
+
+    for (Chunk const& chunk : this->chunks) {
+        if (this->is_visible(chunk)) {
+            chunk.object.lock()->add_to_scene();
+        }
+    }
+}
+
+/**
+ * Note that a cell changed, so its chunk is rewritten.
+ */
+void LargeMinesweeper::mark_dirty(uint32_t position)
+{
+    uint32_t column = (position % this->grid_size) / chunk_size;
+    uint32_t row = (position / this->grid_size) / chunk_size;
+
+    this->chunks[row * this->chunks_across + column].dirty = true;
+}
+
+/**
+ * Rewrite the instances of every chunk with a changed cell.
+ */
+void LargeMinesweeper::update_chunks()
+{
+    bool any_dirty = std::any_of(this->chunks.begin(), this->chunks.end(), [](Chunk const& chunk) {
+        return chunk.dirty;
+    });
+    if (!any_dirty) {
+        return;
+    }
+
+    std::vector<Instance> instances;
+    Field const& field = this->playback.get_field();
+    MapStatus status = field.get_status();
+
+    //Lock resources so that no frames are drawn while we're updating.
+    std::lock_guard<std::mutex> guard(this->context.lock()->get_graphics_context().lock()->vulkan_resource_mutex);
+
+    for (Chunk &chunk : this->chunks) {
+        if (!chunk.dirty) {
+            continue;
+        }
+
+        instances.resize(chunk.width * chunk.height);
+        for (uint32_t y = 0; y < chunk.height; y++) {
+            for (uint32_t x = 0; x < chunk.width; x++) {
+                uint32_t position = (chunk.row + y) * this->grid_size + chunk.column + x;
+                size_t texture_index = Minesweeper::get_texture_index(field.get_tile(position), status);
+
+                instances[y * chunk.width + x] = Instance(
+                    Vector3(chunk.column + x, chunk.row + y, 0.),
+                    this->texture_offsets[texture_index]
+                );
+            }
+        }
+
+        chunk.cells.lock()->set_instances(instances);
+        chunk.dirty = false;
+    }
+}
+
+/**
+ * Ease the camera toward the latest operation while slowly zooming between the whole board
+ * and a few dozen cells.
+ */
+void LargeMinesweeper::update_camera(uint64_t time_delta)
+{
+    this->camera_time += time_delta;
+
+    //Zoom evenly in scale rather than size, otherwise it rushes through the close up end
+    float zoom = .5f - .5f * cos(2.f * M_PI * (this->camera_time % zoom_period) / zoom_period);
+    float full_size = static_cast<float>(this->grid_size);
+    this->camera_size = full_size * pow(std::min(zoomed_size, full_size) / full_size, zoom);
+
+    float follow = 1.f - exp(-static_cast<float>(time_delta) / camera_lag);
+    this->camera_x += (this->focus_x - this->camera_x) * follow;
+    this->camera_y += (this->focus_y - this->camera_y) * follow;
+
+    //Keep the view on the board
+    float half_size = this->camera_size / 2.f;
+    this->camera_x = std::clamp(this->camera_x, half_size, full_size - half_size);
+    this->camera_y = std::clamp(this->camera_y, half_size, full_size - half_size);
+
+    //Look at
+    Matrix view_matrix = Matrix::look_at(
+        Vector3(0., 0., 1.), // Eye
+        Vector3()            // Center (looking at)
+    );
+
+    //Ortho
+    Matrix projection_matrix = Matrix::orthographic(
+        this->camera_x - half_size,
+        this->camera_x + half_size,
+        this->camera_y - half_size,
+        this->camera_y + half_size,
+        0,
+        1
+    );
+
+    this->shader.lock()->set_matrices(view_matrix, projection_matrix);
+}
+
+/**
+ * Whether any of a chunk is in the camera's view.
+ */
+bool LargeMinesweeper::is_visible(Chunk const& chunk) const
+{
+    float half_size = this->camera_size / 2.f;
+
+    return chunk.column < this->camera_x + half_size &&
+        chunk.column + chunk.width > this->camera_x - half_size &&
+        chunk.row < this->camera_y + half_size &&
+        chunk.row + chunk.height > this->camera_y - half_size;
+}
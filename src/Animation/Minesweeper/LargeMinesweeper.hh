@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "../Animation.hh"
+#include "../../VK/InstancedQuad.hh"
+#include "../../VK/Pipeline.hh"
+#include "../../Geometry/Definitions.hh"
+#include "../../Geometry/Instance.hh"
+#include "Field.hh"
+#include "Solver.hh"
+#include "Playback.hh"
+
+using namespace Animate::Geometry;
+
+namespace Animate::Animation::Minesweeper
+{
+    /**
+     * Minesweeper on boards too large for a drawable per cell.
+     * The board is split into square chunks, each one instanced quad with an instance per cell,
+     * rewritten only when one of its cells changes. A camera follows the play, zooming in and
+     * out, and chunks outside its view aren't drawn.
+     */
+    class LargeMinesweeper : public Animation
+    {
+        /**
+         * A square of cells drawn together.
+         */
+        struct Chunk {
+            std::weak_ptr<Animate::Object::Object> object;
+            std::weak_ptr<VK::InstancedQuad> cells;
+            uint32_t column;
+            uint32_t row;
+            uint32_t width;
+            uint32_t height;
+            bool dirty;
+        };
+
+        public:
+            static const int max_grid_size = 4096;
+
+            LargeMinesweeper(std::weak_ptr<AppContext> context, int grid_size = 1024);
+
+            void initialise() override;
+            void on_load() override;
+            void on_tick(uint64_t time_delta) override;
+
+        protected:
+            std::weak_ptr<VK::Pipeline> shader;
+            int grid_size;
+
+            //Solves upcoming fields off the tick thread
+            std::unique_ptr<Solver> solver;
+            Playback playback;
+
+            std::vector<Chunk> chunks;
+            uint32_t chunks_across = 0;
+
+            //How far each cell image is from the unflipped one in the atlas, by texture index
+            std::vector<Vector3> texture_offsets;
+
+            //Centre and width of the view in cells, and what it's moving toward
+            float camera_x;
+            float camera_y;
+            float camera_size;
+            float focus_x;
+            float focus_y;
+            uint64_t camera_time = 0;
+
+            void mark_dirty(uint32_t position);
+            void update_chunks();
+            void update_camera(uint64_t time_delta);
+            bool is_visible(Chunk const& chunk) const;
+    };
+}
@@ -1,23 +1,50 @@
 #define VULKAN_HPP_DISABLE_ENHANCED_MODE 1
 #include <vulkan/vulkan.hpp>
 #include <GLFW/glfw3.h>
-#include <stdlib.h>
-#include <time.h>
-#include <unistd.h>
 
 #include "Minesweeper.hh"
 #include "../../Utilities.hh"
 #include "../../Geometry/Matrix.hh"
+#include "../../VK/Context.hh"
+#include "../../VK/Quad.hh"
+#include "../../Object/Object.hh"
 
 using namespace Animate::Animation::Minesweeper;
-using namespace Animate::Animation::Minesweeper::Object;
+using namespace Animate::VK;
+
+//Microseconds between operations
+static const uint64_t move_time = 5000;
+
+//Microseconds to show a finished field before the next
+static const uint64_t finished_time = 100000;
+
+//Solved fields to keep ready ahead of the one being played
+static const size_t ready_fields = 4;
+
+const std::vector<std::string> Minesweeper::texture_names = {
+    "data/Minesweeper/unflipped.jpg",
+    "data/Minesweeper/flipped-0.jpg",
+    "data/Minesweeper/flipped-1.jpg",
+    "data/Minesweeper/flipped-2.jpg",
+    "data/Minesweeper/flipped-3.jpg",
+    "data/Minesweeper/flipped-4.jpg",
+    "data/Minesweeper/flipped-5.jpg",
+    "data/Minesweeper/flipped-6.jpg",
+    "data/Minesweeper/flipped-7.jpg",
+    "data/Minesweeper/flipped-8.jpg",
+    "data/Minesweeper/flagged.jpg",
+    "data/Minesweeper/mine-false.jpg",
+    "data/Minesweeper/mine-exploded.jpg",
+    "data/Minesweeper/mine-reveal.jpg"
+};
 
 /**
  * Constructor.
  */
-Minesweeper::Minesweeper(std::weak_ptr<AppContext> context) : Animation::Animation(context)
+Minesweeper::Minesweeper(std::weak_ptr<AppContext> context) :
+    Animation::Animation(context),
+    playback(move_time, finished_time)
 {
-    srand(time(NULL));
 }
 
 /**
@@ -26,26 +53,14 @@ Minesweeper::Minesweeper(std::weak_ptr<AppContext> context) : Animation::Animati
 void Minesweeper::initialise()
 {
     //Set shaders
-    this->shader = this->context.lock()->get_graphics_context().lock()->create_pipeline(
-        "data/Minesweeper/shader.frag.spv",
+    this->shader = this->create_pipeline(
+        "data/Minesweeper/tilemap.frag.spv",
         "data/Minesweeper/shader.vert.spv",
-        {
-            "data/Minesweeper/unflipped.jpg",
-            "data/Minesweeper/flipped-0.jpg",
-            "data/Minesweeper/flipped-1.jpg",
-            "data/Minesweeper/flipped-2.jpg",
-            "data/Minesweeper/flipped-3.jpg",
-            "data/Minesweeper/flipped-4.jpg",
-            "data/Minesweeper/flipped-5.jpg",
-            "data/Minesweeper/flipped-6.jpg",
-            "data/Minesweeper/flipped-7.jpg",
-            "data/Minesweeper/flipped-8.jpg",
-            "data/Minesweeper/flagged.jpg",
-            "data/Minesweeper/mine-false.jpg",
-            "data/Minesweeper/mine-exploded.jpg",
-            "data/Minesweeper/mine-reveal.jpg"
-        }
+        Minesweeper::texture_names,
+        sizeof(TileMap::Uniforms),
+        VK::RenderSettings::tile_mapped(this->grid_size, this->grid_size)
     );
+    this->tile_map = this->shader.lock()->get_tile_map();
 
     //Look at
     Matrix view_matrix = Matrix::look_at(
@@ -57,6 +72,13 @@ void Minesweeper::initialise()
     Matrix projection_matrix = Matrix::orthographic(0, this->grid_size, 0, this->grid_size, 0, 1);
 
     this->shader.lock()->set_matrices(view_matrix, projection_matrix);
+
+    this->solver = std::make_unique<Solver>(
+        this->grid_size,
+        this->grid_size,
+        static_cast<uint32_t>(this->grid_size * this->grid_size * Solver::mine_density),
+        ready_fields
+    );
 }
 
 
@@ -65,20 +87,43 @@ void Minesweeper::initialise()
  */
 void Minesweeper::on_load()
 {
-    Tile *tile;
+    //The board is kept between loads
+    if (this->object_exists("board")) {
+        Animation::on_load();
+        return;
+    }
+
+    //Runs on the thread pool, so it can wait for the first field
+    if (!this->playback.start(*this->solver)) {
+        Animation::on_load();
+        return;
+    }
+
     std::shared_ptr<Pipeline> pipeline = this->shader.lock();
     std::weak_ptr<VK::Context> graphics_context = this->context.lock()->get_graphics_context();
-    for (int i = 0; i < this->grid_size * this->grid_size; i++) {
-        tile = new Tile(graphics_context, Point(), Scale(1., 1., 1.));
-        tile->initialise(
-            pipeline,
-            0,
-            i, //position
-            this->grid_size  //Grid size
-        );
-
-        this->add_object("tile"+std::to_string(i), tile);
+
+    //Cell kinds are indices into texture_names
+    std::vector<TextureRegion> tile_types;
+    for (std::string const& texture_name : Minesweeper::texture_names) {
+        tile_types.push_back(pipeline->get_textures().lock()->get_region(texture_name));
     }
+    pipeline->set_tile_types(tile_types);
+
+    //One quad covering the board, the shader finds the cell under each pixel
+    std::shared_ptr<Quad> quad(new Quad(graphics_context, Point(), Scale(1., 1., 1.)));
+    quad->initialise(pipeline);
+
+    Animate::Object::Object *board = new Animate::Object::Object(
+        graphics_context,
+        Point(),
+        Scale(this->grid_size, this->grid_size, 1.)
+    );
+    board->add_component(quad);
+    board->set_model_matrix(Matrix::identity());
+
+    this->add_object("board", board);
+
+    this->redraw_field();
 
     Animation::on_load();
 }
@@ -90,103 +135,69 @@ void Minesweeper::on_tick(uint64_t time_delta)
 {
     Animation::on_tick(time_delta);
 
-    //Update all model matrices
-    for(auto const& object: this->objects) {
-        object.second->set_model_matrix(Matrix::identity());
+    //Not loaded yet
+    if (!this->object_exists("board")) {
+        return;
     }
 
-    this->time_since_move += time_delta;
+    this->playback.advance(time_delta, *this->solver);
 
-    if (this->time_since_move > 5000) {
-        if (this->move_sequence.empty()) {
-            this->reset_puzzle();
-        } else {
-            Casspir::Operation operation = this->move_sequence.front();
-            this->move_sequence.pop();
-
-            switch (operation.type) {
-                case Casspir::OperationType::FLIP:
-                    this->map->flip(operation.position);
-                    break;
-                case Casspir::OperationType::FLAG:
-                    this->map->flag(operation.position);
-                    break;
-            }
-
-            this->redraw_tiles();
-
-        }
-        this->time_since_move = 0;
+    if (this->playback.needs_full_redraw()) {
+        this->redraw_field();
+    } else {
+        this->redraw_cells(this->playback.get_changed());
     }
 }
 
 /**
- * Recreate the appropriate tiles in their new positions, ready to be solved.
+ * Which of texture_names a cell shows. Mines are only shown once the field is lost.
  */
-void Minesweeper::reset_puzzle()
+size_t Minesweeper::get_texture_index(TileState tile_state, MapStatus status)
 {
-    //Show the completed puzzle for a bit before resetting.
-    if (this->map && this->map->get_status() != Casspir::MapStatus::IN_PROGRESS) {
-        usleep(100000);
+    if (status == MapStatus::FAILED && tile_state.mine) {
+        if (tile_state.flagged) {
+            return 10;
+        }
+        return tile_state.flipped ? 12 : 13;
     }
 
-    //Generate new puzzle
-    Casspir::Point first_flip = Casspir::Point(
-        rand() % this->grid_size,
-        rand() % this->grid_size
-    );
-    this->map = std::make_shared<Casspir::Map>(
-        casspir_generate_map(
-            this->grid_size,
-            this->grid_size,
-            70,
-            first_flip
-        )
-    );
-    this->move_sequence = casspir_solve(*this->map);
-    this->map->reset();
-    this->map->flip(first_flip);
+    if (status == MapStatus::FAILED && tile_state.flagged) {
+        return 11;
+    }
 
-    this->redraw_tiles();
+    if (tile_state.flipped) {
+        return 1 + tile_state.value;
+    }
 
+    return tile_state.flagged ? 10 : 0;
 }
 
-void Minesweeper::redraw_tiles()
+/**
+ * Update the tile map for cells that changed.
+ */
+void Minesweeper::redraw_cells(std::vector<uint32_t> const& cells)
 {
-    //Lock resources so that no frames are drawn while we're updating.
-    std::lock_guard<std::mutex> guard(this->context.lock()->get_graphics_context().lock()->vulkan_resource_mutex);
+    std::shared_ptr<TileMap> tile_map = this->tile_map.lock();
+    Field const& field = this->playback.get_field();
+    MapStatus status = field.get_status();
 
-    std::shared_ptr<Pipeline> pipeline = this->shader.lock();
-    for (int i = 0; i < this->grid_size * this->grid_size; i++) {
-        std::weak_ptr<Tile> tile = std::static_pointer_cast<Tile>(this->get_object("tile"+std::to_string(i)).lock());
-        Casspir::TileState tile_state = this->map->get_tile(i);
-
-        std::string texture_name = "data/Minesweeper/unflipped.jpg";
-        if (this->map->get_status() == Casspir::MapStatus::FAILED) {
-            if (tile_state.mine) {
-                if (tile_state.flagged) {
-                    texture_name = "data/Minesweeper/flagged.jpg";
-                } else if (tile_state.flipped) {
-                    texture_name = "data/Minesweeper/mine-exploded.jpg";
-                } else {
-                    texture_name = "data/Minesweeper/mine-reveal.jpg";
-                }
-            } else {
-                if (tile_state.flagged) {
-                    texture_name = "data/Minesweeper/mine-false.jpg";
-                } else  if (tile_state.flipped) {
-                    texture_name = "data/Minesweeper/flipped-" + std::to_string(tile_state.value) + ".jpg";
-                }
-            }
-        } else {
-            if (tile_state.flipped) {
-                texture_name = "data/Minesweeper/flipped-" + std::to_string(tile_state.value) + ".jpg";
-            } else if (tile_state.flagged) {
-                texture_name = "data/Minesweeper/flagged.jpg";
-            }
+    for (uint32_t cell : cells) {
+        tile_map->set_cell(cell, Minesweeper::get_texture_index(field.get_tile(cell), status));
+    }
+}
 
-        }
+/**
+ * Update the tile map for every cell.
+ */
+void Minesweeper::redraw_field()
+{
+    Field const& field = this->playback.get_field();
+    MapStatus status = field.get_status();
 
-        tile.lock()->set_layer(pipeline->get_textures().lock()->get_layer(texture_name));
+    std::vector<uint32_t> tile_types(this->grid_size * this->grid_size);
+    for (uint32_t cell = 0; cell < tile_types.size(); cell++) {
+        tile_types[cell] = Minesweeper::get_texture_index(field.get_tile(cell), status);
     }
-}
\ No newline at end of file
+
+    this->tile_map.lock()->set_cells(tile_types);
+}
@@ -1,36 +1,49 @@
 #pragma once
 
-#include <queue>
-
-#include <casspir/casspir.hh>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "../Animation.hh"
 #include "../../VK/Pipeline.hh"
+#include "../../VK/TileMap.hh"
 #include "../../Geometry/Definitions.hh"
-#include "Object/Tile.hh"
+#include "Field.hh"
+#include "Solver.hh"
+#include "Playback.hh"
 
-using namespace Animate::Object;
 using namespace Animate::Geometry;
 
 namespace Animate::Animation::Minesweeper
 {
+    /**
+     * Solved minefields played back a move at a time. The whole field is one quad drawn from a
+     * tile map, so each move only changes the texels of the cells it uncovers.
+     */
     class Minesweeper : public Animation
     {
         public:
+            //Every cell image, see get_texture_index
+            static const std::vector<std::string> texture_names;
+
             Minesweeper(std::weak_ptr<AppContext> context);
 
+            static size_t get_texture_index(TileState tile_state, MapStatus status);
+
             void initialise() override;
             void on_load() override;
             void on_tick(uint64_t time_delta) override;
 
         protected:
             std::weak_ptr<VK::Pipeline> shader;
+            std::weak_ptr<VK::TileMap> tile_map;
             int grid_size = 10;
-            std::queue<Casspir::Operation> move_sequence;
-            std::shared_ptr<Casspir::Map> map;
-            uint64_t time_since_move = 0;
 
-            void reset_puzzle();
-            void redraw_tiles();
+            //Solves upcoming fields off the tick thread
+            std::unique_ptr<Solver> solver;
+            Playback playback;
+
+            void redraw_cells(std::vector<uint32_t> const& cells);
+            void redraw_field();
     };
 }
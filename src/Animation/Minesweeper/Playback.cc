@@ -0,0 +1,127 @@
+#include "Playback.hh"
+
+using namespace Animate::Animation::Minesweeper;
+
+/**
+ * Constructor.
+ *
+ * @param move_time     Microseconds between operations.
+ * @param finished_time Microseconds to show a finished field before the next.
+ */
+Playback::Playback(uint64_t move_time, uint64_t finished_time) :
+    move_time(move_time),
+    finished_time(finished_time)
+{
+}
+
+/**
+ * Show the first field, waiting for it to be solved. Blocks, so call it off the tick thread.
+ *
+ * @return False if the solver was cancelled first.
+ */
+bool Playback::start(Solver &solver)
+{
+    Puzzle puzzle;
+    if (!solver.take(puzzle)) {
+        return false;
+    }
+
+    this->start_puzzle(std::move(puzzle));
+    return true;
+}
+
+/**
+ * Apply every operation that's due, or move on to the next field once this one has been shown
+ * for long enough and the next is solved.
+ */
+void Playback::advance(uint64_t time_delta, Solver &solver)
+{
+    this->changed.clear();
+    this->started_field = false;
+    this->full_redraw = false;
+
+    this->time_in_state += time_delta;
+
+    if (this->state == State::FINISHED) {
+        //Keep showing the finished field until the next is solved
+        Puzzle puzzle;
+        if (this->time_in_state >= this->finished_time && solver.try_take(puzzle)) {
+            this->start_puzzle(std::move(puzzle));
+        }
+        return;
+    }
+
+    //Catch up, so a slow tick doesn't slow the playback
+    while (this->time_in_state >= this->move_time && !this->move_sequence.empty()) {
+        Operation operation = this->move_sequence.front();
+        this->move_sequence.pop();
+
+        this->changed.push_back(operation.position);
+        this->field.apply(operation, &this->changed);
+        this->last_position = operation.position;
+
+        this->time_in_state -= this->move_time;
+    }
+
+    //Losing reveals every mine
+    if (this->field.get_status() == MapStatus::FAILED) {
+        this->full_redraw = true;
+    }
+
+    if (this->move_sequence.empty()) {
+        this->state = State::FINISHED;
+        this->time_in_state = 0;
+    }
+}
+
+/**
+ * Show a solved field with its first cell flipped.
+ */
+void Playback::start_puzzle(Puzzle puzzle)
+{
+    this->field = std::move(puzzle.field);
+    this->move_sequence = std::move(puzzle.move_sequence);
+
+    if (!this->move_sequence.empty()) {
+        this->last_position = this->move_sequence.front().position;
+        this->field.apply(this->move_sequence.front());
+        this->move_sequence.pop();
+    }
+
+    this->state = State::PLAYING;
+    this->time_in_state = 0;
+
+    this->started_field = true;
+    this->full_redraw = true;
+}
+
+Field const& Playback::get_field() const
+{
+    return this->field;
+}
+
+/**
+ * Whether the last advance, or start, moved on to a new field.
+ */
+bool Playback::has_started_field() const
+{
+    return this->started_field;
+}
+
+bool Playback::needs_full_redraw() const
+{
+    return this->full_redraw;
+}
+
+/**
+ * Cells changed by the last advance, may list a cell more than once.
+ */
+std::vector<uint32_t> const& Playback::get_changed() const
+{
+    return this->changed;
+}
+
+uint32_t Playback::get_last_position() const
+{
+    return this->last_position;
+}
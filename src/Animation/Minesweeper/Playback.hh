@@ -0,0 +1,62 @@
+#pragma once
+
+#include <queue>
+#include <vector>
+#include <cstdint>
+
+#include "Field.hh"
+#include "Solver.hh"
+
+namespace Animate::Animation::Minesweeper
+{
+    /**
+     * Plays solved fields back an operation at a time, then shows each finished field for a
+     * while before taking the next from a solver.
+     *
+     * After each advance, needs_full_redraw says whether the whole field has to be redrawn, a
+     * new field or a lost one with its mines revealed. Otherwise get_changed lists the cells that
+     * changed and every other cell is as it was.
+     */
+    class Playback
+    {
+        /**
+         * What's being done with the current field.
+         */
+        enum class State {
+            PLAYING,  //Applying the solution's operations
+            FINISHED  //Showing the finished field until the next is due and ready
+        };
+
+        public:
+            Playback(uint64_t move_time, uint64_t finished_time);
+
+            bool start(Solver &solver);
+            void advance(uint64_t time_delta, Solver &solver);
+
+            Field const& get_field() const;
+            bool has_started_field() const;
+            bool needs_full_redraw() const;
+            std::vector<uint32_t> const& get_changed() const;
+            uint32_t get_last_position() const;
+
+        private:
+            //Microseconds between operations, and to show a finished field for
+            uint64_t move_time;
+            uint64_t finished_time;
+
+            Field field;
+            std::queue<Operation> move_sequence;
+            State state = State::FINISHED;
+            uint64_t time_in_state = 0;
+
+            //What the last advance changed
+            std::vector<uint32_t> changed;
+            bool started_field = false;
+            bool full_redraw = false;
+
+            //The cell of the latest operation
+            uint32_t last_position = 0;
+
+            void start_puzzle(Puzzle puzzle);
+    };
+}
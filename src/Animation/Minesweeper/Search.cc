@@ -0,0 +1,564 @@
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <unordered_map>
+
+#include "Search.hh"
+
+using namespace Animate::Animation::Minesweeper;
+
+//Larger frontier components are estimated rather than enumerated
+static const size_t max_enumerated_cells = 40;
+static const uint64_t max_enumerated_nodes = 200000;
+
+/**
+ * What a flipped cell says about its covered neighbours: exactly mines of them are mines.
+ */
+struct Constraint {
+    uint32_t cells[8];
+    int count;
+    int mines;
+};
+
+/**
+ * A field being played, and which of its numbers are worth looking at again.
+ */
+struct Game {
+    Field field;
+    std::mt19937 *generator;
+    std::queue<Operation> operations;
+
+    //Numbers that may now settle their neighbours on their own
+    std::vector<uint32_t> pending;
+    std::vector<bool> is_pending;
+
+    //Numbers that changed since they were last compared with those around them
+    std::vector<uint32_t> changed;
+    std::vector<bool> is_changed;
+
+    //Numbers that had covered neighbours when last seen
+    std::vector<uint32_t> boundary;
+};
+
+/**
+ * The covered, unflagged neighbours of a flipped cell and how many mines are left among them.
+ *
+ * @return False if the cell isn't flipped or has nothing left to say.
+ */
+static bool get_constraint(Field const& field, uint32_t position, Constraint &constraint)
+{
+    if (!field.is_flipped(position)) {
+        return false;
+    }
+
+    uint32_t neighbours[8];
+    int neighbour_count = field.get_neighbours(position, neighbours);
+
+    constraint.count = 0;
+    constraint.mines = field.get_value(position);
+    for (int i = 0; i < neighbour_count; i++) {
+        if (field.is_flagged(neighbours[i])) {
+            constraint.mines--;
+        } else if (!field.is_flipped(neighbours[i])) {
+            constraint.cells[constraint.count++] = neighbours[i];
+        }
+    }
+
+    return constraint.count > 0;
+}
+
+/**
+ * Queue a cell and the numbers around it to be looked at again.
+ */
+static void touch(Game &game, uint32_t position)
+{
+    uint32_t cells[9];
+    int count = game.field.get_neighbours(position, cells);
+    cells[count++] = position;
+
+    for (int i = 0; i < count; i++) {
+        uint32_t cell = cells[i];
+        if (!game.field.is_flipped(cell)) {
+            continue;
+        }
+
+        if (!game.is_pending[cell]) {
+            game.is_pending[cell] = true;
+            game.pending.push_back(cell);
+        }
+        if (!game.is_changed[cell]) {
+            game.is_changed[cell] = true;
+            game.changed.push_back(cell);
+        }
+    }
+}
+
+static void flip(Game &game, uint32_t position)
+{
+    //Nothing is played once the field is cleared or lost
+    if (game.field.get_status() != MapStatus::IN_PROGRESS) {
+        return;
+    }
+
+    if (game.field.is_flipped(position) || game.field.is_flagged(position)) {
+        return;
+    }
+
+    game.operations.push(Operation{OperationType::FLIP, position});
+
+    std::vector<uint32_t> flipped;
+    game.field.flip(position, &flipped);
+
+    for (uint32_t cell : flipped) {
+        touch(game, cell);
+        if (game.field.get_value(cell) > 0) {
+            game.boundary.push_back(cell);
+        }
+    }
+}
+
+static void flag(Game &game, uint32_t position)
+{
+    //Nothing is played once the field is cleared or lost
+    if (game.field.get_status() != MapStatus::IN_PROGRESS) {
+        return;
+    }
+
+    if (game.field.is_flipped(position) || game.field.is_flagged(position)) {
+        return;
+    }
+
+    game.operations.push(Operation{OperationType::FLAG, position});
+    game.field.flag(position);
+    touch(game, position);
+}
+
+/**
+ * Numbers whose covered neighbours are all mines or all safe.
+ *
+ * @return Whether anything was flipped or flagged.
+ */
+static bool deduce_single(Game &game)
+{
+    bool progress = false;
+
+    while (!game.pending.empty() && game.field.get_status() == MapStatus::IN_PROGRESS) {
+        uint32_t position = game.pending.back();
+        game.pending.pop_back();
+        game.is_pending[position] = false;
+
+        Constraint constraint;
+        if (!get_constraint(game.field, position, constraint)) {
+            continue;
+        }
+
+        if (constraint.mines == 0) {
+            for (int i = 0; i < constraint.count; i++) {
+                flip(game, constraint.cells[i]);
+            }
+            progress = true;
+        } else if (constraint.mines == constraint.count) {
+            for (int i = 0; i < constraint.count; i++) {
+                flag(game, constraint.cells[i]);
+            }
+            progress = true;
+        }
+    }
+
+    return progress;
+}
+
+/**
+ * If every cell of a is also in b, b's other cells hold the difference in their mines.
+ *
+ * @return Whether that settled b's other cells.
+ */
+static bool deduce_subset(Game &game, Constraint const& a, Constraint const& b)
+{
+    if (a.count >= b.count) {
+        return false;
+    }
+
+    uint32_t rest[8];
+    int rest_count = 0;
+    int shared = 0;
+    for (int i = 0; i < b.count; i++) {
+        if (std::find(a.cells, a.cells + a.count, b.cells[i]) != a.cells + a.count) {
+            shared++;
+        } else {
+            rest[rest_count++] = b.cells[i];
+        }
+    }
+
+    if (shared != a.count) {
+        return false;
+    }
+
+    int mines = b.mines - a.mines;
+    if (mines == 0) {
+        for (int i = 0; i < rest_count; i++) {
+            flip(game, rest[i]);
+        }
+        return true;
+    }
+
+    if (mines == rest_count) {
+        for (int i = 0; i < rest_count; i++) {
+            flag(game, rest[i]);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Compare changed numbers with the numbers near enough to share covered cells.
+ *
+ * @return Whether anything was flipped or flagged.
+ */
+static bool deduce_subsets(Game &game)
+{
+    Field const& field = game.field;
+    int width = static_cast<int>(field.get_width());
+    int height = static_cast<int>(field.get_height());
+
+    while (!game.changed.empty()) {
+        uint32_t position = game.changed.back();
+        game.changed.pop_back();
+        game.is_changed[position] = false;
+
+        Constraint a;
+        if (!get_constraint(field, position, a)) {
+            continue;
+        }
+
+        int x = position % width;
+        int y = position / width;
+        for (int dy = -2; dy <= 2; dy++) {
+            for (int dx = -2; dx <= 2; dx++) {
+                if ((dx == 0 && dy == 0) || x + dx < 0 || x + dx >= width || y + dy < 0 || y + dy >= height) {
+                    continue;
+                }
+
+                Constraint b;
+                if (!get_constraint(field, (y + dy) * width + x + dx, b)) {
+                    continue;
+                }
+
+                if (deduce_subset(game, a, b) || deduce_subset(game, b, a)) {
+                    //It may settle more against its other neighbours
+                    if (!game.is_changed[position]) {
+                        game.is_changed[position] = true;
+                        game.changed.push_back(position);
+                    }
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Every way a connected part of the frontier can hold mines, counted by how many mines each
+ * way uses.
+ */
+struct Enumeration {
+    size_t cells;
+    std::vector<Constraint> constraints;
+
+    //Constraint cells rewritten as indices into the component
+    std::vector< std::vector<int> > constraint_cells;
+    std::vector< std::vector<int> > cell_constraints;
+
+    std::vector<int> placed;
+    std::vector<int> uncovered;
+    std::vector<bool> mine;
+
+    //Indexed by mine count, and by cell then mine count
+    std::vector<double> solutions;
+    std::vector< std::vector<double> > cell_solutions;
+
+    uint64_t nodes = 0;
+};
+
+/**
+ * Place mines or not on cells from the given one on, counting every consistent placement.
+ *
+ * @return False if the node budget ran out.
+ */
+static bool enumerate(Enumeration &enumeration, size_t cell, int mines)
+{
+    if (++enumeration.nodes > max_enumerated_nodes) {
+        return false;
+    }
+
+    if (cell == enumeration.cells) {
+        enumeration.solutions[mines]++;
+        for (size_t i = 0; i < enumeration.cells; i++) {
+            if (enumeration.mine[i]) {
+                enumeration.cell_solutions[i][mines]++;
+            }
+        }
+        return true;
+    }
+
+    for (int value = 0; value <= 1; value++) {
+        bool consistent = true;
+        for (int constraint : enumeration.cell_constraints[cell]) {
+            enumeration.placed[constraint] += value;
+            enumeration.uncovered[constraint]--;
+
+            int target = enumeration.constraints[constraint].mines;
+            if (enumeration.placed[constraint] > target ||
+                enumeration.placed[constraint] + enumeration.uncovered[constraint] < target) {
+                consistent = false;
+            }
+        }
+
+        enumeration.mine[cell] = value == 1;
+        bool finished = !consistent || enumerate(enumeration, cell + 1, mines + value);
+
+        for (int constraint : enumeration.cell_constraints[cell]) {
+            enumeration.placed[constraint] -= value;
+            enumeration.uncovered[constraint]++;
+        }
+
+        if (!finished) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static uint32_t find_root(std::vector<uint32_t> &parents, uint32_t i)
+{
+    while (parents[i] != i) {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+/**
+ * Work out how likely each frontier cell is to be a mine, acting on any that are certain and
+ * otherwise flipping the safest looking cell. Components of the frontier small enough are
+ * enumerated exactly, each placement weighted by how likely its mine count is given the mines
+ * left, the rest fall back to the worst of their numbers' local odds.
+ *
+ * @return Whether anything was flipped or flagged.
+ */
+static bool guess(Game &game)
+{
+    Field const& field = game.field;
+    uint32_t cells = field.get_width() * field.get_height();
+
+    std::vector<Constraint> constraints;
+    std::vector<uint32_t> boundary;
+    for (uint32_t position : game.boundary) {
+        Constraint constraint;
+        if (get_constraint(field, position, constraint)) {
+            constraints.push_back(constraint);
+            boundary.push_back(position);
+        }
+    }
+    game.boundary.swap(boundary);
+
+    //Give each frontier cell an index, and join cells sharing a number into components
+    std::vector<uint32_t> frontier;
+    std::unordered_map<uint32_t, uint32_t> frontier_index;
+    for (Constraint const& constraint : constraints) {
+        for (int i = 0; i < constraint.count; i++) {
+            if (frontier_index.emplace(constraint.cells[i], frontier.size()).second) {
+                frontier.push_back(constraint.cells[i]);
+            }
+        }
+    }
+
+    std::vector<uint32_t> parents(frontier.size());
+    std::iota(parents.begin(), parents.end(), 0);
+    for (Constraint const& constraint : constraints) {
+        uint32_t root = find_root(parents, frontier_index[constraint.cells[0]]);
+        for (int i = 1; i < constraint.count; i++) {
+            parents[find_root(parents, frontier_index[constraint.cells[i]])] = root;
+        }
+    }
+
+    std::unordered_map< uint32_t, std::vector<size_t> > components;
+    for (size_t i = 0; i < constraints.size(); i++) {
+        components[find_root(parents, frontier_index[constraints[i].cells[0]])].push_back(i);
+    }
+
+    size_t covered = cells - field.get_flipped().count() - field.get_flagged().count();
+    double mines_left = static_cast<double>(field.get_mine_count()) - field.get_flagged().count();
+    double density = std::min(.999, std::max(.001, mines_left / std::max<size_t>(covered, 1)));
+
+    //The chance of each frontier cell being a mine, and whether that's exact
+    std::vector<double> probabilities(frontier.size(), 0.);
+    std::vector<bool> exact(frontier.size(), false);
+
+    for (auto const& component : components) {
+        Enumeration enumeration;
+        std::unordered_map<uint32_t, int> local_index;
+        std::vector<uint32_t> local_cells;
+
+        //Cells in the order their numbers reach them, so placements are checked early
+        for (size_t constraint : component.second) {
+            Constraint const& c = constraints[constraint];
+            std::vector<int> indices;
+            for (int i = 0; i < c.count; i++) {
+                auto inserted = local_index.emplace(c.cells[i], static_cast<int>(local_cells.size()));
+                if (inserted.second) {
+                    local_cells.push_back(c.cells[i]);
+                }
+                indices.push_back(inserted.first->second);
+            }
+            enumeration.constraints.push_back(c);
+            enumeration.constraint_cells.push_back(indices);
+        }
+
+        enumeration.cells = local_cells.size();
+        bool enumerated = false;
+
+        if (enumeration.cells <= max_enumerated_cells) {
+            enumeration.cell_constraints.resize(enumeration.cells);
+            for (size_t constraint = 0; constraint < enumeration.constraint_cells.size(); constraint++) {
+                for (int cell : enumeration.constraint_cells[constraint]) {
+                    enumeration.cell_constraints[cell].push_back(static_cast<int>(constraint));
+                }
+                enumeration.uncovered.push_back(static_cast<int>(enumeration.constraint_cells[constraint].size()));
+            }
+            enumeration.placed.assign(enumeration.constraints.size(), 0);
+            enumeration.mine.assign(enumeration.cells, false);
+            enumeration.solutions.assign(enumeration.cells + 1, 0.);
+            enumeration.cell_solutions.assign(enumeration.cells, std::vector<double>(enumeration.cells + 1, 0.));
+
+            enumerated = enumerate(enumeration, 0, 0);
+        }
+
+        if (enumerated) {
+            //Placements using more mines are less likely, by about the density for each
+            std::vector<double> weights(enumeration.cells + 1);
+            double total = 0.;
+            for (size_t mines = 0; mines <= enumeration.cells; mines++) {
+                weights[mines] = std::pow(density / (1. - density), static_cast<double>(mines));
+                total += weights[mines] * enumeration.solutions[mines];
+            }
+
+            for (size_t cell = 0; cell < enumeration.cells; cell++) {
+                double weighted = 0.;
+                bool ever = false;
+                bool always = true;
+                for (size_t mines = 0; mines <= enumeration.cells; mines++) {
+                    weighted += weights[mines] * enumeration.cell_solutions[cell][mines];
+                    ever = ever || enumeration.cell_solutions[cell][mines] > 0.;
+                    always = always && enumeration.cell_solutions[cell][mines] == enumeration.solutions[mines];
+                }
+
+                uint32_t index = frontier_index[local_cells[cell]];
+                probabilities[index] = total > 0. ? weighted / total : density;
+                if (!ever) {
+                    probabilities[index] = 0.;
+                    exact[index] = true;
+                } else if (always) {
+                    probabilities[index] = 1.;
+                    exact[index] = true;
+                }
+            }
+            continue;
+        }
+
+        for (Constraint const& c : enumeration.constraints) {
+            double local = static_cast<double>(c.mines) / c.count;
+            for (int i = 0; i < c.count; i++) {
+                double &probability = probabilities[frontier_index[c.cells[i]]];
+                probability = std::max(probability, local);
+            }
+        }
+    }
+
+    //Certainties first
+    bool progress = false;
+    for (size_t i = 0; i < frontier.size() && field.get_status() == MapStatus::IN_PROGRESS; i++) {
+        if (exact[i] && probabilities[i] == 0.) {
+            flip(game, frontier[i]);
+            progress = true;
+        }
+    }
+    for (size_t i = 0; i < frontier.size() && field.get_status() == MapStatus::IN_PROGRESS; i++) {
+        if (exact[i] && probabilities[i] == 1.) {
+            flag(game, frontier[i]);
+            progress = true;
+        }
+    }
+    if (progress) {
+        return true;
+    }
+
+    //Otherwise the safest cell, which may be one nowhere near a number
+    Bitboard interior(field.get_width(), field.get_height());
+    interior.fill();
+    interior.remove(field.get_flipped().dilate());
+    interior.remove(field.get_flagged());
+    size_t interior_count = interior.count();
+
+    double frontier_mines = std::accumulate(probabilities.begin(), probabilities.end(), 0.);
+    double interior_probability = interior_count > 0 ?
+        std::min(1., std::max(0., (mines_left - frontier_mines) / interior_count)) :
+        1.;
+
+    auto best = std::min_element(probabilities.begin(), probabilities.end());
+    if (interior_count > 0 && (best == probabilities.end() || interior_probability < *best)) {
+        std::uniform_int_distribution<size_t> distribution(0, interior_count - 1);
+        flip(game, interior.nth(distribution(*game.generator)));
+        return true;
+    }
+
+    if (best == probabilities.end()) {
+        return false;
+    }
+
+    flip(game, frontier[best - probabilities.begin()]);
+    return true;
+}
+
+/**
+ * Play a field from its first flip until it's cleared or a guess hits a mine.
+ * Numbers are first settled on their own, then against the numbers around them, and only then
+ * is the frontier enumerated for odds.
+ *
+ * @param field         The field, with nothing flipped.
+ * @param first_flip    The cell to start from.
+ * @param generator     Picks between equally safe guesses.
+ * @param move_sequence Where every flip and flag is written, in order.
+ *
+ * @return How the game ended.
+ */
+MapStatus Search::solve(Field field, uint32_t first_flip, std::mt19937 &generator, std::queue<Operation> &move_sequence)
+{
+    uint32_t cells = field.get_width() * field.get_height();
+
+    Game game;
+    game.field = std::move(field);
+    game.generator = &generator;
+    game.is_pending.assign(cells, false);
+    game.is_changed.assign(cells, false);
+
+    flip(game, first_flip);
+
+    while (game.field.get_status() == MapStatus::IN_PROGRESS) {
+        if (deduce_single(game) || deduce_subsets(game)) {
+            continue;
+        }
+
+        if (!guess(game)) {
+            break;
+        }
+    }
+
+    move_sequence = std::move(game.operations);
+    return game.field.get_status();
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <queue>
+#include <random>
+
+#include "Field.hh"
+
+namespace Animate::Animation::Minesweeper
+{
+    /**
+     * Plays minefields the way a person would, seeing only the numbers uncovered so far.
+     */
+    namespace Search
+    {
+        MapStatus solve(Field field, uint32_t first_flip, std::mt19937 &generator, std::queue<Operation> &move_sequence);
+    }
+}
@@ -0,0 +1,84 @@
+#include <random>
+
+#include "Solver.hh"
+#include "Search.hh"
+#include "../../Utilities.hh"
+
+using namespace Animate;
+using namespace Animate::Animation::Minesweeper;
+
+/**
+ * Constructor.
+ * Starts solving straight away.
+ *
+ * @param width      Width of the fields in cells.
+ * @param height     Height of the fields in cells.
+ * @param mine_count Mines in each field.
+ * @param capacity   How many solved fields to keep ready.
+ */
+Solver::Solver(uint32_t width, uint32_t height, uint32_t mine_count, size_t capacity) :
+    width(width),
+    height(height),
+    mine_count(mine_count),
+    generator(std::random_device{}()),
+    solve_times("Minesweeper", "cleared"),
+    puzzles(capacity, [this](std::atomic_bool const& cancelled) {
+        return this->solve(cancelled);
+    })
+{
+}
+
+/**
+ * Destructor.
+ * Stops once the field being solved is done.
+ */
+Solver::~Solver()
+{
+    this->cancel();
+}
+
+/**
+ * Take a solved field if one is ready, without waiting.
+ */
+bool Solver::try_take(Puzzle &puzzle)
+{
+    return this->puzzles.try_take(puzzle);
+}
+
+/**
+ * Take a solved field, waiting for one.
+ *
+ * @return False if cancelled before one was ready.
+ */
+bool Solver::take(Puzzle &puzzle)
+{
+    return this->puzzles.take(puzzle);
+}
+
+/**
+ * Stop solving.
+ */
+void Solver::cancel()
+{
+    this->puzzles.cancel();
+}
+
+/**
+ * Generate a field around a random first flip and play it.
+ * Fields are quick enough to solve that cancelling doesn't interrupt one.
+ */
+Puzzle Solver::solve(std::atomic_bool const&)
+{
+    uint64_t start_time = Utilities::get_micro_time();
+
+    std::uniform_int_distribution<uint32_t> distribution(0, this->width * this->height - 1);
+    uint32_t first_flip = distribution(this->generator);
+
+    Puzzle puzzle;
+    puzzle.field = Field::generate(this->width, this->height, this->mine_count, first_flip, this->generator);
+    MapStatus status = Search::solve(puzzle.field, first_flip, this->generator, puzzle.move_sequence);
+
+    this->solve_times.record((Utilities::get_micro_time() - start_time) / 1000, status == MapStatus::COMPLETE);
+
+    return puzzle;
+}
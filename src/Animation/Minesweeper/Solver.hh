@@ -0,0 +1,53 @@
+#pragma once
+
+#include <queue>
+#include <random>
+#include <atomic>
+
+#include "../../Tasks/BackgroundSolver.hh"
+#include "../../Tasks/SolveTimes.hh"
+#include "Field.hh"
+
+namespace Animate::Animation::Minesweeper
+{
+    /**
+     * A minefield with nothing flipped and the operations that play it.
+     */
+    struct Puzzle {
+        Field field;
+        std::queue<Operation> move_sequence;
+    };
+
+    /**
+     * Generates and solves minefields on its own thread, keeping a few ready so the tick thread
+     * never waits on one. See Search.hh.
+     */
+    class Solver
+    {
+        public:
+            //Fraction of cells that are mines
+            static constexpr float mine_density = .16f;
+
+            Solver(uint32_t width, uint32_t height, uint32_t mine_count, size_t capacity = 2);
+            ~Solver();
+
+            bool try_take(Puzzle &puzzle);
+            bool take(Puzzle &puzzle);
+            void cancel();
+
+        private:
+            uint32_t width;
+            uint32_t height;
+            uint32_t mine_count;
+
+            //Only used on the worker thread
+            std::mt19937 generator;
+
+            Tasks::SolveTimes solve_times;
+
+            //Last, so its worker stops before anything it solves with is destroyed
+            Tasks::BackgroundSolver<Puzzle> puzzles;
+
+            Puzzle solve(std::atomic_bool const& cancelled);
+    };
+}
@@ -35,7 +35,7 @@ void Modulo::initialise()
     std::weak_ptr<VK::Context> graphics_context = this->context.lock()->get_graphics_context();
 
     //Set shaders
-    this->shader = this->context.lock()->get_graphics_context().lock()->create_pipeline("data/Modulo/shader.frag.spv", "data/Modulo/shader.vert.spv");
+    this->shader = this->create_pipeline("data/Modulo/shader.frag.spv", "data/Modulo/shader.vert.spv");
 
     //Look at
     Matrix view_matrix = Matrix::look_at(
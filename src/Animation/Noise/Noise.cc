@@ -20,9 +20,22 @@ using namespace Animate::Object;
  * Constructor.
  * Seed the RNG.
  */
-Noise::Noise(std::weak_ptr<AppContext> context) : Animation::Animation(context)
+Noise::Noise(std::weak_ptr<AppContext> context, NoiseMode mode) : Animation::Animation(context), mode(mode)
 {
     srand(time(NULL));
+    this->set_seed(time(NULL));
+}
+
+/**
+ * Restart the compute generator's sequence from the given seed.
+ *
+ * @param seed The seed, the same seed always produces the same frames.
+ */
+void Noise::set_seed(uint64_t seed)
+{
+    this->state.seed[0] = static_cast<uint32_t>(seed);
+    this->state.seed[1] = static_cast<uint32_t>(seed >> 32);
+    this->state.counter = 0;
 }
 
 /**
@@ -32,11 +45,31 @@ void Noise::initialise()
 {
     std::weak_ptr<VK::Context> graphics_context = this->context.lock()->get_graphics_context();
 
-    //Set shaders
-    this->shader = this->context.lock()->get_graphics_context().lock()->create_pipeline(
-        "data/Noise/shader.frag.spv",
-        "data/Noise/shader.vert.spv"
-    );
+    //Set shaders, a full screen quad gains nothing from multisampling
+    if (this->mode == COMPUTE) {
+        this->shader = this->create_pipeline(
+            "data/Noise/compute.frag.spv",
+            "data/Noise/shader.vert.spv",
+            {},
+            sizeof(float),
+            VK::RenderSettings::single_sampled()
+        );
+
+        this->generator = graphics_context.lock()->create_compute_pipeline(
+            "data/Noise/compute.comp.spv",
+            sizeof(NoiseState)
+        );
+
+        this->shader.lock()->set_compute_pipeline(this->generator);
+    } else {
+        this->shader = this->create_pipeline(
+            "data/Noise/shader.frag.spv",
+            "data/Noise/shader.vert.spv",
+            {},
+            sizeof(float),
+            VK::RenderSettings::single_sampled()
+        );
+    }
 
     //Look at
     Matrix view_matrix = Matrix::look_at(
@@ -64,7 +97,13 @@ void Noise::initialise()
  */
 void Noise::on_tick(uint64_t time_delta)
 {
-    this->shader.lock()->set_uniform_float(static_cast <float> (rand()) / static_cast <float> (RAND_MAX));
+    if (this->mode == COMPUTE) {
+        //Advance the counter, the generator is stateless given the seed and counter
+        this->state.counter++;
+        this->generator.lock()->set_push_constants(&this->state, sizeof(NoiseState));
+    } else {
+        this->shader.lock()->set_uniform_float(static_cast <float> (rand()) / static_cast <float> (RAND_MAX));
+    }
 
     //Draw every object
     for(auto const& object: this->objects) {
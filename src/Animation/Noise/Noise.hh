@@ -3,6 +3,7 @@
 #include "../Animation.hh"
 #include "../../VK/Quad.hh"
 #include "../../VK/Pipeline.hh"
+#include "../../VK/ComputePipeline.hh"
 #include "../../Geometry/Definitions.hh"
 #include "../../Object/Object.hh"
 
@@ -11,15 +12,33 @@ using namespace Animate::Geometry;
 
 namespace Animate::Animation::Noise
 {
+    enum NoiseMode {
+        FRAGMENT,   //Hash computed per fragment from a random float
+        COMPUTE     //Philox generated once per frame in a compute shader
+    };
+
+    /**
+     * Layout of the compute shader's push constant block.
+     */
+    struct NoiseState {
+        uint32_t seed[2];
+        uint32_t counter;
+    };
+
     class Noise : public Animation
     {
         public:
-            Noise(std::weak_ptr<AppContext> context);
+            Noise(std::weak_ptr<AppContext> context, NoiseMode mode = COMPUTE);
 
             void initialise();
             void on_tick(uint64_t time_delta);
 
+            void set_seed(uint64_t seed);
+
         protected:
+            NoiseMode mode;
+            NoiseState state;
             std::weak_ptr<VK::Pipeline> shader;
+            std::weak_ptr<VK::ComputePipeline> generator;
     };
 }
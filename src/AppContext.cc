@@ -1,15 +1,28 @@
 #include <cstdlib>
+#include <iostream>
 
 #include "AppContext.hh"
+#include "Utilities.hh"
 #include "Animation/Animation.hh"
 #include "Animation/Cat/Cat.hh"
+#include "Animation/Cat/LargeCat.hh"
 #include "Animation/Modulo/Modulo.hh"
 #include "Animation/Noise/Noise.hh"
 #include "Animation/Minesweeper/Minesweeper.hh"
+#include "Animation/Minesweeper/LargeMinesweeper.hh"
 #include "Animation/Fractal/Fractal.hh"
 
 using namespace Animate;
 
+/**
+ * Constructor.
+ * Startup timing is measured from here.
+ */
+AppContext::AppContext() : thread_pool(new Tasks::ThreadPool())
+{
+    this->start_time = Utilities::get_micro_time();
+}
+
 /**
 * Set the window.
 *
@@ -76,35 +89,106 @@ std::weak_ptr<VK::Context> const AppContext::get_graphics_context()
     return this->graphics_context;
 }
 
+/**
+ * Retrieves the shared worker threads.
+ */
+std::weak_ptr<Tasks::ThreadPool> const AppContext::get_thread_pool()
+{
+    return this->thread_pool;
+}
+
+/**
+ * Create every animation and initialise them concurrently.
+ * Returns as soon as the noise animation can be shown, the rest load in the background.
+ */
 void AppContext::setup_animations() {
     std::shared_ptr<AppContext> self = this->shared_from_this();
 
-    //Create animation and connect it up
     this->noise_animation.reset(new Animation::Noise::Noise(self));
-    this->noise_animation->initialise();
 
-    Animation::Animation *animation = new Animation::Cat::Cat(self);
-    animation->initialise();
+    std::vector< std::pair<std::string, std::shared_ptr<Animation::Animation> > > named_animations = {
+        {"cat", std::make_shared<Animation::Cat::Cat>(self)},
+        {"cat-large", std::make_shared<Animation::Cat::LargeCat>(self)},
+        {"modulo", std::make_shared<Animation::Modulo::Modulo>(self)},
+        {"minesweeper", std::make_shared<Animation::Minesweeper::Minesweeper>(self)},
+        {"minesweeper-large", std::make_shared<Animation::Minesweeper::LargeMinesweeper>(self)},
+        {"fractal", std::make_shared<Animation::Fractal::Fractal>(self)}
+    };
+
+    //Shown while everything else initialises
+    this->startup_tasks.add("noise", {}, [this]() {
+        this->noise_animation->initialise();
+    });
+
+    std::vector<std::string> animation_tasks = {"noise"};
+    for (auto const& named_animation : named_animations) {
+        std::shared_ptr<Animation::Animation> animation = named_animation.second;
+
+        this->animations.push_back(animation);
+        this->startup_tasks.add(named_animation.first, {}, [this, animation]() {
+            this->initialise_animation(animation);
+        });
+
+        animation_tasks.push_back(named_animation.first);
+    }
 
-    this->animations.push_back(std::shared_ptr<Animation::Animation>(animation));
+    this->startup_tasks.add("ready", animation_tasks, [this]() {
+        std::cout << "All animations initialised: " << (Utilities::get_micro_time() - this->start_time) / 1000. << "ms" << std::endl;
+    });
 
-    animation = new Animation::Modulo::Modulo(self);
-    animation->initialise();
+    {
+        std::lock_guard<std::mutex> guard(this->animation_mutex);
+        this->current_animation = this->animations.begin();
+    }
 
-    this->animations.push_back(std::shared_ptr<Animation::Animation>(animation));
+    this->startup_tasks.run(*this->thread_pool);
+    this->next_animation();
 
-    animation = new Animation::Minesweeper::Minesweeper(self);
+    this->startup_tasks.wait("noise");
+}
+
+/**
+ * Initialise an animation on a worker thread.
+ * If it became the current or next animation while initialising, it's prepared now.
+ */
+void AppContext::initialise_animation(std::shared_ptr<Animation::Animation> animation)
+{
     animation->initialise();
 
-    this->animations.push_back(std::shared_ptr<Animation::Animation>(animation));
+    std::lock_guard<std::mutex> guard(this->animation_mutex);
+    this->initialised_animations.insert(animation.get());
 
-    animation = new Animation::Fractal::Fractal(self);
-    animation->initialise();
+    if (*this->current_animation == animation) {
+        animation->prepare(*this->thread_pool);
+    }
 
-    this->animations.push_back(std::shared_ptr<Animation::Animation>(animation));
+    this->prepare_next_animation();
+}
 
-    this->current_animation = this->animations.begin();
-    this->next_animation();
+/**
+ * Rethrow any failure from the startup tasks on the calling thread.
+ */
+void AppContext::check_startup_tasks()
+{
+    this->startup_tasks.rethrow_failure();
+}
+
+/**
+ * Block until every startup task has finished, they hold references to this context.
+ */
+void AppContext::wait_for_startup_tasks()
+{
+    this->startup_tasks.wait_all();
+}
+
+/**
+ * Print the time from startup to the first presented frame, once.
+ */
+void AppContext::report_first_frame()
+{
+    if (!this->first_frame_reported.exchange(true)) {
+        std::cout << "Time to first frame: " << (Utilities::get_micro_time() - this->start_time) / 1000. << "ms" << std::endl;
+    }
 }
 
 size_t AppContext::get_animation_count()
@@ -114,6 +198,8 @@ size_t AppContext::get_animation_count()
 
 std::weak_ptr<Animation::Animation> AppContext::get_current_animation()
 {
+    std::lock_guard<std::mutex> guard(this->animation_mutex);
+
     if ((*this->current_animation)->check_loaded()) {
         return *this->current_animation;
     } else {
@@ -123,6 +209,8 @@ std::weak_ptr<Animation::Animation> AppContext::get_current_animation()
 
 void AppContext::next_animation()
 {
+    std::lock_guard<std::mutex> guard(this->animation_mutex);
+
     (*this->current_animation)->unload();
 
     this->current_animation++;
@@ -131,5 +219,29 @@ void AppContext::next_animation()
         this->current_animation = this->animations.begin();
     }
 
-    (*this->current_animation)->load();
+    //Usually already prepared while the last one played.
+    //Animations still initialising are prepared by their startup task once ready
+    if (this->initialised_animations.count(this->current_animation->get()) > 0) {
+        (*this->current_animation)->prepare(*this->thread_pool);
+    }
+
+    this->prepare_next_animation();
+}
+
+/**
+ * Prepare the animation after the current one in the background so switching to it doesn't wait.
+ * Called with the animation mutex held.
+ */
+void AppContext::prepare_next_animation()
+{
+    auto next = this->current_animation + 1;
+    if (next == this->animations.end()) {
+        next = this->animations.begin();
+    }
+
+    if (next == this->current_animation || this->initialised_animations.count(next->get()) == 0) {
+        return;
+    }
+
+    (*next)->prepare(*this->thread_pool);
 }
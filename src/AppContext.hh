@@ -5,9 +5,13 @@
 #include <GLFW/glfw3.h>
 #include <memory>
 #include <atomic>
+#include <mutex>
+#include <set>
 
 #include "VK/Textures.hh"
 #include "VK/Context.hh"
+#include "Tasks/ThreadPool.hh"
+#include "Tasks/TaskGraph.hh"
 
 namespace Animate
 {
@@ -19,16 +23,22 @@ namespace Animate
     class AppContext : public std::enable_shared_from_this<AppContext>
     {
         public:
+            AppContext();
+
             std::atomic_bool should_close = false;
 
             void set_window(GLFWwindow *window);
             void set_graphics_context(std::shared_ptr<VK::Context> graphics_context);
             void set_surface(vk::SurfaceKHR *surface);
             void setup_animations();
+            void check_startup_tasks();
+            void wait_for_startup_tasks();
+            void report_first_frame();
 
             GLFWwindow *get_window();
             std::weak_ptr<vk::SurfaceKHR> const get_surface();
             std::weak_ptr<VK::Context> const get_graphics_context();
+            std::weak_ptr<Tasks::ThreadPool> const get_thread_pool();
 
             size_t get_animation_count();
             std::weak_ptr<Animation::Animation> get_current_animation();
@@ -43,5 +53,20 @@ namespace Animate
             std::vector< std::shared_ptr<Animation::Animation> >::iterator current_animation;
 
             std::vector< std::shared_ptr<Animation::Animation> > animations;
+
+            uint64_t start_time;
+            std::atomic_bool first_frame_reported = false;
+
+            //Guards the current animation and which animations are ready to load
+            std::mutex animation_mutex;
+            std::set<Animation::Animation*> initialised_animations;
+
+            Tasks::TaskGraph startup_tasks;
+
+            //Declared last so queued tasks finish before anything they use is destroyed
+            std::shared_ptr<Tasks::ThreadPool> thread_pool;
+
+            void initialise_animation(std::shared_ptr<Animation::Animation> animation);
+            void prepare_next_animation();
     };
 }
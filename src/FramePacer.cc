@@ -0,0 +1,180 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "FramePacer.hh"
+#include "Utilities.hh"
+
+using namespace Animate;
+
+//Microseconds a tick should finish before the frame showing it reads the scene
+static const uint64_t tick_margin = 1000;
+
+//Microseconds early frames start when the display sets the pace, so they don't miss a refresh
+static const uint64_t vsync_margin = 2000;
+
+/**
+ * Constructor.
+ *
+ * @param frame_rate Frames per second to aim for. Under vsync the display may be slower.
+ */
+FramePacer::FramePacer(double frame_rate)
+{
+    this->set_frame_rate(frame_rate);
+}
+
+void FramePacer::set_frame_rate(double frame_rate)
+{
+    if (frame_rate <= 0.) {
+        throw std::runtime_error("Invalid frame rate given.");
+    }
+
+    std::lock_guard<std::mutex> guard(this->mutex);
+    this->frame_interval = static_cast<uint64_t>(1000000. / frame_rate);
+}
+
+/**
+ * Sleep until the next frame is due to read the scene.
+ * Called by the render loop before each frame.
+ */
+void FramePacer::wait_for_frame()
+{
+    uint64_t frame_time;
+    {
+        std::lock_guard<std::mutex> guard(this->mutex);
+        frame_time = this->next_frame_time;
+    }
+
+    uint64_t now = Utilities::get_micro_time();
+    if (frame_time > now) {
+        usleep(frame_time - now);
+    }
+}
+
+/**
+ * Measure the interval since the last present and schedule the next frame.
+ * Called by the render loop after each present.
+ *
+ * @param vsync Whether presents wait for the display, as with FIFO.
+ */
+void FramePacer::on_present(bool vsync)
+{
+    uint64_t now = Utilities::get_micro_time();
+
+    {
+        std::lock_guard<std::mutex> guard(this->mutex);
+
+        if (this->last_present_time > 0) {
+            uint64_t interval = now - this->last_present_time;
+            this->present_intervals.push_back(interval);
+            this->measured_interval = this->measured_interval > 0. ?
+                .9 * this->measured_interval + .1 * interval :
+                interval;
+        }
+        this->last_present_time = now;
+        this->frame_count++;
+
+        if (vsync) {
+            //Presents return at the display's pace, the next frame starts a little before its refresh
+            double period = std::max<double>(this->frame_interval, this->measured_interval);
+            this->next_frame_time = now + static_cast<uint64_t>(period - std::min<double>(vsync_margin, period / 2.));
+        } else {
+            //Keep to the target rate, without rushing to make up frames that ran long
+            this->next_frame_time = std::max(this->next_frame_time + this->frame_interval, now);
+        }
+
+        this->report(now);
+    }
+
+    this->frame_presented.notify_all();
+}
+
+/**
+ * Sleep until the next tick should start: after the frame showing the last tick is presented,
+ * just long enough before the next frame reads the scene for the tick to finish.
+ * While nothing is presented, before the first frame for example, ticks run at half the frame rate.
+ *
+ * @return When the tick started.
+ */
+uint64_t FramePacer::wait_for_tick()
+{
+    uint64_t tick_start;
+    uint64_t longest_sleep;
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+
+        longest_sleep = 2 * this->frame_interval;
+        bool presented = this->frame_presented.wait_for(lock, std::chrono::microseconds(longest_sleep), [this] {
+            return this->frame_count != this->ticked_frame;
+        });
+
+        this->ticked_frame = this->frame_count;
+        this->tick_deadline = presented ? this->next_frame_time : 0;
+
+        uint64_t lead = static_cast<uint64_t>(this->tick_estimate) + tick_margin;
+        tick_start = this->tick_deadline > lead ? this->tick_deadline - lead : 0;
+    }
+
+    uint64_t now = Utilities::get_micro_time();
+    if (tick_start > now) {
+        usleep(std::min(tick_start - now, longest_sleep));
+    }
+
+    return Utilities::get_micro_time();
+}
+
+/**
+ * Learn how long ticks take.
+ * Called by the tick loop once the tick's scene is committed.
+ *
+ * @param tick_time When the tick started, as returned by wait_for_tick.
+ */
+void FramePacer::on_tick_finished(uint64_t tick_time)
+{
+    uint64_t now = Utilities::get_micro_time();
+    double duration = static_cast<double>(now - tick_time);
+
+    std::lock_guard<std::mutex> guard(this->mutex);
+
+    this->tick_estimate = std::max(duration, .95 * this->tick_estimate + .05 * duration);
+
+    //Committed after its frame read the scene, so that frame repeats the last tick
+    if (this->tick_deadline > 0 && now > this->tick_deadline) {
+        this->late_ticks++;
+    }
+}
+
+/**
+ * Print present intervals and late ticks every second.
+ */
+void FramePacer::report(uint64_t now)
+{
+    if (this->last_report_time == 0) {
+        this->last_report_time = now;
+        return;
+    }
+
+    if (now - this->last_report_time < 1000000 || this->present_intervals.empty()) {
+        return;
+    }
+
+    std::vector<uint64_t> &intervals = this->present_intervals;
+    std::sort(intervals.begin(), intervals.end());
+
+    double seconds = (now - this->last_report_time) / 1000000.;
+    std::cout << std::fixed << std::setprecision(1)
+              << "Frame time: " << seconds * 1000000. / intervals.size()
+              << " FPS: " << intervals.size() / seconds
+              << " Present interval median: " << intervals[intervals.size() / 2] / 1000. << "ms"
+              << " 99th: " << intervals[intervals.size() * 99 / 100] / 1000. << "ms"
+              << " max: " << intervals.back() / 1000. << "ms"
+              << " Late ticks: " << this->late_ticks
+              << std::defaultfloat << std::endl;
+
+    intervals.clear();
+    this->late_ticks = 0;
+    this->last_report_time = now;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+namespace Animate
+{
+    /**
+     * Keeps the render and tick loops in step.
+     * The render loop waits for each frame's slot and reports when it's presented, the tick loop
+     * is woken once per frame just late enough to finish before that frame reads the scene.
+     * Each frame then shows exactly one tick, as recent as possible.
+     */
+    class FramePacer
+    {
+        public:
+            FramePacer(double frame_rate = 60.);
+
+            void set_frame_rate(double frame_rate);
+
+            void wait_for_frame();
+            void on_present(bool vsync);
+
+            uint64_t wait_for_tick();
+            void on_tick_finished(uint64_t tick_time);
+
+        private:
+            std::mutex mutex;
+            std::condition_variable frame_presented;
+
+            //Microseconds between frames, when the display isn't setting the pace
+            uint64_t frame_interval;
+
+            //When the next frame reads the scene
+            uint64_t next_frame_time = 0;
+            uint64_t last_present_time = 0;
+            double measured_interval = 0.;
+            uint64_t frame_count = 0;
+
+            //The frame the last tick was for, and when it had to be done
+            uint64_t ticked_frame = UINT64_MAX;
+            uint64_t tick_deadline = 0;
+
+            //Jumps up to any slow tick, then decays, so ticks start early enough after a spike
+            double tick_estimate = 2000.;
+
+            //Since the last report
+            std::vector<uint64_t> present_intervals;
+            uint64_t late_ticks = 0;
+            uint64_t last_report_time = 0;
+
+            void report(uint64_t now);
+    };
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+
+#include "Definitions.hh"
+
+namespace Animate::Geometry
+{
+    /**
+     * Per instance data for instanced pipelines, added to every vertex of the instance.
+     */
+    struct Instance
+    {
+            Vector3 offset;
+            Vector3 texture_offset;
+
+            Instance(Vector3 o = Vector3(), Vector3 t = Vector3()) : offset(o), texture_offset(t) {}
+
+            static vk::VertexInputBindingDescription get_binding_description()
+            {
+                return vk::VertexInputBindingDescription()
+                    .setBinding(1)
+                    .setStride(sizeof(float) * 6)
+                    .setInputRate(vk::VertexInputRate::eInstance);
+            }
+
+            static std::array<vk::VertexInputAttributeDescription, 2> get_attribute_descriptions()
+            {
+                //Follow on from the vertex attributes
+                std::array<vk::VertexInputAttributeDescription, 2> attributes;
+                attributes[0]
+                    .setBinding(1)
+                    .setLocation(4)
+                    .setFormat(vk::Format::eR32G32B32Sfloat)
+                    .setOffset(offsetof(Instance, offset));
+
+                attributes[1]
+                    .setBinding(1)
+                    .setLocation(5)
+                    .setFormat(vk::Format::eR32G32B32Sfloat)
+                    .setOffset(offsetof(Instance, texture_offset));
+
+                return attributes;
+            }
+    };
+}
@@ -2,7 +2,7 @@
 #include <vector>
 #include <iostream>
 #include <cstdint>
-#include <unistd.h>
+#include <functional>
 
 #include "Gui.hh"
 #include "Utilities.hh"
@@ -84,6 +84,27 @@ void Gui::on_key(int key, int scancode, int action, int mods)
     if (key == GLFW_KEY_SPACE && action == GLFW_PRESS) {
         this->context->next_animation();
     }
+
+    //Cycle through FIFO, mailbox and immediate presentation
+    if (key == GLFW_KEY_P && action == GLFW_PRESS) {
+        std::shared_ptr<VK::Context> graphics_context = this->context->get_graphics_context().lock();
+
+        vk::PresentModeKHR present_mode;
+        switch (graphics_context->get_present_mode()) {
+            case vk::PresentModeKHR::eFifo:
+                present_mode = vk::PresentModeKHR::eMailbox;
+                break;
+            case vk::PresentModeKHR::eMailbox:
+                present_mode = vk::PresentModeKHR::eImmediate;
+                break;
+            default:
+                present_mode = vk::PresentModeKHR::eFifo;
+                break;
+        }
+
+        graphics_context->set_present_mode(present_mode);
+        std::cout << "Present mode: " << vk::to_string(present_mode) << std::endl;
+    }
 }
 
 void Gui::on_window_resize(int width, int height)
@@ -93,9 +114,12 @@ void Gui::on_window_resize(int width, int height)
 
 void Gui::start_loops()
 {
-    this->graphics_thread = std::thread(Gui::run_graphics_loop, this->context);
+    this->graphics_thread = std::thread(Gui::run_graphics_loop, this->context, std::ref(this->frame_pacer));
     this->run_tick_loop();
 
+    //Animations still initialising hold on to the context
+    this->context->wait_for_startup_tasks();
+
     this->context->should_close = true;
 
     if (this->graphics_thread.joinable()) {
@@ -104,45 +128,44 @@ void Gui::start_loops()
 }
 
 /**
- * Start the gui loop.
+ * Render frames when the frame pacer says they're due.
  */
-void Gui::run_graphics_loop(std::shared_ptr<AppContext> app_context)
+void Gui::run_graphics_loop(std::shared_ptr<AppContext> app_context, FramePacer &frame_pacer)
 {
-    uint64_t current_time, frame_count=0, last_frame_time=Utilities::get_micro_time();
-
     //Loop until the window is closed
     while (!app_context->should_close)
     {
+        frame_pacer.wait_for_frame();
+
         //Perform the render
-        app_context->get_graphics_context().lock()->render_scene();
-
-        current_time = Utilities::get_micro_time();
-        frame_count++;
-        if (current_time - last_frame_time >= 1000000) {
-            std::cout << "Frame time: " << 1000000./static_cast<float>(frame_count) << " FPS: " << frame_count << std::endl;
-            frame_count = 0;
-            last_frame_time = current_time;
-        }
+        std::shared_ptr<VK::Context> graphics_context = app_context->get_graphics_context().lock();
+        graphics_context->render_scene();
+        app_context->report_first_frame();
+
+        frame_pacer.on_present(graphics_context->get_present_mode() == vk::PresentModeKHR::eFifo);
     }
 
     //Get the graphics context again incase it's changed in the last.. millisecond?
     app_context->get_graphics_context().lock()->logical_device.waitIdle();
 }
 
+/**
+ * Tick once per frame, timed by the frame pacer to finish just before the frame reads the scene.
+ */
 void Gui::run_tick_loop()
 {
-    int tick_rate = 60;
     uint64_t last_tick_time = Utilities::get_micro_time();
-    uint64_t tick_time = Utilities::get_micro_time();
-    uint64_t tick_delta = 0;
 
     //Loop until the window is closed
     while (!glfwWindowShouldClose(this->context->get_window()))
     {
-        tick_time = Utilities::get_micro_time();
-        tick_delta = tick_time - last_tick_time;
+        uint64_t tick_time = this->frame_pacer.wait_for_tick();
+        uint64_t tick_delta = tick_time - last_tick_time;
         last_tick_time = tick_time;
 
+        //Surface failures from animations initialising in the background
+        this->context->check_startup_tasks();
+
         //Construct a frame for the current animation if it's loaded, otherwise noise.
         std::weak_ptr<Animation::Animation> current_animation = this->context->get_current_animation();
         current_animation.lock()->on_tick(tick_delta);
@@ -152,10 +175,6 @@ void Gui::run_tick_loop()
         //Poll events
         glfwPollEvents();
 
-        last_tick_time = Utilities::get_micro_time();
-
-        if ((1000000. / tick_rate) > tick_delta) {
-            usleep((1000000. / tick_rate) - tick_delta);
-        }
+        this->frame_pacer.on_tick_finished(tick_time);
     }
-}
\ No newline at end of file
+}
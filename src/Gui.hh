@@ -8,6 +8,7 @@
 
 #include "Animation/Animation.hh"
 #include "AppContext.hh"
+#include "FramePacer.hh"
 
 using namespace Animate::Animation;
 
@@ -27,12 +28,13 @@ namespace Animate
         private:
             std::shared_ptr<AppContext> context;
             std::thread graphics_thread;
+            FramePacer frame_pacer;
 
             void init_glfw();
             void init_graphics();
             void init_context();
 
             void run_tick_loop();
-            static void run_graphics_loop(std::shared_ptr<AppContext> app_context);
+            static void run_graphics_loop(std::shared_ptr<AppContext> app_context, FramePacer &frame_pacer);
     };
 }
@@ -57,11 +57,37 @@ vk::Buffer const Drawable::get_index_buffer()
     return nullptr;
 }
 
+/**
+ * return nullptr for drawables that are drawn once.
+ *
+ * @return nullptr
+ **/
+vk::Buffer const Drawable::get_instance_buffer()
+{
+    return nullptr;
+}
+
 uint32_t Drawable::get_index_count()
 {
     return this->indices;
 }
 
+/**
+ * How many copies to draw, each reading its own entry in the instance buffer.
+ */
+uint32_t Drawable::get_instance_count()
+{
+    return 1;
+}
+
+/**
+ * The texture table slot pushed with this drawable's draw, slot 0 is the blank texture.
+ */
+uint32_t Drawable::get_texture_slot()
+{
+    return 0;
+}
+
 std::weak_ptr<Pipeline> const Drawable::get_pipeline()
 {
     return this->pipeline;
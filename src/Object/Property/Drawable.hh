@@ -40,8 +40,11 @@ namespace Animate
 
                 virtual vk::Buffer const get_vertex_buffer();
                 virtual vk::Buffer const get_index_buffer();
+                virtual vk::Buffer const get_instance_buffer();
 
                 uint32_t get_index_count();
+                virtual uint32_t get_instance_count();
+                virtual uint32_t get_texture_slot();
 
                 std::weak_ptr<VK::Pipeline> const get_pipeline();
                 Matrix const get_model_matrix();
@@ -0,0 +1,135 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "Resources.hh"
+
+using namespace Animate;
+
+//The pack is linked into read only data, RESOURCE_PACK_PATH is set by the build
+__asm__(
+    ".section .rodata\n"
+    ".global animate_resource_pack\n"
+    ".global animate_resource_pack_end\n"
+    ".balign 64\n"
+    "animate_resource_pack:\n"
+    ".incbin \"" RESOURCE_PACK_PATH "\"\n"
+    "animate_resource_pack_end:\n"
+    ".previous\n"
+);
+
+extern "C" const uint8_t animate_resource_pack[];
+extern "C" const uint8_t animate_resource_pack_end[];
+
+static const uint32_t pack_version = 2;
+
+std::unordered_map<std::string_view, Resources::Entry> Resources::index;
+
+/**
+ * Read the pack's index.
+ * Names and contents stay where they are in the binary, only the index is built.
+ */
+void Resources::initialise()
+{
+    static_assert(sizeof(PackHeader) == 32, "Pack header layout must match GenerateResources.py");
+    static_assert(sizeof(PackEntry) == 32, "Pack entry layout must match GenerateResources.py");
+
+    uint8_t const *pack = animate_resource_pack;
+    size_t pack_size = animate_resource_pack_end - animate_resource_pack;
+
+    if (pack_size < sizeof(PackHeader)) {
+        throw std::runtime_error("Resource pack is truncated.");
+    }
+
+    PackHeader header;
+    std::memcpy(&header, pack, sizeof(PackHeader));
+
+    if (std::memcmp(header.magic, "ANPK", 4) != 0 || header.version != pack_version) {
+        throw std::runtime_error("Resource pack has an unknown format.");
+    }
+
+    size_t index_offset = sizeof(PackHeader);
+    size_t string_table_offset = index_offset + sizeof(PackEntry) * header.entry_count;
+
+    if (header.total_size != pack_size || string_table_offset + header.string_table_size > pack_size) {
+        throw std::runtime_error("Resource pack is truncated.");
+    }
+
+    char const *string_table = reinterpret_cast<char const *>(pack + string_table_offset);
+
+    Resources::index.clear();
+    Resources::index.reserve(header.entry_count);
+
+    for (uint32_t i = 0; i < header.entry_count; i++) {
+        PackEntry entry;
+        std::memcpy(&entry, pack + index_offset + sizeof(PackEntry) * i, sizeof(PackEntry));
+
+        if (static_cast<uint64_t>(entry.name_offset) + entry.name_length > header.string_table_size ||
+            entry.offset + entry.size > pack_size
+        ) {
+            throw std::runtime_error("Resource pack has an invalid index entry.");
+        }
+
+        ResourceSpan span;
+        span.data = pack + entry.offset;
+        span.size = entry.size;
+        span.type = static_cast<ResourceType>(entry.type);
+
+        Resources::index.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(string_table + entry.name_offset, entry.name_length),
+            std::forward_as_tuple(span, entry.crc32)
+        );
+    }
+}
+
+/**
+ * Look up a resource, verifying its checksum on first use.
+ *
+ * @param key The resource's path, as listed in resources.json.
+ *
+ * @return A view of the resource's bytes, valid for the lifetime of the program.
+ */
+ResourceSpan Resources::get(std::string_view key)
+{
+    auto search = Resources::index.find(key);
+
+    if (search == Resources::index.end()) {
+        throw std::runtime_error("Resource not found: " + std::string(key));
+    }
+
+    Entry &entry = search->second;
+
+    if (!entry.verified) {
+        if (Resources::crc32(entry.span.data, entry.span.size) != entry.crc32) {
+            throw std::runtime_error("Resource is corrupt: " + std::string(key));
+        }
+        entry.verified = true;
+    }
+
+    return entry.span;
+}
+
+/**
+ * Standard CRC-32 (as zlib's crc32), matching the checksums written by GenerateResources.py.
+ */
+uint32_t Resources::crc32(uint8_t const *data, size_t size)
+{
+    static uint32_t const *table = []() {
+        static uint32_t table[256];
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; bit++) {
+                value = (value & 1) ? (0xedb88320 ^ (value >> 1)) : (value >> 1);
+            }
+            table[i] = value;
+        }
+        return table;
+    }();
+
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+
+    return crc ^ 0xffffffff;
+}
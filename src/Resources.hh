@@ -1,14 +1,71 @@
-#pragma once
-
-#include <vector>
-#include <map>
-
-namespace Animate
-{
-    class Resources
-    {
-        public:
-            static void initialise();
-            static std::map<std::string, std::vector<uint8_t> > resources;
-    };
-}
\ No newline at end of file
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace Animate
+{
+    enum class ResourceType : uint16_t {
+        RAW = 0,
+        //Baked by texture-baker, see VK/TextureContainer.hh
+        TEXTURE = 1
+    };
+
+    /**
+     * A view of a resource's bytes inside the embedded pack.
+     */
+    struct ResourceSpan {
+        uint8_t const *data = nullptr;
+        size_t size = 0;
+        ResourceType type = ResourceType::RAW;
+    };
+
+    /**
+     * Resources embedded in the binary as a single pack built by GenerateResources.py.
+     * Lookups return views into the pack, nothing is copied.
+     */
+    class Resources
+    {
+        public:
+            static void initialise();
+            static ResourceSpan get(std::string_view key);
+
+        private:
+            struct PackHeader {
+                char magic[4];
+                uint32_t version;
+                uint32_t entry_count;
+                uint32_t string_table_size;
+                uint64_t data_offset;
+                uint64_t total_size;
+            };
+
+            struct PackEntry {
+                uint32_t name_offset;
+                uint32_t name_length;
+                uint64_t offset;
+                uint64_t size;
+                uint32_t crc32;
+                uint16_t alignment;
+                uint16_t type;
+            };
+
+            struct Entry {
+                Entry(ResourceSpan span, uint32_t crc32) : span(span), crc32(crc32) {}
+
+                ResourceSpan span;
+                uint32_t crc32;
+
+                //Checksums are verified the first time a resource is used
+                std::atomic_bool verified = false;
+            };
+
+            static std::unordered_map<std::string_view, Entry> index;
+
+            static uint32_t crc32(uint8_t const *data, size_t size);
+    };
+}
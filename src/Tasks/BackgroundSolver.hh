@@ -0,0 +1,99 @@
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <functional>
+
+#include "BoundedQueue.hh"
+
+namespace Animate::Tasks
+{
+    /**
+     * Solves things one after another on its own thread, keeping a few ready so the tick thread
+     * never waits on a solve.
+     *
+     * The solve function is called on the worker thread and should give up once the flag it's
+     * given is set. It's called from the constructor on, so anything it uses must already exist.
+     */
+    template <typename T>
+    class BackgroundSolver
+    {
+        public:
+            using Solve = std::function<T(std::atomic_bool const& cancelled)>;
+
+            /**
+             * Constructor.
+             * Starts solving straight away.
+             *
+             * @param capacity How many solved items to keep ready.
+             * @param solve    Makes one solved item.
+             */
+            BackgroundSolver(size_t capacity, Solve solve) :
+                solve(solve),
+                items(capacity)
+            {
+                this->worker = std::thread(&BackgroundSolver::run, this);
+            }
+
+            /**
+             * Destructor.
+             * Cancels the solve in progress and waits for it to stop.
+             */
+            ~BackgroundSolver()
+            {
+                this->cancel();
+
+                if (this->worker.joinable()) {
+                    this->worker.join();
+                }
+            }
+
+            /**
+             * Take a solved item if one is ready, without waiting.
+             */
+            bool try_take(T &item)
+            {
+                return this->items.try_pop(item);
+            }
+
+            /**
+             * Take a solved item, waiting for one.
+             *
+             * @return False if cancelled before one was ready.
+             */
+            bool take(T &item)
+            {
+                return this->items.pop(item);
+            }
+
+            /**
+             * Stop solving, a solve in progress is abandoned.
+             */
+            void cancel()
+            {
+                this->cancelled = true;
+                this->items.close();
+            }
+
+        private:
+            Solve solve;
+            BoundedQueue<T> items;
+            std::atomic_bool cancelled = false;
+
+            std::thread worker;
+
+            /**
+             * Keep the queue of solved items full until cancelled.
+             */
+            void run()
+            {
+                while (!this->cancelled) {
+                    T item = this->solve(this->cancelled);
+
+                    if (this->cancelled || !this->items.push(std::move(item))) {
+                        return;
+                    }
+                }
+            }
+    };
+}
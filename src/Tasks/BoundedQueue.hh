@@ -0,0 +1,111 @@
+#pragma once
+
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+
+namespace Animate::Tasks
+{
+    /**
+     * A queue holding at most a fixed number of items, for handing work from a producer thread to
+     * a consumer. Producers block while it's full, consumers can poll or block while it's empty.
+     * Closing it wakes everyone, after which pushes fail and pops drain what's left.
+     */
+    template <typename T>
+    class BoundedQueue
+    {
+        public:
+            BoundedQueue(size_t capacity) : capacity(capacity)
+            {
+            }
+
+            /**
+             * Add an item, waiting for space.
+             *
+             * @return False if the queue was closed, the item is dropped.
+             */
+            bool push(T item)
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->space_condition.wait(lock, [this]() {
+                    return this->closed || this->items.size() < this->capacity;
+                });
+
+                if (this->closed) {
+                    return false;
+                }
+
+                this->items.push(std::move(item));
+                this->item_condition.notify_one();
+                return true;
+            }
+
+            /**
+             * Take an item if there is one, without waiting.
+             */
+            bool try_pop(T &item)
+            {
+                std::lock_guard<std::mutex> guard(this->mutex);
+
+                if (this->items.empty()) {
+                    return false;
+                }
+
+                this->take(item);
+                return true;
+            }
+
+            /**
+             * Take an item, waiting for one.
+             *
+             * @return False if the queue was closed and is empty.
+             */
+            bool pop(T &item)
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->item_condition.wait(lock, [this]() {
+                    return this->closed || !this->items.empty();
+                });
+
+                if (this->items.empty()) {
+                    return false;
+                }
+
+                this->take(item);
+                return true;
+            }
+
+            void close()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(this->mutex);
+                    this->closed = true;
+                }
+
+                this->space_condition.notify_all();
+                this->item_condition.notify_all();
+            }
+
+            size_t size()
+            {
+                std::lock_guard<std::mutex> guard(this->mutex);
+                return this->items.size();
+            }
+
+        private:
+            size_t capacity;
+            std::queue<T> items;
+            bool closed = false;
+
+            std::mutex mutex;
+            std::condition_variable space_condition;
+            std::condition_variable item_condition;
+
+            void take(T &item)
+            {
+                item = std::move(this->items.front());
+                this->items.pop();
+                this->space_condition.notify_one();
+            }
+    };
+}
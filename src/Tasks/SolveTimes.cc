@@ -0,0 +1,50 @@
+#include <iostream>
+
+#include "SolveTimes.hh"
+
+using namespace Animate::Tasks;
+
+/**
+ * Constructor.
+ *
+ * @param label   What's solved, starts each print.
+ * @param outcome What the outcome counted alongside the times is called.
+ */
+SolveTimes::SolveTimes(std::string label, std::string outcome) :
+    label(label),
+    outcome(outcome)
+{
+}
+
+/**
+ * Add a solve to the histogram, printing it every 32 solves.
+ *
+ * @param outcome Whether the solve had the counted outcome.
+ */
+void SolveTimes::record(uint64_t milliseconds, bool outcome)
+{
+    std::lock_guard<std::mutex> guard(this->mutex);
+
+    size_t bucket = 0;
+    while (bucket < this->buckets.size() - 1 && (1ull << bucket) <= milliseconds) {
+        bucket++;
+    }
+
+    this->buckets[bucket]++;
+    this->solve_count++;
+    if (outcome) {
+        this->outcome_count++;
+    }
+
+    if (this->solve_count % 32 != 0) {
+        return;
+    }
+
+    std::cout << this->label << " solve times (" << this->solve_count << " solves, " << this->outcome_count << " " << this->outcome << "):";
+    for (size_t i = 0; i < this->buckets.size(); i++) {
+        if (this->buckets[i] > 0) {
+            std::cout << " <" << (1ull << i) << "ms: " << this->buckets[i];
+        }
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <array>
+#include <mutex>
+#include <cstdint>
+
+namespace Animate::Tasks
+{
+    /**
+     * A histogram of how long solves take, printed every so often.
+     * Bucket i counts solves taking under 2^i milliseconds.
+     */
+    class SolveTimes
+    {
+        public:
+            SolveTimes(std::string label, std::string outcome);
+
+            void record(uint64_t milliseconds, bool outcome);
+
+        private:
+            //What's solved, and what the counted outcome is called
+            std::string label;
+            std::string outcome;
+
+            std::mutex mutex;
+            std::array<uint64_t, 16> buckets = {};
+            uint64_t solve_count = 0;
+            uint64_t outcome_count = 0;
+    };
+}
@@ -0,0 +1,208 @@
+#include <stdexcept>
+
+#include "TaskGraph.hh"
+
+using namespace Animate::Tasks;
+
+/**
+ * Add a task to the graph.
+ *
+ * @param name          A unique name to refer to the task by.
+ * @param dependencies  Names of the tasks that must finish first.
+ * @param work          The task itself.
+ */
+void TaskGraph::add(std::string name, std::vector<std::string> dependencies, std::function<void()> work)
+{
+    std::lock_guard<std::mutex> guard(this->task_mutex);
+
+    if (this->thread_pool != nullptr) {
+        throw std::runtime_error("Tried to add a task to a running task graph: " + name);
+    }
+
+    if (this->tasks.count(name) > 0) {
+        throw std::runtime_error("Duplicate task name: " + name);
+    }
+
+    Task &task = this->tasks[name];
+    task.work = work;
+    task.dependencies = dependencies;
+
+    this->order.push_back(name);
+}
+
+/**
+ * Start every task without dependencies, the rest follow as their dependencies finish.
+ *
+ * @param thread_pool The pool to run tasks on.
+ */
+void TaskGraph::run(ThreadPool &thread_pool)
+{
+    std::lock_guard<std::mutex> guard(this->task_mutex);
+
+    if (this->thread_pool != nullptr) {
+        throw std::runtime_error("Task graph is already running.");
+    }
+
+    for (auto const& name : this->order) {
+        Task &task = this->tasks[name];
+        for (auto const& dependency : task.dependencies) {
+            this->find_task(dependency).dependents.push_back(name);
+        }
+        task.remaining_dependencies = task.dependencies.size();
+    }
+
+    //Every task has to be reachable from one without dependencies
+    std::map<std::string, size_t> remaining;
+    std::vector<std::string> ready;
+    for (auto const& entry : this->tasks) {
+        remaining[entry.first] = entry.second.remaining_dependencies;
+        if (entry.second.remaining_dependencies == 0) {
+            ready.push_back(entry.first);
+        }
+    }
+
+    size_t visited = 0;
+    for (size_t i = 0; i < ready.size(); i++, visited++) {
+        for (auto const& dependent : this->tasks[ready[i]].dependents) {
+            if (--remaining[dependent] == 0) {
+                ready.push_back(dependent);
+            }
+        }
+    }
+
+    if (visited != this->tasks.size()) {
+        throw std::runtime_error("Task graph has a dependency cycle.");
+    }
+
+    this->thread_pool = &thread_pool;
+
+    //The pool runs tasks in order of submission, so earlier tasks start first
+    for (auto const& name : this->order) {
+        if (this->tasks[name].remaining_dependencies == 0) {
+            this->schedule(name);
+        }
+    }
+}
+
+/**
+ * Block until a task has finished.
+ * Rethrows the exception the task failed with, if any.
+ *
+ * @param name The task's name.
+ */
+void TaskGraph::wait(std::string name)
+{
+    std::unique_lock<std::mutex> lock(this->task_mutex);
+
+    Task &task = this->find_task(name);
+    this->finished_condition.wait(lock, [&task]() {
+        return task.finished;
+    });
+
+    if (task.exception) {
+        std::rethrow_exception(task.exception);
+    }
+}
+
+/**
+ * Block until every task has finished.
+ * Rethrows the first exception any task failed with.
+ */
+void TaskGraph::wait_all()
+{
+    std::unique_lock<std::mutex> lock(this->task_mutex);
+
+    this->finished_condition.wait(lock, [this]() {
+        for (auto const& entry : this->tasks) {
+            if (!entry.second.finished) {
+                return false;
+            }
+        }
+        return true;
+    });
+
+    if (this->first_exception) {
+        std::rethrow_exception(this->first_exception);
+    }
+}
+
+bool TaskGraph::is_finished(std::string name)
+{
+    std::lock_guard<std::mutex> guard(this->task_mutex);
+    return this->find_task(name).finished;
+}
+
+/**
+ * Rethrow the first task failure, once, so it can be surfaced from a polling thread.
+ */
+void TaskGraph::rethrow_failure()
+{
+    std::lock_guard<std::mutex> guard(this->task_mutex);
+
+    if (this->first_exception && !this->failure_reported) {
+        this->failure_reported = true;
+        std::rethrow_exception(this->first_exception);
+    }
+}
+
+/**
+ * Submit a task to the pool, expects the task mutex to be held.
+ */
+void TaskGraph::schedule(std::string name)
+{
+    std::function<void()> work = this->find_task(name).work;
+
+    this->thread_pool->submit([this, name, work]() {
+        std::exception_ptr exception;
+        try {
+            work();
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> guard(this->task_mutex);
+        this->complete(name, exception);
+    });
+}
+
+/**
+ * Mark a task finished and release its dependents, expects the task mutex to be held.
+ */
+void TaskGraph::complete(std::string name, std::exception_ptr exception)
+{
+    Task &task = this->find_task(name);
+    task.finished = true;
+    task.exception = exception;
+
+    if (exception && !this->first_exception) {
+        this->first_exception = exception;
+    }
+
+    for (auto const& dependent_name : task.dependents) {
+        Task &dependent = this->find_task(dependent_name);
+
+        //Dependents of a failed task inherit its failure instead of running
+        if (exception && !dependent.exception) {
+            dependent.exception = exception;
+        }
+
+        if (--dependent.remaining_dependencies == 0) {
+            if (dependent.exception) {
+                this->complete(dependent_name, dependent.exception);
+            } else {
+                this->schedule(dependent_name);
+            }
+        }
+    }
+
+    this->finished_condition.notify_all();
+}
+
+TaskGraph::Task &TaskGraph::find_task(std::string name)
+{
+    std::map<std::string, Task>::iterator it = this->tasks.find(name);
+    if (it == this->tasks.end()) {
+        throw std::runtime_error("Unknown task: " + name);
+    }
+    return it->second;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+#include "ThreadPool.hh"
+
+namespace Animate::Tasks
+{
+    /**
+     * Named tasks run on a thread pool once every task they depend on has finished.
+     * A task whose dependency failed doesn't run and fails with the same exception.
+     * Tasks ready at the same time are started in the order they were added.
+     *
+     * The thread pool given to run() must outlive the graph's tasks.
+     */
+    class TaskGraph
+    {
+        public:
+            void add(std::string name, std::vector<std::string> dependencies, std::function<void()> work);
+            void run(ThreadPool &thread_pool);
+
+            void wait(std::string name);
+            void wait_all();
+            bool is_finished(std::string name);
+            void rethrow_failure();
+
+        private:
+            struct Task {
+                std::function<void()> work;
+                std::vector<std::string> dependencies;
+                std::vector<std::string> dependents;
+                size_t remaining_dependencies = 0;
+                bool finished = false;
+                std::exception_ptr exception;
+            };
+
+            ThreadPool *thread_pool = nullptr;
+
+            std::mutex task_mutex;
+            std::condition_variable finished_condition;
+            std::map<std::string, Task> tasks;
+
+            //Task names in the order they were added
+            std::vector<std::string> order;
+            std::exception_ptr first_exception;
+            bool failure_reported = false;
+
+            void schedule(std::string name);
+            void complete(std::string name, std::exception_ptr exception);
+            Task &find_task(std::string name);
+    };
+}
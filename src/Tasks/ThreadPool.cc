@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <stdexcept>
+#include <memory>
+
+#include "ThreadPool.hh"
+
+using namespace Animate::Tasks;
+
+/**
+ * Constructor.
+ * Starts the workers.
+ *
+ * @param thread_count The number of workers, at least one is always started.
+ */
+ThreadPool::ThreadPool(size_t thread_count)
+{
+    thread_count = std::max<size_t>(thread_count, 1);
+
+    for (size_t i = 0; i < thread_count; i++) {
+        this->workers.emplace_back(&ThreadPool::run_worker, this);
+    }
+}
+
+/**
+ * Destructor.
+ * Tasks already submitted are run before the workers exit.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(this->queue_mutex);
+        this->stopping = true;
+    }
+    this->queue_condition.notify_all();
+
+    for (auto &worker : this->workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+/**
+ * Queue a task to run on the next free worker.
+ *
+ * @param task The task.
+ *
+ * @return A future completing with the task, holding any exception it threw.
+ */
+std::future<void> ThreadPool::submit(std::function<void()> task)
+{
+    std::packaged_task<void()> packaged_task(task);
+    std::future<void> future = packaged_task.get_future();
+
+    {
+        std::lock_guard<std::mutex> guard(this->queue_mutex);
+        if (this->stopping) {
+            throw std::runtime_error("Tried to submit a task to a stopping thread pool.");
+        }
+        this->queue.push(std::move(packaged_task));
+    }
+    this->queue_condition.notify_one();
+
+    return future;
+}
+
+/**
+ * Run body(i) for every i in [0, count) across the pool, returning once all have run.
+ *
+ * The calling thread takes indices too, so this is safe to call from a task already
+ * running on the pool: helpers that only start after the work is done exit at once
+ * and aren't waited for.
+ *
+ * @param count The number of indices.
+ * @param body  The work for one index.
+ */
+void ThreadPool::parallel_for(size_t count, std::function<void(size_t)> body)
+{
+    struct State {
+        std::atomic<size_t> next_index{0};
+        std::mutex mutex;
+        std::condition_variable condition;
+        size_t active_helpers = 0;
+        bool closed = false;
+        std::exception_ptr exception;
+    };
+
+    std::shared_ptr<State> state = std::make_shared<State>();
+
+    //Claims indices until none are left, keeping the first exception
+    auto run = [state, count, body]() {
+        size_t index;
+        while ((index = state->next_index++) < count) {
+            try {
+                body(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(state->mutex);
+                if (!state->exception) {
+                    state->exception = std::current_exception();
+                }
+            }
+        }
+    };
+
+    size_t helper_count = std::min(this->workers.size(), count > 0 ? count - 1 : 0);
+    for (size_t i = 0; i < helper_count; i++) {
+        this->submit([state, run]() {
+            {
+                std::lock_guard<std::mutex> guard(state->mutex);
+                if (state->closed) {
+                    return;
+                }
+                state->active_helpers++;
+            }
+
+            run();
+
+            std::lock_guard<std::mutex> guard(state->mutex);
+            state->active_helpers--;
+            state->condition.notify_all();
+        });
+    }
+
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->closed = true;
+    state->condition.wait(lock, [&state]() {
+        return state->active_helpers == 0;
+    });
+
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+}
+
+size_t ThreadPool::get_thread_count() const
+{
+    return this->workers.size();
+}
+
+void ThreadPool::run_worker()
+{
+    while (true) {
+        std::packaged_task<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(this->queue_mutex);
+            this->queue_condition.wait(lock, [this]() {
+                return this->stopping || !this->queue.empty();
+            });
+
+            if (this->queue.empty()) {
+                return;
+            }
+
+            task = std::move(this->queue.front());
+            this->queue.pop();
+        }
+
+        task();
+    }
+}
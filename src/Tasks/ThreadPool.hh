@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <exception>
+
+namespace Animate::Tasks
+{
+    /**
+     * A fixed set of worker threads running submitted tasks in order of submission.
+     */
+    class ThreadPool
+    {
+        public:
+            ThreadPool(size_t thread_count = std::thread::hardware_concurrency());
+            ~ThreadPool();
+
+            std::future<void> submit(std::function<void()> task);
+            void parallel_for(size_t count, std::function<void(size_t)> body);
+            size_t get_thread_count() const;
+
+        private:
+            std::vector<std::thread> workers;
+            std::queue< std::packaged_task<void()> > queue;
+
+            std::mutex queue_mutex;
+            std::condition_variable queue_condition;
+            bool stopping = false;
+
+            void run_worker();
+    };
+}
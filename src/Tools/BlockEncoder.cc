@@ -0,0 +1,514 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "BlockEncoder.hh"
+#include "../VK/Etc2Format.hh"
+
+using namespace Animate::Tools;
+
+namespace Etc2Format = Animate::VK::Etc2Format;
+
+//BC7 interpolation weights for four bit indices, out of 64
+static const int bc7_weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+/**
+ * BC7 mode 6 endpoints, seven bits per channel and a low bit shared by each endpoint's channels.
+ */
+struct Bc7Endpoints {
+    int colour[2][4];
+    int p_bits[2];
+};
+
+static int clamp(int value, int low, int high)
+{
+    return std::min(std::max(value, low), high);
+}
+
+/**
+ * Read a block's texels row by row, repeating the last column and row past the image's edges.
+ */
+static void load_block(uint8_t const *pixels, uint32_t width, uint32_t height, uint32_t block_x, uint32_t block_y, int block[16][4])
+{
+    for (uint32_t y = 0; y < 4; y++) {
+        uint32_t source_y = std::min(block_y * 4 + y, height - 1);
+
+        for (uint32_t x = 0; x < 4; x++) {
+            uint32_t source_x = std::min(block_x * 4 + x, width - 1);
+            uint8_t const *texel = pixels + (static_cast<uint64_t>(source_y) * width + source_x) * 4;
+
+            for (uint32_t channel = 0; channel < 4; channel++) {
+                block[y * 4 + x][channel] = texel[channel];
+            }
+        }
+    }
+}
+
+/**
+ * Store a 64 bit word most significant byte first, as ETC and EAC expect.
+ */
+static void write_big_endian(uint64_t word, uint8_t *output)
+{
+    for (int i = 0; i < 8; i++) {
+        output[i] = static_cast<uint8_t>(word >> (56 - i * 8));
+    }
+}
+
+/**
+ * Choose the nearest of the palette between two endpoints for each texel.
+ *
+ * @return The summed squared error.
+ */
+static uint64_t bc7_fit(int const block[16][4], Bc7Endpoints const& endpoints, int indices[16])
+{
+    int palette[16][4];
+    for (int channel = 0; channel < 4; channel++) {
+        int first = (endpoints.colour[0][channel] << 1) | endpoints.p_bits[0];
+        int second = (endpoints.colour[1][channel] << 1) | endpoints.p_bits[1];
+
+        for (int i = 0; i < 16; i++) {
+            palette[i][channel] = ((64 - bc7_weights[i]) * first + bc7_weights[i] * second + 32) >> 6;
+        }
+    }
+
+    uint64_t total_error = 0;
+    for (int texel = 0; texel < 16; texel++) {
+        int best_error = std::numeric_limits<int>::max();
+
+        for (int i = 0; i < 16; i++) {
+            int error = 0;
+            for (int channel = 0; channel < 4; channel++) {
+                int difference = palette[i][channel] - block[texel][channel];
+                error += difference * difference;
+            }
+
+            if (error < best_error) {
+                best_error = error;
+                indices[texel] = i;
+            }
+        }
+
+        total_error += best_error;
+    }
+
+    return total_error;
+}
+
+/**
+ * Quantise endpoints to mode 6's precision, keeping whichever low bits fit the block best.
+ *
+ * @return The summed squared error.
+ */
+static uint64_t bc7_quantise(float const endpoints[2][4], int const block[16][4], Bc7Endpoints &best, int indices[16])
+{
+    uint64_t best_error = std::numeric_limits<uint64_t>::max();
+
+    for (int p_bits = 0; p_bits < 4; p_bits++) {
+        Bc7Endpoints candidate;
+        candidate.p_bits[0] = p_bits & 1;
+        candidate.p_bits[1] = p_bits >> 1;
+
+        for (int endpoint = 0; endpoint < 2; endpoint++) {
+            for (int channel = 0; channel < 4; channel++) {
+                float value = (endpoints[endpoint][channel] - candidate.p_bits[endpoint]) / 2.0f;
+                candidate.colour[endpoint][channel] = clamp(static_cast<int>(std::lround(value)), 0, 127);
+            }
+        }
+
+        int candidate_indices[16];
+        uint64_t error = bc7_fit(block, candidate, candidate_indices);
+        if (error < best_error) {
+            best_error = error;
+            best = candidate;
+            std::memcpy(indices, candidate_indices, sizeof(candidate_indices));
+        }
+    }
+
+    return best_error;
+}
+
+/**
+ * Compress a block with BC7 mode 6: one line through RGBA space with sixteen steps.
+ */
+static void encode_bc7_block(int const block[16][4], uint8_t *output)
+{
+    float mean[4] = {};
+    for (int texel = 0; texel < 16; texel++) {
+        for (int channel = 0; channel < 4; channel++) {
+            mean[channel] += block[texel][channel] / 16.0f;
+        }
+    }
+
+    float covariance[4][4] = {};
+    float axis[4] = {};
+    for (int channel = 0; channel < 4; channel++) {
+        int low = 255, high = 0;
+        for (int texel = 0; texel < 16; texel++) {
+            low = std::min(low, block[texel][channel]);
+            high = std::max(high, block[texel][channel]);
+
+            for (int other = 0; other < 4; other++) {
+                covariance[channel][other] +=
+                    (block[texel][channel] - mean[channel]) * (block[texel][other] - mean[other]);
+            }
+        }
+        axis[channel] = static_cast<float>(high - low);
+    }
+
+    //The principal axis, by power iteration from the bounding box's diagonal
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = {};
+        float largest = 0.0f;
+        for (int channel = 0; channel < 4; channel++) {
+            for (int other = 0; other < 4; other++) {
+                next[channel] += covariance[channel][other] * axis[other];
+            }
+            largest = std::max(largest, std::fabs(next[channel]));
+        }
+
+        if (largest == 0.0f) {
+            break;
+        }
+
+        for (int channel = 0; channel < 4; channel++) {
+            axis[channel] = next[channel] / largest;
+        }
+    }
+
+    float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3]);
+
+    //Span the texels' projections onto the axis
+    float endpoints[2][4];
+    float low = 0.0f, high = 0.0f;
+    if (length > 0.0f) {
+        for (int texel = 0; texel < 16; texel++) {
+            float projection = 0.0f;
+            for (int channel = 0; channel < 4; channel++) {
+                projection += (block[texel][channel] - mean[channel]) * axis[channel] / length;
+            }
+            low = std::min(low, projection);
+            high = std::max(high, projection);
+        }
+    }
+
+    for (int channel = 0; channel < 4; channel++) {
+        float direction = length > 0.0f ? axis[channel] / length : 0.0f;
+        endpoints[0][channel] = std::min(std::max(mean[channel] + low * direction, 0.0f), 255.0f);
+        endpoints[1][channel] = std::min(std::max(mean[channel] + high * direction, 0.0f), 255.0f);
+    }
+
+    Bc7Endpoints quantised;
+    int indices[16];
+    uint64_t error = bc7_quantise(endpoints, block, quantised, indices);
+
+    //Refit the endpoints to the chosen indices by least squares while that helps
+    for (int iteration = 0; iteration < 2 && error > 0; iteration++) {
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[4] = {}, bx[4] = {};
+        for (int texel = 0; texel < 16; texel++) {
+            float b = bc7_weights[indices[texel]] / 64.0f;
+            float a = 1.0f - b;
+
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int channel = 0; channel < 4; channel++) {
+                ax[channel] += a * block[texel][channel];
+                bx[channel] += b * block[texel][channel];
+            }
+        }
+
+        float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) < 1e-6f) {
+            break;
+        }
+
+        float refit[2][4];
+        for (int channel = 0; channel < 4; channel++) {
+            refit[0][channel] = std::min(std::max((bb * ax[channel] - ab * bx[channel]) / determinant, 0.0f), 255.0f);
+            refit[1][channel] = std::min(std::max((aa * bx[channel] - ab * ax[channel]) / determinant, 0.0f), 255.0f);
+        }
+
+        Bc7Endpoints refit_quantised;
+        int refit_indices[16];
+        uint64_t refit_error = bc7_quantise(refit, block, refit_quantised, refit_indices);
+        if (refit_error >= error) {
+            break;
+        }
+
+        error = refit_error;
+        quantised = refit_quantised;
+        std::memcpy(indices, refit_indices, sizeof(refit_indices));
+    }
+
+    //The first index is stored without its top bit, so has to be in the lower half
+    if (indices[0] >= 8) {
+        for (int channel = 0; channel < 4; channel++) {
+            std::swap(quantised.colour[0][channel], quantised.colour[1][channel]);
+        }
+        std::swap(quantised.p_bits[0], quantised.p_bits[1]);
+
+        for (int texel = 0; texel < 16; texel++) {
+            indices[texel] = 15 - indices[texel];
+        }
+    }
+
+    //Fields are packed from the least significant bit of the first byte
+    uint8_t bits[16] = {};
+    int position = 0;
+    auto write = [&bits, &position](uint32_t value, int count) {
+        for (int bit = 0; bit < count; bit++, position++) {
+            if ((value >> bit) & 1) {
+                bits[position / 8] |= static_cast<uint8_t>(1 << (position % 8));
+            }
+        }
+    };
+
+    write(1 << 6, 7);
+    for (int channel = 0; channel < 4; channel++) {
+        write(quantised.colour[0][channel], 7);
+        write(quantised.colour[1][channel], 7);
+    }
+    write(quantised.p_bits[0], 1);
+    write(quantised.p_bits[1], 1);
+
+    write(indices[0], 3);
+    for (int texel = 1; texel < 16; texel++) {
+        write(indices[texel], 4);
+    }
+
+    std::memcpy(output, bits, sizeof(bits));
+}
+
+/**
+ * Whether a texel, indexed row by row, is in the second half of an ETC block.
+ */
+static bool etc_in_second_subblock(int texel, bool flip)
+{
+    return flip ? (texel / 4) >= 2 : (texel % 4) >= 2;
+}
+
+/**
+ * Find the modifier table and per texel modifiers that best fit half a block around a base colour.
+ *
+ * @return The summed squared error.
+ */
+static uint64_t etc_fit_subblock(int const block[16][4], bool flip, int subblock, int const base[3], int &table, int indices[16])
+{
+    uint64_t best_error = std::numeric_limits<uint64_t>::max();
+
+    for (int candidate = 0; candidate < 8; candidate++) {
+        uint64_t error = 0;
+        int candidate_indices[16];
+
+        for (int texel = 0; texel < 16; texel++) {
+            if (etc_in_second_subblock(texel, flip) != (subblock == 1)) {
+                continue;
+            }
+
+            int best_texel_error = std::numeric_limits<int>::max();
+            for (int i = 0; i < 4; i++) {
+                int texel_error = 0;
+                for (int channel = 0; channel < 3; channel++) {
+                    int difference = clamp(base[channel] + Etc2Format::modifiers[candidate][i], 0, 255) - block[texel][channel];
+                    texel_error += difference * difference;
+                }
+
+                if (texel_error < best_texel_error) {
+                    best_texel_error = texel_error;
+                    candidate_indices[texel] = i;
+                }
+            }
+
+            error += best_texel_error;
+        }
+
+        if (error < best_error) {
+            best_error = error;
+            table = candidate;
+            for (int texel = 0; texel < 16; texel++) {
+                if (etc_in_second_subblock(texel, flip) == (subblock == 1)) {
+                    indices[texel] = candidate_indices[texel];
+                }
+            }
+        }
+    }
+
+    return best_error;
+}
+
+/**
+ * Compress a block's colour with ETC's individual and differential modes, the ones ETC1 shares with ETC2.
+ * Each half of the block gets a base colour and a modifier table, halves split either side by side or top and bottom.
+ */
+static uint64_t encode_etc_colour(int const block[16][4])
+{
+    uint64_t best_error = std::numeric_limits<uint64_t>::max();
+    uint64_t best_word = 0;
+
+    for (int flip = 0; flip < 2; flip++) {
+        float average[2][3] = {};
+        for (int texel = 0; texel < 16; texel++) {
+            int subblock = etc_in_second_subblock(texel, flip) ? 1 : 0;
+            for (int channel = 0; channel < 3; channel++) {
+                average[subblock][channel] += block[texel][channel] / 8.0f;
+            }
+        }
+
+        for (int differential = 0; differential < 2; differential++) {
+            int quantised[2][3];
+            int base[2][3];
+
+            for (int channel = 0; channel < 3; channel++) {
+                if (differential) {
+                    //The second colour is stored as a three bit signed offset from the first
+                    quantised[0][channel] = clamp(static_cast<int>(std::lround(average[0][channel] * 31.0f / 255.0f)), 0, 31);
+                    int second = clamp(static_cast<int>(std::lround(average[1][channel] * 31.0f / 255.0f)), 0, 31);
+                    quantised[1][channel] = quantised[0][channel] + clamp(second - quantised[0][channel], -4, 3);
+
+                    for (int subblock = 0; subblock < 2; subblock++) {
+                        base[subblock][channel] = (quantised[subblock][channel] << 3) | (quantised[subblock][channel] >> 2);
+                    }
+                } else {
+                    for (int subblock = 0; subblock < 2; subblock++) {
+                        quantised[subblock][channel] = clamp(static_cast<int>(std::lround(average[subblock][channel] * 15.0f / 255.0f)), 0, 15);
+                        base[subblock][channel] = (quantised[subblock][channel] << 4) | quantised[subblock][channel];
+                    }
+                }
+            }
+
+            int tables[2];
+            int indices[16];
+            uint64_t error =
+                etc_fit_subblock(block, flip, 0, base[0], tables[0], indices) +
+                etc_fit_subblock(block, flip, 1, base[1], tables[1], indices);
+
+            if (error >= best_error) {
+                continue;
+            }
+
+            uint64_t word = 0;
+            for (int channel = 0; channel < 3; channel++) {
+                int shift = 56 - channel * 8;
+                if (differential) {
+                    word |= static_cast<uint64_t>(quantised[0][channel]) << (shift + 3);
+                    word |= static_cast<uint64_t>((quantised[1][channel] - quantised[0][channel]) & 7) << shift;
+                } else {
+                    word |= static_cast<uint64_t>(quantised[0][channel]) << (shift + 4);
+                    word |= static_cast<uint64_t>(quantised[1][channel]) << shift;
+                }
+            }
+
+            word |= static_cast<uint64_t>(tables[0]) << 37;
+            word |= static_cast<uint64_t>(tables[1]) << 34;
+            word |= static_cast<uint64_t>(differential) << 33;
+            word |= static_cast<uint64_t>(flip) << 32;
+
+            //Index bits are split into planes, texels ordered column by column
+            for (int texel = 0; texel < 16; texel++) {
+                int position = (texel % 4) * 4 + texel / 4;
+                word |= static_cast<uint64_t>(indices[texel] >> 1) << (16 + position);
+                word |= static_cast<uint64_t>(indices[texel] & 1) << position;
+            }
+
+            best_error = error;
+            best_word = word;
+        }
+    }
+
+    return best_word;
+}
+
+/**
+ * Compress a block's alpha with EAC: a base value plus a scaled modifier per texel.
+ */
+static uint64_t encode_eac_alpha(int const block[16][4])
+{
+    int low = 255, high = 0;
+    for (int texel = 0; texel < 16; texel++) {
+        low = std::min(low, block[texel][3]);
+        high = std::max(high, block[texel][3]);
+    }
+
+    //Table 13 has a zero modifier, at index 4, for blocks of a single alpha
+    int best_base = low, best_multiplier = 1, best_table = 13;
+    int indices[16];
+    std::fill(indices, indices + 16, 4);
+
+    if (low != high) {
+        uint64_t best_error = std::numeric_limits<uint64_t>::max();
+
+        for (int table = 0; table < 16; table++) {
+            int smallest = *std::min_element(Etc2Format::alpha_modifiers[table], Etc2Format::alpha_modifiers[table] + 8);
+            int largest = *std::max_element(Etc2Format::alpha_modifiers[table], Etc2Format::alpha_modifiers[table] + 8);
+            int estimate = static_cast<int>(std::lround(static_cast<float>(high - low) / (largest - smallest)));
+
+            for (int multiplier = std::max(estimate - 1, 1); multiplier <= std::min(estimate + 1, 15); multiplier++) {
+                int base = clamp(static_cast<int>(std::lround((low + high) / 2.0f - (smallest + largest) * multiplier / 2.0f)), 0, 255);
+
+                uint64_t error = 0;
+                int candidate_indices[16];
+                for (int texel = 0; texel < 16; texel++) {
+                    int best_texel_error = std::numeric_limits<int>::max();
+                    for (int i = 0; i < 8; i++) {
+                        int difference = clamp(base + Etc2Format::alpha_modifiers[table][i] * multiplier, 0, 255) - block[texel][3];
+                        if (difference * difference < best_texel_error) {
+                            best_texel_error = difference * difference;
+                            candidate_indices[texel] = i;
+                        }
+                    }
+                    error += best_texel_error;
+                }
+
+                if (error < best_error) {
+                    best_error = error;
+                    best_base = base;
+                    best_multiplier = multiplier;
+                    best_table = table;
+                    std::memcpy(indices, candidate_indices, sizeof(candidate_indices));
+                }
+            }
+        }
+    }
+
+    uint64_t word =
+        static_cast<uint64_t>(best_base) << 56 |
+        static_cast<uint64_t>(best_multiplier) << 52 |
+        static_cast<uint64_t>(best_table) << 48;
+
+    //Texels ordered column by column from the top bits down
+    for (int texel = 0; texel < 16; texel++) {
+        int position = (texel % 4) * 4 + texel / 4;
+        word |= static_cast<uint64_t>(indices[texel]) << (45 - position * 3);
+    }
+
+    return word;
+}
+
+void BlockEncoder::encode_bc7(uint8_t const *pixels, uint32_t width, uint32_t height, uint8_t *blocks, uint32_t block_row_pitch)
+{
+    int block[16][4];
+
+    for (uint32_t block_y = 0; block_y < (height + 3) / 4; block_y++) {
+        for (uint32_t block_x = 0; block_x < (width + 3) / 4; block_x++) {
+            load_block(pixels, width, height, block_x, block_y, block);
+            encode_bc7_block(block, blocks + static_cast<uint64_t>(block_y) * block_row_pitch + block_x * 16);
+        }
+    }
+}
+
+void BlockEncoder::encode_etc2_rgba(uint8_t const *pixels, uint32_t width, uint32_t height, uint8_t *blocks, uint32_t block_row_pitch)
+{
+    int block[16][4];
+
+    for (uint32_t block_y = 0; block_y < (height + 3) / 4; block_y++) {
+        for (uint32_t block_x = 0; block_x < (width + 3) / 4; block_x++) {
+            load_block(pixels, width, height, block_x, block_y, block);
+
+            uint8_t *output = blocks + static_cast<uint64_t>(block_y) * block_row_pitch + block_x * 16;
+            write_big_endian(encode_eac_alpha(block), output);
+            write_big_endian(encode_etc_colour(block), output + 8);
+        }
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Animate::Tools
+{
+    /**
+     * Block compressors used by texture-baker.
+     *
+     * Both take tightly packed RGBA8 pixels and write one 16 byte block per 4x4 texels, rows of
+     * blocks block_row_pitch bytes apart. Partial blocks at the right and bottom edges repeat the
+     * last column and row.
+     */
+    namespace BlockEncoder
+    {
+        void encode_bc7(uint8_t const *pixels, uint32_t width, uint32_t height, uint8_t *blocks, uint32_t block_row_pitch);
+        void encode_etc2_rgba(uint8_t const *pixels, uint32_t width, uint32_t height, uint8_t *blocks, uint32_t block_row_pitch);
+    }
+}
@@ -0,0 +1,195 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <cstdlib>
+
+#include "../Animation/Cat/PatternDatabaseFormat.hh"
+
+using namespace Animate::Animation::Cat;
+
+/**
+ * How the tiles of each board size are split into groups.
+ * Larger groups give better estimates but their tables grow with cells^tiles.
+ */
+static std::vector< std::vector<uint8_t> > partition(uint32_t width)
+{
+    switch (width) {
+        case 3:
+            return {{1, 2, 3, 4, 5, 6, 7, 8}};
+        case 4:
+            return {{1, 2, 3, 5, 6}, {4, 7, 8, 11, 12}, {9, 10, 13, 14, 15}};
+        case 5:
+            return {
+                {1, 2, 6, 7}, {3, 4, 8, 9}, {5, 10, 15, 20},
+                {11, 12, 16, 17}, {13, 14, 18, 19}, {21, 22, 23, 24}
+            };
+    }
+
+    throw std::runtime_error("No pattern groups for a width of " + std::to_string(width) + ".");
+}
+
+/**
+ * The inverse of PatternDatabaseFormat::rank.
+ */
+static void unrank(uint64_t index, uint32_t count, uint32_t cells, uint8_t *positions)
+{
+    uint32_t digits[PatternDatabaseFormat::max_group_tiles];
+    for (uint32_t i = count; i-- > 0;) {
+        digits[i] = static_cast<uint32_t>(index % (cells - i));
+        index /= cells - i;
+    }
+
+    bool occupied[256] = {};
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t cell = 0;
+        for (uint32_t free = 0;; cell++) {
+            if (!occupied[cell] && free++ == digits[i]) {
+                break;
+            }
+        }
+        positions[i] = static_cast<uint8_t>(cell);
+        occupied[cell] = true;
+    }
+}
+
+/**
+ * Fewest moves of a group's tiles to bring them home from every placement.
+ *
+ * A 0-1 breadth first search from the solved board over the group's cells and the blank's,
+ * where the blank swapping with a tile outside the group is free.
+ */
+static std::vector<uint8_t> build_group(std::vector<uint8_t> const& tiles, uint32_t width)
+{
+    uint32_t cells = width * width;
+    uint32_t count = static_cast<uint32_t>(tiles.size());
+    uint64_t placements = PatternDatabaseFormat::placements(count, cells);
+
+    //Distance to each placement and blank cell
+    std::vector<uint8_t> distances(placements * cells, 255);
+    std::deque<uint64_t> open;
+
+    uint8_t positions[PatternDatabaseFormat::max_group_tiles];
+    for (uint32_t i = 0; i < count; i++) {
+        positions[i] = static_cast<uint8_t>(tiles[i] - 1);
+    }
+
+    uint64_t start = PatternDatabaseFormat::rank(positions, count, cells) * cells + cells - 1;
+    distances[start] = 0;
+    open.push_back(start);
+
+    int offsets[4][2] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+
+    while (!open.empty()) {
+        uint64_t state = open.front();
+        open.pop_front();
+
+        uint8_t distance = distances[state];
+        uint32_t blank = static_cast<uint32_t>(state % cells);
+        unrank(state / cells, count, cells, positions);
+
+        for (auto const& offset : offsets) {
+            int x = static_cast<int>(blank % width) + offset[0];
+            int y = static_cast<int>(blank / width) + offset[1];
+            if (x < 0 || y < 0 || x >= static_cast<int>(width) || y >= static_cast<int>(width)) {
+                continue;
+            }
+
+            uint32_t cell = static_cast<uint32_t>(y) * width + static_cast<uint32_t>(x);
+
+            uint8_t moved[PatternDatabaseFormat::max_group_tiles];
+            std::memcpy(moved, positions, count);
+
+            uint8_t cost = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                if (moved[i] == cell) {
+                    moved[i] = static_cast<uint8_t>(blank);
+                    cost = 1;
+                }
+            }
+
+            uint64_t next = PatternDatabaseFormat::rank(moved, count, cells) * cells + cell;
+            if (distances[next] <= distance + cost) {
+                continue;
+            }
+
+            distances[next] = static_cast<uint8_t>(distance + cost);
+            if (cost == 0) {
+                open.push_front(next);
+            } else {
+                open.push_back(next);
+            }
+        }
+    }
+
+    //Wherever the blank is
+    std::vector<uint8_t> table(placements, 255);
+    for (uint64_t placement = 0; placement < placements; placement++) {
+        for (uint32_t blank = 0; blank < cells; blank++) {
+            table[placement] = std::min(table[placement], distances[placement * cells + blank]);
+        }
+    }
+
+    return table;
+}
+
+static std::vector<uint8_t> build(uint32_t width)
+{
+    std::vector< std::vector<uint8_t> > groups = partition(width);
+
+    PatternDatabaseFormat::Header header = {};
+    std::memcpy(header.magic, PatternDatabaseFormat::magic, sizeof(header.magic));
+    header.version = PatternDatabaseFormat::version;
+    header.width = width;
+    header.group_count = static_cast<uint32_t>(groups.size());
+
+    std::vector<uint8_t> output(sizeof(header) + sizeof(PatternDatabaseFormat::Group) * groups.size());
+    std::memcpy(output.data(), &header, sizeof(header));
+
+    for (size_t i = 0; i < groups.size(); i++) {
+        std::vector<uint8_t> table = build_group(groups[i], width);
+
+        PatternDatabaseFormat::Group group = {};
+        group.tile_count = static_cast<uint32_t>(groups[i].size());
+        std::memcpy(group.tiles, groups[i].data(), groups[i].size());
+        group.offset = output.size();
+        group.size = table.size();
+
+        std::memcpy(output.data() + sizeof(header) + sizeof(group) * i, &group, sizeof(group));
+        output.insert(output.end(), table.begin(), table.end());
+    }
+
+    return output;
+}
+
+/**
+ * Build the pattern databases for a board size.
+ *
+ * Usage: pattern-db-builder <width> <output file>
+ */
+int main(int argc, char **argv)
+{
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <width> <output file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        std::vector<uint8_t> output = build(static_cast<uint32_t>(std::atoi(argv[1])));
+
+        std::ofstream file(argv[2], std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<char const *>(output.data()), output.size());
+        if (!file) {
+            throw std::runtime_error(std::string("Couldn't write: ") + argv[2]);
+        }
+    } catch (std::runtime_error const& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <queue>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <cstdlib>
+
+#include "../Animation/Cat/Search.hh"
+#include "../Animation/Cat/PatternDatabase.hh"
+#include "../Animation/Cat/TranspositionTable.hh"
+#include "../Tasks/ThreadPool.hh"
+
+using namespace Animate;
+using namespace Animate::Animation::Cat;
+
+/**
+ * Random solvable boards, the same ones every run.
+ */
+static std::vector< std::vector<uint8_t> > generate_boards(int grid_size, size_t count)
+{
+    std::mt19937 generator(1);
+    std::vector< std::vector<uint8_t> > boards;
+
+    while (boards.size() < count) {
+        std::vector<uint8_t> board(grid_size * grid_size);
+        for (size_t i = 0; i < board.size(); i++) {
+            board[i] = static_cast<uint8_t>(i);
+        }
+
+        std::shuffle(board.begin(), board.end(), generator);
+        if (Search::is_solvable(board, grid_size)) {
+            boards.push_back(board);
+        }
+    }
+
+    return boards;
+}
+
+/**
+ * Solve every board with some number of threads.
+ *
+ * @param lengths Where each solution's length is written.
+ *
+ * @return Seconds taken.
+ */
+static double run(
+    std::vector< std::vector<uint8_t> > const& boards,
+    PatternDatabase const& database,
+    size_t thread_count,
+    std::vector<size_t> &lengths
+) {
+    //The calling thread searches too
+    std::unique_ptr<Tasks::ThreadPool> thread_pool;
+    if (thread_count > 1) {
+        thread_pool = std::make_unique<Tasks::ThreadPool>(thread_count - 1);
+    }
+
+    TranspositionTable table;
+    std::atomic_bool cancelled = false;
+    lengths.clear();
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::vector<uint8_t> const& board : boards) {
+        std::queue<TaquinSolve::Moves> move_sequence;
+        bool solved = Search::solve_optimal(
+            board,
+            database.get_width(),
+            &database,
+            std::chrono::steady_clock::time_point::max(),
+            cancelled,
+            move_sequence,
+            thread_pool.get(),
+            &table
+        );
+
+        if (!solved) {
+            throw std::runtime_error("Board wasn't solved.");
+        }
+        lengths.push_back(move_sequence.size());
+    }
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Times optimal Cat solves with 1, 2, 4... threads to show how the search scales.
+ *
+ * Usage: search-bench <pattern database file> [boards] [max threads]
+ */
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <pattern database file> [boards] [max threads]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    size_t board_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+    size_t max_threads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : std::thread::hardware_concurrency();
+
+    try {
+        std::ifstream file(argv[1], std::ios::binary);
+        if (!file) {
+            throw std::runtime_error(std::string("Couldn't read: ") + argv[1]);
+        }
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        PatternDatabase database(data.data(), data.size());
+        std::vector< std::vector<uint8_t> > boards = generate_boards(database.get_width(), board_count);
+
+        std::cout << board_count << " " << database.get_width() << "x" << database.get_width() << " boards" << std::endl;
+        std::cout << "threads  seconds  speedup" << std::endl;
+
+        std::vector<size_t> expected_lengths;
+        double single_thread = 0;
+
+        for (size_t thread_count = 1; thread_count <= std::max<size_t>(max_threads, 1); thread_count *= 2) {
+            std::vector<size_t> lengths;
+            double seconds = run(boards, database, thread_count, lengths);
+
+            if (thread_count == 1) {
+                expected_lengths = lengths;
+                single_thread = seconds;
+            } else if (lengths != expected_lengths) {
+                throw std::runtime_error("Solutions differ in length between thread counts.");
+            }
+
+            std::cout << std::setw(7) << thread_count << "  "
+                      << std::setw(7) << std::fixed << std::setprecision(3) << seconds << "  "
+                      << std::setw(7) << std::setprecision(2) << single_thread / seconds << std::endl;
+        }
+    } catch (std::runtime_error const& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
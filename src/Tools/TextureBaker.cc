@@ -0,0 +1,184 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+
+#include "../VK/TextureContainer.hh"
+#include "BlockEncoder.hh"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../libs/stb_image.h"
+
+using namespace Animate::VK;
+using namespace Animate::Tools;
+
+/**
+ * An uncompressed RGBA8 image.
+ */
+struct Image {
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> pixels;
+};
+
+/**
+ * Halve an image with a box filter, odd edges reuse their last row or column.
+ */
+static Image downsample(Image const& source)
+{
+    Image result;
+    result.width = std::max<uint32_t>(source.width / 2, 1);
+    result.height = std::max<uint32_t>(source.height / 2, 1);
+    result.pixels.resize(result.width * result.height * 4);
+
+    for (uint32_t y = 0; y < result.height; y++) {
+        uint32_t y0 = std::min(y * 2, source.height - 1);
+        uint32_t y1 = std::min(y * 2 + 1, source.height - 1);
+
+        for (uint32_t x = 0; x < result.width; x++) {
+            uint32_t x0 = std::min(x * 2, source.width - 1);
+            uint32_t x1 = std::min(x * 2 + 1, source.width - 1);
+
+            for (uint32_t channel = 0; channel < 4; channel++) {
+                uint32_t sum =
+                    source.pixels[(y0 * source.width + x0) * 4 + channel] +
+                    source.pixels[(y0 * source.width + x1) * 4 + channel] +
+                    source.pixels[(y1 * source.width + x0) * 4 + channel] +
+                    source.pixels[(y1 * source.width + x1) * 4 + channel];
+
+                result.pixels[(y * result.width + x) * 4 + channel] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * A block compressed encoding written for every image.
+ */
+struct Encoding {
+    TextureContainer::Format format;
+    void (*encode)(uint8_t const *pixels, uint32_t width, uint32_t height, uint8_t *blocks, uint32_t block_row_pitch);
+};
+
+//In order of preference, BC7 for desktop GPUs, ETC2 for mobile ones and for decoding on the CPU
+static const Encoding encodings[] = {
+    {TextureContainer::BC7_UNORM, BlockEncoder::encode_bc7},
+    {TextureContainer::ETC2_RGBA8_UNORM, BlockEncoder::encode_etc2_rgba}
+};
+
+static const uint32_t block_size = 4;
+static const uint32_t bytes_per_block = 16;
+
+/**
+ * Decode an image file and write it as a texture container with a full mip chain in each encoding.
+ */
+static std::vector<uint8_t> bake(std::string const& path)
+{
+    int width, height, channels;
+    stbi_uc *pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        throw std::runtime_error("Couldn't load image: " + path + " (" + stbi_failure_reason() + ")");
+    }
+
+    std::vector<Image> levels(1);
+    levels[0].width = static_cast<uint32_t>(width);
+    levels[0].height = static_cast<uint32_t>(height);
+    levels[0].pixels.assign(pixels, pixels + width * height * 4);
+    stbi_image_free(pixels);
+
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        levels.push_back(downsample(levels.back()));
+    }
+
+    uint32_t variant_count = sizeof(encodings) / sizeof(Encoding);
+
+    TextureContainer::Header header = {};
+    std::memcpy(header.magic, TextureContainer::magic, 4);
+    header.version = TextureContainer::version;
+    header.width = levels[0].width;
+    header.height = levels[0].height;
+    header.mip_levels = levels.size();
+    header.variant_count = variant_count;
+
+    std::vector<TextureContainer::Variant> variants(variant_count);
+    std::vector<TextureContainer::Mip> mips(variant_count * levels.size());
+    uint64_t offset = TextureContainer::mip_offset(header, variant_count, 0);
+
+    for (uint32_t variant = 0; variant < variant_count; variant++) {
+        variants[variant] = {};
+        variants[variant].format = encodings[variant].format;
+        variants[variant].block_width = block_size;
+        variants[variant].block_height = block_size;
+        variants[variant].bytes_per_block = bytes_per_block;
+
+        for (size_t i = 0; i < levels.size(); i++) {
+            uint32_t blocks_wide = (levels[i].width + block_size - 1) / block_size;
+            uint32_t blocks_high = (levels[i].height + block_size - 1) / block_size;
+
+            offset = TextureContainer::align(offset, TextureContainer::level_alignment);
+
+            TextureContainer::Mip &mip = mips[variant * levels.size() + i];
+            mip = {};
+            mip.width = levels[i].width;
+            mip.height = levels[i].height;
+            mip.row_pitch = TextureContainer::align(blocks_wide * bytes_per_block, TextureContainer::row_pitch_alignment);
+            mip.offset = offset;
+            mip.size = static_cast<uint64_t>(mip.row_pitch) * blocks_high;
+
+            offset += mip.size;
+        }
+    }
+
+    std::vector<uint8_t> output(offset, 0);
+    std::memcpy(output.data(), &header, sizeof(TextureContainer::Header));
+    std::memcpy(output.data() + sizeof(TextureContainer::Header), variants.data(), sizeof(TextureContainer::Variant) * variants.size());
+    std::memcpy(output.data() + TextureContainer::mip_offset(header, 0, 0), mips.data(), sizeof(TextureContainer::Mip) * mips.size());
+
+    for (uint32_t variant = 0; variant < variant_count; variant++) {
+        for (size_t i = 0; i < levels.size(); i++) {
+            TextureContainer::Mip const& mip = mips[variant * levels.size() + i];
+            encodings[variant].encode(
+                levels[i].pixels.data(),
+                levels[i].width,
+                levels[i].height,
+                output.data() + mip.offset,
+                mip.row_pitch
+            );
+        }
+    }
+
+    return output;
+}
+
+/**
+ * Bake an image into a GPU ready texture container.
+ *
+ * Usage: texture-baker <input image> <output file>
+ */
+int main(int argc, char **argv)
+{
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <input image> <output file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        std::vector<uint8_t> output = bake(argv[1]);
+
+        std::ofstream file(argv[2], std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<char const *>(output.data()), output.size());
+        if (!file) {
+            throw std::runtime_error(std::string("Couldn't write: ") + argv[2]);
+        }
+    } catch (std::runtime_error const& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -3,24 +3,25 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <sys/time.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <errno.h>
 
 #include "Utilities.hh"
 #include "Resources.hh"
 
 using namespace Animate;
 
-const uint8_t * Utilities::get_resource_as_bytes(std::string key, size_t *size)
+/**
+ * Fetch an embedded resource.
+ *
+ * @param key The resource's path, as listed in resources.json.
+ *
+ * @return A view of the resource's bytes, nothing is copied.
+ */
+ResourceSpan Utilities::get_resource_as_bytes(std::string const& key)
 {
-    auto search = Resources::resources.find(key);
-
-    if (search == Resources::resources.end()) {
-        throw std::runtime_error("Resource not found: " + key);
-    }
-
-    if (size != nullptr) {
-        *size = search->second.size();
-    }
-    return search->second.data();
+    return Resources::get(key);
 }
 
 uint64_t Utilities::get_micro_time()
@@ -29,3 +30,38 @@ uint64_t Utilities::get_micro_time()
     gettimeofday(&time, NULL);
     return ((uint64_t)time.tv_sec * 1000000) + time.tv_usec;
 }
+
+/**
+ * Get the directory to keep cached data in, creating it if needed.
+ * Follows the XDG base directory spec, falling back to ~/.cache.
+ *
+ * @return The directory path, or an empty string if there's nowhere to write.
+ */
+std::string Utilities::get_cache_directory()
+{
+    std::string base;
+    char const *xdg_cache_home = getenv("XDG_CACHE_HOME");
+    char const *home = getenv("HOME");
+
+    if (xdg_cache_home != nullptr && xdg_cache_home[0] == '/') {
+        base = xdg_cache_home;
+    } else if (home != nullptr && home[0] != '\0') {
+        base = std::string(home) + "/.cache";
+    } else {
+        return "";
+    }
+
+    std::string directory = base + "/animate";
+
+    //Create each missing component in turn
+    for (size_t i = 1; i <= directory.size(); i++) {
+        if (i == directory.size() || directory[i] == '/') {
+            std::string component = directory.substr(0, i);
+            if (mkdir(component.c_str(), 0755) != 0 && errno != EEXIST) {
+                return "";
+            }
+        }
+    }
+
+    return directory;
+}
@@ -2,12 +2,15 @@
 
 #include <string>
 
+#include "Resources.hh"
+
 namespace Animate
 {
     class Utilities
     {
         public:
-            static const uint8_t * get_resource_as_bytes(std::string key, size_t *size = nullptr);
+            static ResourceSpan get_resource_as_bytes(std::string const& key);
             static uint64_t get_micro_time();
+            static std::string get_cache_directory();
     };
 }
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "AtlasPacker.hh"
+
+using namespace Animate::VK;
+
+/**
+ * Constructor.
+ *
+ * @param page_size   The width and height of every page.
+ * @param granularity Rectangles are placed and sized in multiples of this.
+ */
+AtlasPacker::AtlasPacker(uint32_t page_size, uint32_t granularity) : page_size(page_size), granularity(granularity)
+{
+    if (granularity == 0 || page_size % granularity != 0) {
+        throw std::runtime_error("Atlas page size must be a multiple of the granularity.");
+    }
+}
+
+/**
+ * Place a rectangle on the first page it fits, opening a new page if none do.
+ *
+ * @param width  The rectangle's width in texels.
+ * @param height The rectangle's height in texels.
+ *
+ * @return Where it was placed, with its size as given.
+ */
+AtlasRect AtlasPacker::add(uint32_t width, uint32_t height)
+{
+    uint32_t cell_width = (width + this->granularity - 1) / this->granularity;
+    uint32_t cell_height = (height + this->granularity - 1) / this->granularity;
+    uint32_t page_cells = this->page_size / this->granularity;
+
+    if (cell_width > page_cells || cell_height > page_cells || width == 0 || height == 0) {
+        throw std::runtime_error("Rectangle doesn't fit on an atlas page.");
+    }
+
+    size_t index;
+    uint32_t y;
+    uint32_t page = 0;
+    for (; page < this->pages.size(); page++) {
+        if (this->find_position(this->pages[page], cell_width, cell_height, index, y)) {
+            break;
+        }
+    }
+
+    if (page == this->pages.size()) {
+        this->pages.push_back({{0, 0, page_cells}});
+        index = 0;
+        y = 0;
+    }
+
+    uint32_t x = this->pages[page][index].x;
+    this->place(this->pages[page], index, cell_width, cell_height, y);
+
+    return {page, x * this->granularity, y * this->granularity, width, height};
+}
+
+uint32_t AtlasPacker::get_page_count() const
+{
+    return this->pages.size();
+}
+
+uint32_t AtlasPacker::get_page_size() const
+{
+    return this->page_size;
+}
+
+/**
+ * Find the lowest place on a skyline a rectangle fits, leftmost on ties.
+ *
+ * @param skyline The page's skyline.
+ * @param width   The rectangle's width in cells.
+ * @param height  The rectangle's height in cells.
+ * @param index   Set to the segment the rectangle's left edge sits on.
+ * @param y       Set to the height the rectangle sits at.
+ *
+ * @return Whether it fits anywhere.
+ */
+bool AtlasPacker::find_position(std::vector<Segment> const& skyline, uint32_t width, uint32_t height, size_t &index, uint32_t &y) const
+{
+    uint32_t page_cells = this->page_size / this->granularity;
+    uint32_t best_y = std::numeric_limits<uint32_t>::max();
+
+    for (size_t i = 0; i < skyline.size(); i++) {
+        if (skyline[i].x + width > page_cells) {
+            break;
+        }
+
+        //Rest on the highest segment under the rectangle
+        uint32_t top = 0;
+        uint32_t covered = 0;
+        for (size_t j = i; covered < width; j++) {
+            top = std::max(top, skyline[j].y);
+            covered = skyline[j].x + skyline[j].width - skyline[i].x;
+        }
+
+        if (top + height <= page_cells && top < best_y) {
+            best_y = top;
+            index = i;
+        }
+    }
+
+    y = best_y;
+    return best_y != std::numeric_limits<uint32_t>::max();
+}
+
+/**
+ * Raise the skyline under a newly placed rectangle.
+ */
+void AtlasPacker::place(std::vector<Segment> &skyline, size_t index, uint32_t width, uint32_t height, uint32_t y)
+{
+    uint32_t x = skyline[index].x;
+    skyline.insert(skyline.begin() + index, {x, y + height, width});
+
+    //Trim the segments now underneath it
+    for (size_t i = index + 1; i < skyline.size();) {
+        uint32_t end = x + width;
+        if (skyline[i].x >= end) {
+            break;
+        }
+
+        uint32_t overlap = std::min(end - skyline[i].x, skyline[i].width);
+        skyline[i].x += overlap;
+        skyline[i].width -= overlap;
+
+        if (skyline[i].width == 0) {
+            skyline.erase(skyline.begin() + i);
+        } else {
+            break;
+        }
+    }
+
+    //Merge neighbours at the same height
+    for (size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else {
+            i++;
+        }
+    }
+}
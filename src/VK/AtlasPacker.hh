@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Animate::VK
+{
+    /**
+     * A rectangle placed on an atlas page, in texels.
+     */
+    struct AtlasRect {
+        uint32_t page;
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    /**
+     * Packs rectangles onto square pages with the skyline bottom-left heuristic.
+     * Positions and sizes are rounded up to the granularity so the mip levels of packed images line up.
+     */
+    class AtlasPacker
+    {
+        public:
+            AtlasPacker(uint32_t page_size, uint32_t granularity);
+
+            AtlasRect add(uint32_t width, uint32_t height);
+
+            uint32_t get_page_count() const;
+            uint32_t get_page_size() const;
+
+        private:
+            //A horizontal segment of a page's skyline, in units of the granularity
+            struct Segment {
+                uint32_t x;
+                uint32_t y;
+                uint32_t width;
+            };
+
+            uint32_t page_size;
+            uint32_t granularity;
+            std::vector< std::vector<Segment> > pages;
+
+            bool find_position(std::vector<Segment> const& skyline, uint32_t width, uint32_t height, size_t &index, uint32_t &y) const;
+            void place(std::vector<Segment> &skyline, size_t index, uint32_t width, uint32_t height, uint32_t y);
+    };
+}
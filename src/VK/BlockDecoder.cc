@@ -0,0 +1,222 @@
+#include <algorithm>
+
+#include "BlockDecoder.hh"
+#include "Etc2Format.hh"
+
+using namespace Animate::VK;
+
+static int clamp_byte(int value)
+{
+    return std::min(std::max(value, 0), 255);
+}
+
+static uint64_t read_big_endian(uint8_t const *input)
+{
+    uint64_t word = 0;
+    for (int i = 0; i < 8; i++) {
+        word = (word << 8) | input[i];
+    }
+    return word;
+}
+
+static uint32_t bits(uint64_t word, int high, int low)
+{
+    return static_cast<uint32_t>((word >> low) & ((1ull << (high - low + 1)) - 1));
+}
+
+static int extend_4(uint32_t value)
+{
+    return static_cast<int>((value << 4) | value);
+}
+
+static int extend_5(uint32_t value)
+{
+    return static_cast<int>((value << 3) | (value >> 2));
+}
+
+static int extend_6(uint32_t value)
+{
+    return static_cast<int>((value << 2) | (value >> 4));
+}
+
+static int extend_7(uint32_t value)
+{
+    return static_cast<int>((value << 1) | (value >> 6));
+}
+
+/**
+ * Sign extend a three bit offset.
+ */
+static int offset_3(uint32_t value)
+{
+    return value >= 4 ? static_cast<int>(value) - 8 : static_cast<int>(value);
+}
+
+/**
+ * Decode an ETC2 colour block, indexed by texel row by row, leaving alpha alone.
+ */
+static void decode_etc2_colour(uint64_t word, uint8_t texels[16][4])
+{
+    //Texels' two bit indices are split into planes, ordered column by column
+    auto index = [word](int texel) {
+        int position = (texel % 4) * 4 + texel / 4;
+        return static_cast<int>(((word >> (16 + position)) & 1) << 1 | ((word >> position) & 1));
+    };
+
+    auto set = [&texels](int texel, int red, int green, int blue) {
+        texels[texel][0] = static_cast<uint8_t>(clamp_byte(red));
+        texels[texel][1] = static_cast<uint8_t>(clamp_byte(green));
+        texels[texel][2] = static_cast<uint8_t>(clamp_byte(blue));
+    };
+
+    bool differential = bits(word, 33, 33);
+    bool flip = bits(word, 32, 32);
+
+    int base[2][3];
+    if (!differential) {
+        for (int channel = 0; channel < 3; channel++) {
+            base[0][channel] = extend_4(bits(word, 63 - channel * 8, 60 - channel * 8));
+            base[1][channel] = extend_4(bits(word, 59 - channel * 8, 56 - channel * 8));
+        }
+    } else {
+        int first[3], second[3];
+        for (int channel = 0; channel < 3; channel++) {
+            first[channel] = static_cast<int>(bits(word, 63 - channel * 8, 59 - channel * 8));
+            second[channel] = first[channel] + offset_3(bits(word, 58 - channel * 8, 56 - channel * 8));
+        }
+
+        //An out of range second colour selects one of the modes ETC2 added
+        if (second[0] < 0 || second[0] > 31) {
+            //T: one lone colour and three around another
+            int colours[2][3] = {
+                {extend_4(bits(word, 60, 59) << 2 | bits(word, 57, 56)), extend_4(bits(word, 55, 52)), extend_4(bits(word, 51, 48))},
+                {extend_4(bits(word, 47, 44)), extend_4(bits(word, 43, 40)), extend_4(bits(word, 39, 36))}
+            };
+            int distance = Etc2Format::distances[bits(word, 35, 34) << 1 | bits(word, 32, 32)];
+            int offsets[4] = {0, distance, 0, -distance};
+
+            for (int texel = 0; texel < 16; texel++) {
+                int i = index(texel);
+                int const *colour = colours[i == 0 ? 0 : 1];
+                set(texel, colour[0] + offsets[i], colour[1] + offsets[i], colour[2] + offsets[i]);
+            }
+            return;
+        }
+
+        if (second[1] < 0 || second[1] > 31) {
+            //H: two colours, each with two shades
+            uint32_t packed[2][3] = {
+                {bits(word, 62, 59), bits(word, 58, 56) << 1 | bits(word, 52, 52), bits(word, 51, 51) << 3 | bits(word, 49, 47)},
+                {bits(word, 46, 43), bits(word, 42, 39), bits(word, 38, 35)}
+            };
+            uint32_t order[2] = {
+                packed[0][0] << 8 | packed[0][1] << 4 | packed[0][2],
+                packed[1][0] << 8 | packed[1][1] << 4 | packed[1][2]
+            };
+            int distance = Etc2Format::distances[bits(word, 34, 34) << 2 | bits(word, 32, 32) << 1 | (order[0] >= order[1] ? 1 : 0)];
+
+            for (int texel = 0; texel < 16; texel++) {
+                int i = index(texel);
+                uint32_t const *colour = packed[i / 2];
+                int offset = (i % 2) ? -distance : distance;
+                set(texel, extend_4(colour[0]) + offset, extend_4(colour[1]) + offset, extend_4(colour[2]) + offset);
+            }
+            return;
+        }
+
+        if (second[2] < 0 || second[2] > 31) {
+            //Planar: a gradient through three corner colours
+            int origin[3] = {
+                extend_6(bits(word, 62, 57)),
+                extend_7(bits(word, 56, 56) << 6 | bits(word, 54, 49)),
+                extend_6(bits(word, 48, 48) << 5 | bits(word, 44, 43) << 3 | bits(word, 41, 39))
+            };
+            int horizontal[3] = {
+                extend_6(bits(word, 38, 34) << 1 | bits(word, 32, 32)),
+                extend_7(bits(word, 31, 25)),
+                extend_6(bits(word, 24, 19))
+            };
+            int vertical[3] = {
+                extend_6(bits(word, 18, 13)),
+                extend_7(bits(word, 12, 6)),
+                extend_6(bits(word, 5, 0))
+            };
+
+            for (int texel = 0; texel < 16; texel++) {
+                int x = texel % 4, y = texel / 4;
+                int colour[3];
+                for (int channel = 0; channel < 3; channel++) {
+                    colour[channel] = (
+                        x * (horizontal[channel] - origin[channel]) +
+                        y * (vertical[channel] - origin[channel]) +
+                        4 * origin[channel] + 2
+                    ) >> 2;
+                }
+                set(texel, colour[0], colour[1], colour[2]);
+            }
+            return;
+        }
+
+        for (int channel = 0; channel < 3; channel++) {
+            base[0][channel] = extend_5(first[channel]);
+            base[1][channel] = extend_5(second[channel]);
+        }
+    }
+
+    //Individual and differential: each half of the block has a base colour and modifier table
+    int tables[2] = {static_cast<int>(bits(word, 39, 37)), static_cast<int>(bits(word, 36, 34))};
+    for (int texel = 0; texel < 16; texel++) {
+        int subblock = (flip ? texel / 4 : texel % 4) >= 2 ? 1 : 0;
+        int modifier = Etc2Format::modifiers[tables[subblock]][index(texel)];
+        set(texel, base[subblock][0] + modifier, base[subblock][1] + modifier, base[subblock][2] + modifier);
+    }
+}
+
+/**
+ * Decode an EAC alpha block into the texels' alpha.
+ */
+static void decode_eac_alpha(uint64_t word, uint8_t texels[16][4])
+{
+    int base = static_cast<int>(bits(word, 63, 56));
+    int multiplier = static_cast<int>(bits(word, 55, 52));
+    int const *modifiers = Etc2Format::alpha_modifiers[bits(word, 51, 48)];
+
+    for (int texel = 0; texel < 16; texel++) {
+        int position = (texel % 4) * 4 + texel / 4;
+        int i = static_cast<int>(bits(word, 47 - position * 3, 45 - position * 3));
+        texels[texel][3] = static_cast<uint8_t>(clamp_byte(base + modifiers[i] * multiplier));
+    }
+}
+
+/**
+ * Decode ETC2 RGBA8 blocks to RGBA8 texels.
+ *
+ * @param blocks          The first row of blocks.
+ * @param block_row_pitch Bytes between rows of blocks.
+ * @param width           Width of the image in texels.
+ * @param height          Height of the image in texels.
+ * @param pixels          Where the first row of texels is written.
+ * @param row_pitch       Bytes between rows of texels.
+ */
+void BlockDecoder::decode_etc2_rgba(uint8_t const *blocks, uint32_t block_row_pitch, uint32_t width, uint32_t height, uint8_t *pixels, uint32_t row_pitch)
+{
+    uint8_t texels[16][4];
+
+    for (uint32_t block_y = 0; block_y < (height + 3) / 4; block_y++) {
+        for (uint32_t block_x = 0; block_x < (width + 3) / 4; block_x++) {
+            uint8_t const *block = blocks + static_cast<uint64_t>(block_y) * block_row_pitch + block_x * 16;
+            decode_eac_alpha(read_big_endian(block), texels);
+            decode_etc2_colour(read_big_endian(block + 8), texels);
+
+            //Partial blocks at the edges only write the texels inside the image
+            uint32_t columns = std::min(4u, width - block_x * 4);
+            uint32_t rows = std::min(4u, height - block_y * 4);
+            for (uint32_t y = 0; y < rows; y++) {
+                uint8_t *row = pixels + static_cast<uint64_t>(block_y * 4 + y) * row_pitch + block_x * 16;
+                for (uint32_t x = 0; x < columns; x++) {
+                    std::copy(texels[y * 4 + x], texels[y * 4 + x] + 4, row + x * 4);
+                }
+            }
+        }
+    }
+}
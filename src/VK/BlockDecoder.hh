@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Animate::VK
+{
+    /**
+     * Decodes baked ETC2 textures to RGBA8 on devices that can sample neither ETC2 nor BC7.
+     */
+    namespace BlockDecoder
+    {
+        void decode_etc2_rgba(uint8_t const *blocks, uint32_t block_row_pitch, uint32_t width, uint32_t height, uint8_t *pixels, uint32_t row_pitch);
+    }
+}
@@ -4,6 +4,8 @@
 #include <vulkan/vulkan.hpp>
 #include <GLFW/glfw3.h>
 
+#include <atomic>
+
 #include "Context.hh"
 
 using namespace Animate::VK;
@@ -53,7 +55,7 @@ namespace Animate::VK
             vk::DeviceSize size;
             vk::BufferUsageFlags usage;
 
-            static uint64_t id_counter;
+            static std::atomic<uint64_t> id_counter;
             uint64_t id;
     };
 }
@@ -0,0 +1,455 @@
+#include <iostream>
+
+#include "ComputePipeline.hh"
+#include "Context.hh"
+#include "../Utilities.hh"
+
+using namespace Animate::VK;
+
+/**
+ * Constructor.
+ *
+ * @param context The graphics context.
+ * @param compute_code_id Resource id of the compute shader.
+ * @param push_constant_size Size of the shader's push constant block.
+ */
+ComputePipeline::ComputePipeline(
+    std::weak_ptr<Context> context,
+    std::string compute_code_id,
+    uint32_t push_constant_size
+) : context(context), compute_code_id(compute_code_id), push_constants(push_constant_size, 0)
+{
+    this->logical_device = context.lock()->logical_device;
+    this->load_shader();
+    this->create_descriptor_set();
+    this->create_pipeline();
+    this->create_sampler();
+    this->create_query_pool();
+}
+
+/**
+ * Destructor.
+ */
+ComputePipeline::~ComputePipeline()
+{
+    this->logical_device.waitIdle();
+
+    this->destroy_image();
+
+    if (this->query_pool) {
+        this->logical_device.destroyQueryPool(this->query_pool, nullptr);
+    }
+
+    if (this->sampler) {
+        this->logical_device.destroySampler(this->sampler, nullptr);
+    }
+
+    if (this->pipeline) {
+        this->logical_device.destroyPipeline(this->pipeline, nullptr);
+    }
+
+    if (this->pipeline_layout) {
+        this->logical_device.destroyPipelineLayout(this->pipeline_layout, nullptr);
+    }
+
+    if (this->descriptor_pool) {
+        this->logical_device.destroyDescriptorPool(this->descriptor_pool, nullptr);
+    }
+
+    if (this->descriptor_set_layout) {
+        this->logical_device.destroyDescriptorSetLayout(this->descriptor_set_layout, nullptr);
+    }
+
+    if (this->shader_module) {
+        this->logical_device.destroyShaderModule(this->shader_module, nullptr);
+    }
+}
+
+void ComputePipeline::load_shader()
+{
+    ResourceSpan code = Utilities::get_resource_as_bytes(this->compute_code_id);
+
+    vk::ShaderModuleCreateInfo shader_module_create_info = vk::ShaderModuleCreateInfo()
+        .setCodeSize(code.size)
+        .setPCode(reinterpret_cast<const uint32_t*>(code.data));
+
+    if (this->logical_device.createShaderModule(&shader_module_create_info, nullptr, &this->shader_module) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create shader module.");
+    }
+
+    std::cout << "Loaded shader: " << this->compute_code_id << std::endl;
+}
+
+void ComputePipeline::create_descriptor_set()
+{
+    vk::DescriptorSetLayoutBinding image_layout_binding = vk::DescriptorSetLayoutBinding()
+        .setBinding(0)
+        .setDescriptorCount(1)
+        .setDescriptorType(vk::DescriptorType::eStorageImage)
+        .setStageFlags(vk::ShaderStageFlagBits::eCompute);
+
+    vk::DescriptorSetLayoutCreateInfo set_layout_create_info = vk::DescriptorSetLayoutCreateInfo()
+        .setBindingCount(1)
+        .setPBindings(&image_layout_binding);
+
+    if (this->logical_device.createDescriptorSetLayout(&set_layout_create_info, nullptr, &this->descriptor_set_layout) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create compute descriptor set layout.");
+    }
+
+    vk::DescriptorPoolSize pool_size = vk::DescriptorPoolSize()
+        .setType(vk::DescriptorType::eStorageImage)
+        .setDescriptorCount(1);
+
+    vk::DescriptorPoolCreateInfo pool_create_info = vk::DescriptorPoolCreateInfo()
+        .setPoolSizeCount(1)
+        .setPPoolSizes(&pool_size)
+        .setMaxSets(1);
+
+    if (this->logical_device.createDescriptorPool(&pool_create_info, nullptr, &this->descriptor_pool) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create compute descriptor pool.");
+    }
+
+    vk::DescriptorSetAllocateInfo allocation_info = vk::DescriptorSetAllocateInfo()
+        .setDescriptorPool(this->descriptor_pool)
+        .setDescriptorSetCount(1)
+        .setPSetLayouts(&this->descriptor_set_layout);
+
+    vk::Result result = this->logical_device.allocateDescriptorSets(&allocation_info, &this->descriptor_set);
+    if (result != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create compute descriptor set: " + vk::to_string(result));
+    }
+}
+
+void ComputePipeline::create_pipeline()
+{
+    vk::PushConstantRange push_constant_range = vk::PushConstantRange()
+        .setStageFlags(vk::ShaderStageFlagBits::eCompute)
+        .setOffset(0)
+        .setSize(this->push_constants.size());
+
+    vk::PipelineLayoutCreateInfo layout_info = vk::PipelineLayoutCreateInfo()
+        .setSetLayoutCount(1)
+        .setPSetLayouts(&this->descriptor_set_layout)
+        .setPushConstantRangeCount(this->push_constants.empty() ? 0 : 1)
+        .setPPushConstantRanges(&push_constant_range);
+
+    if (this->logical_device.createPipelineLayout(&layout_info, nullptr, &this->pipeline_layout) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create compute pipeline layout.");
+    }
+
+    vk::PipelineShaderStageCreateInfo shader_stage_info = vk::PipelineShaderStageCreateInfo()
+        .setStage(vk::ShaderStageFlagBits::eCompute)
+        .setModule(this->shader_module)
+        .setPName("main");
+
+    vk::ComputePipelineCreateInfo pipeline_create_info = vk::ComputePipelineCreateInfo()
+        .setStage(shader_stage_info)
+        .setLayout(this->pipeline_layout);
+
+    if (this->logical_device.createComputePipelines(this->context.lock()->pipeline_cache, 1, &pipeline_create_info, nullptr, &this->pipeline) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create compute pipeline.");
+    }
+}
+
+void ComputePipeline::create_sampler()
+{
+    vk::SamplerCreateInfo create_info = vk::SamplerCreateInfo()
+        .setMagFilter(vk::Filter::eNearest)
+        .setMinFilter(vk::Filter::eNearest)
+        .setAddressModeU(vk::SamplerAddressMode::eClampToEdge)
+        .setAddressModeV(vk::SamplerAddressMode::eClampToEdge)
+        .setAddressModeW(vk::SamplerAddressMode::eClampToEdge)
+        .setAnisotropyEnable(VK_FALSE)
+        .setMaxAnisotropy(1)
+        .setBorderColor(vk::BorderColor::eIntOpaqueBlack)
+        .setUnnormalizedCoordinates(VK_FALSE)
+        .setCompareEnable(VK_FALSE)
+        .setCompareOp(vk::CompareOp::eAlways)
+        .setMipmapMode(vk::SamplerMipmapMode::eNearest);
+
+    if (this->logical_device.createSampler(&create_info, nullptr, &this->sampler) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create compute image sampler.");
+    }
+}
+
+void ComputePipeline::create_query_pool()
+{
+    std::shared_ptr<Context> context = this->context.lock();
+
+    vk::PhysicalDeviceProperties properties;
+    context->physical_device.getProperties(&properties);
+
+    //Skip throughput measurement where timestamps aren't available
+    if (!properties.limits.timestampComputeAndGraphics) {
+        return;
+    }
+
+    this->timestamp_period = properties.limits.timestampPeriod;
+
+    vk::QueryPoolCreateInfo create_info = vk::QueryPoolCreateInfo()
+        .setQueryType(vk::QueryType::eTimestamp)
+        .setQueryCount(2 * ComputePipeline::query_slots);
+
+    if (this->logical_device.createQueryPool(&create_info, nullptr, &this->query_pool) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create query pool.");
+    }
+
+    //Queries must be reset before their results can be read, even if never written
+    context->run_one_time_commands([&](vk::CommandBuffer command_buffer){
+        command_buffer.resetQueryPool(this->query_pool, 0, 2 * ComputePipeline::query_slots);
+    });
+
+    this->last_report_time = Utilities::get_micro_time();
+}
+
+/**
+ * (Re)create the storage image at the given size.
+ *
+ * @param extent The new image size, usually the swap chain extent.
+ */
+void ComputePipeline::resize(vk::Extent2D extent)
+{
+    std::shared_ptr<Context> context = this->context.lock();
+
+    this->logical_device.waitIdle();
+    this->destroy_image();
+
+    this->extent = extent;
+
+    vk::ImageCreateInfo create_info = vk::ImageCreateInfo()
+        .setImageType(vk::ImageType::e2D)
+        .setExtent({extent.width, extent.height, 1})
+        .setMipLevels(1)
+        .setArrayLayers(1)
+        .setFormat(vk::Format::eR8G8B8A8Unorm)
+        .setTiling(vk::ImageTiling::eOptimal)
+        .setInitialLayout(vk::ImageLayout::eUndefined)
+        .setUsage(vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled)
+        .setSamples(vk::SampleCountFlagBits::e1)
+        .setSharingMode(vk::SharingMode::eExclusive);
+
+    if (this->logical_device.createImage(&create_info, nullptr, &this->image) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create storage image.");
+    }
+
+    vk::MemoryRequirements memory_requirements;
+    this->logical_device.getImageMemoryRequirements(this->image, &memory_requirements);
+
+    vk::MemoryAllocateInfo allocation_info = vk::MemoryAllocateInfo()
+        .setAllocationSize(memory_requirements.size)
+        .setMemoryTypeIndex(
+            context->find_memory_type(
+                memory_requirements.memoryTypeBits,
+                vk::MemoryPropertyFlagBits::eDeviceLocal
+            )
+        );
+
+    if (this->logical_device.allocateMemory(&allocation_info, nullptr, &this->memory) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't allocate storage image memory.");
+    }
+
+    this->logical_device.bindImageMemory(this->image, this->memory, 0);
+
+    vk::ImageViewCreateInfo view_info = vk::ImageViewCreateInfo()
+        .setImage(this->image)
+        .setViewType(vk::ImageViewType::e2D)
+        .setFormat(vk::Format::eR8G8B8A8Unorm)
+        .setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
+
+    if (this->logical_device.createImageView(&view_info, nullptr, &this->image_view) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create storage image view.");
+    }
+
+    vk::DescriptorImageInfo image_info = vk::DescriptorImageInfo()
+        .setImageLayout(vk::ImageLayout::eGeneral)
+        .setImageView(this->image_view);
+
+    vk::WriteDescriptorSet descriptor_write = vk::WriteDescriptorSet()
+        .setDstSet(this->descriptor_set)
+        .setDstBinding(0)
+        .setDstArrayElement(0)
+        .setDescriptorType(vk::DescriptorType::eStorageImage)
+        .setDescriptorCount(1)
+        .setPImageInfo(&image_info);
+
+    this->logical_device.updateDescriptorSets(1, &descriptor_write, 0, nullptr);
+}
+
+void ComputePipeline::destroy_image()
+{
+    if (this->image_view) {
+        this->logical_device.destroyImageView(this->image_view, nullptr);
+        this->image_view = nullptr;
+    }
+
+    if (this->image) {
+        this->logical_device.destroyImage(this->image, nullptr);
+        this->image = nullptr;
+    }
+
+    if (this->memory) {
+        this->logical_device.freeMemory(this->memory, nullptr);
+        this->memory = nullptr;
+    }
+}
+
+/**
+ * Set the push constant block given to the shader on the next dispatch.
+ *
+ * @param data Pointer to the data.
+ * @param size Size of the data in bytes.
+ */
+void ComputePipeline::set_push_constants(void const *data, size_t size)
+{
+    std::lock_guard<std::mutex> guard(this->push_constant_mutex);
+
+    if (size > this->push_constants.size()) {
+        throw std::runtime_error("Push constant data is larger than the push constant block.");
+    }
+
+    memcpy(this->push_constants.data(), data, size);
+}
+
+/**
+ * Record a dispatch filling the storage image, followed by a barrier making it visible to fragment shaders.
+ * Must be recorded outside of a render pass.
+ *
+ * @param command_buffer The command buffer to record into.
+ * @param frame_index Index of the frame (swap chain image) being recorded.
+ */
+void ComputePipeline::record(vk::CommandBuffer command_buffer, uint32_t frame_index)
+{
+    uint32_t slot = frame_index % ComputePipeline::query_slots;
+
+    this->collect_timings(slot);
+
+    vk::ImageSubresourceRange range(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+
+    //Don't overwrite the image while the last frame is still sampling it.
+    //Every texel is rewritten so the old contents can be discarded.
+    vk::ImageMemoryBarrier write_barrier = vk::ImageMemoryBarrier()
+        .setOldLayout(vk::ImageLayout::eUndefined)
+        .setNewLayout(vk::ImageLayout::eGeneral)
+        .setSrcAccessMask(vk::AccessFlagBits::eShaderRead)
+        .setDstAccessMask(vk::AccessFlagBits::eShaderWrite)
+        .setImage(this->image)
+        .setSubresourceRange(range);
+
+    command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eFragmentShader,
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::DependencyFlags(),
+        0, nullptr,
+        0, nullptr,
+        1, &write_barrier
+    );
+
+    if (this->query_pool) {
+        command_buffer.resetQueryPool(this->query_pool, 2 * slot, 2);
+        command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, this->query_pool, 2 * slot);
+    }
+
+    command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->pipeline);
+    command_buffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eCompute,
+        this->pipeline_layout,
+        0,
+        1,
+        &this->descriptor_set,
+        0,
+        nullptr
+    );
+
+    if (!this->push_constants.empty()) {
+        std::lock_guard<std::mutex> guard(this->push_constant_mutex);
+        command_buffer.pushConstants(
+            this->pipeline_layout,
+            vk::ShaderStageFlagBits::eCompute,
+            0,
+            this->push_constants.size(),
+            this->push_constants.data()
+        );
+    }
+
+    //Work groups are 16x16
+    command_buffer.dispatch(
+        (this->extent.width + 15) / 16,
+        (this->extent.height + 15) / 16,
+        1
+    );
+
+    if (this->query_pool) {
+        command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eComputeShader, this->query_pool, 2 * slot + 1);
+        this->query_pending[slot] = true;
+    }
+
+    vk::ImageMemoryBarrier read_barrier = vk::ImageMemoryBarrier()
+        .setOldLayout(vk::ImageLayout::eGeneral)
+        .setNewLayout(vk::ImageLayout::eGeneral)
+        .setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+        .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+        .setImage(this->image)
+        .setSubresourceRange(range);
+
+    command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eFragmentShader,
+        vk::DependencyFlags(),
+        0, nullptr,
+        0, nullptr,
+        1, &read_barrier
+    );
+}
+
+/**
+ * Accumulate the dispatch time from the last use of the given slot and report throughput once a second.
+ *
+ * @param slot The query slot about to be reused.
+ */
+void ComputePipeline::collect_timings(uint32_t slot)
+{
+    if (!this->query_pool || !this->query_pending[slot]) {
+        return;
+    }
+
+    this->query_pending[slot] = false;
+
+    //The frame's fence has been waited on, results that aren't ready were never submitted
+    uint64_t timestamps[2];
+    vk::Result result = this->logical_device.getQueryPoolResults(
+        this->query_pool,
+        2 * slot,
+        2,
+        sizeof(timestamps),
+        timestamps,
+        sizeof(uint64_t),
+        vk::QueryResultFlagBits::e64
+    );
+
+    if (result != vk::Result::eSuccess) {
+        return;
+    }
+
+    this->measured_nanoseconds += (timestamps[1] - timestamps[0]) * static_cast<double>(this->timestamp_period);
+    this->measured_pixels += static_cast<uint64_t>(this->extent.width) * this->extent.height;
+
+    uint64_t current_time = Utilities::get_micro_time();
+    if (current_time - this->last_report_time >= 1000000 && this->measured_nanoseconds > 0.) {
+        std::cout << "Compute throughput (" << this->compute_code_id << "): "
+            << (this->measured_pixels * 1000.) / this->measured_nanoseconds << " Mpix/s" << std::endl;
+
+        this->measured_pixels = 0;
+        this->measured_nanoseconds = 0.;
+        this->last_report_time = current_time;
+    }
+}
+
+vk::ImageView ComputePipeline::get_image_view()
+{
+    return this->image_view;
+}
+
+vk::Sampler ComputePipeline::get_sampler()
+{
+    return this->sampler;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#define VULKAN_HPP_DISABLE_ENHANCED_MODE 1
+#include <vulkan/vulkan.hpp>
+#include <GLFW/glfw3.h>
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <memory>
+
+namespace Animate::VK
+{
+    class Context;
+
+    /**
+     * A compute shader writing into a storage image the size of the swap chain.
+     * The image is dispatched once per frame and can then be sampled by a graphics pipeline.
+     */
+    class ComputePipeline
+    {
+        public:
+            ComputePipeline(
+                std::weak_ptr<Context> context,
+                std::string compute_code_id,
+                uint32_t push_constant_size
+            );
+            ~ComputePipeline();
+
+            void resize(vk::Extent2D extent);
+            void set_push_constants(void const *data, size_t size);
+            void record(vk::CommandBuffer command_buffer, uint32_t frame_index);
+
+            vk::ImageView get_image_view();
+            vk::Sampler get_sampler();
+
+        private:
+            std::weak_ptr<Context> context;
+            vk::Device logical_device;
+
+            std::string compute_code_id;
+
+            std::mutex push_constant_mutex;
+            std::vector<uint8_t> push_constants;
+
+            vk::ShaderModule shader_module;
+            vk::DescriptorSetLayout descriptor_set_layout;
+            vk::DescriptorPool descriptor_pool;
+            vk::DescriptorSet descriptor_set;
+            vk::PipelineLayout pipeline_layout;
+            vk::Pipeline pipeline;
+
+            vk::Extent2D extent;
+            vk::Image image;
+            vk::DeviceMemory memory;
+            vk::ImageView image_view;
+            vk::Sampler sampler;
+
+            //Throughput measurement
+            static const uint32_t query_slots = 8;
+            vk::QueryPool query_pool;
+            float timestamp_period = 0.;
+            bool query_pending[query_slots] = {};
+            uint64_t measured_pixels = 0;
+            double measured_nanoseconds = 0.;
+            uint64_t last_report_time = 0;
+
+            void load_shader();
+            void create_pipeline();
+            void create_descriptor_set();
+            void create_sampler();
+            void create_query_pool();
+            void destroy_image();
+            void collect_timings(uint32_t slot);
+    };
+}
@@ -1,5 +1,9 @@
 #include <set>
+#include <algorithm>
 #include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
 
 #include "../Object/Property/Drawable.hh"
 #include "../Geometry/Vertex.hh"
@@ -9,9 +13,26 @@
 #include "Context.hh"
 #include "Buffer.hh"
 #include "Pipeline.hh"
+#include "ComputePipeline.hh"
+#include "TileMap.hh"
+#include "TextureTable.hh"
+#include "TextureCache.hh"
 
 using namespace Animate::VK;
 
+//"ANPC", marks a pipeline cache written by this program
+static const uint32_t pipeline_cache_magic = 0x43504e41;
+
+//Pipelines' own sets come from pools of this size, more are added as needed
+static const uint32_t descriptor_sets_per_pool = 16;
+
+//Texture table slots, clamped to the device's limits
+static const uint32_t max_texture_table_size = 1024;
+static const uint32_t fallback_texture_table_size = 16;
+
+//Textures evicted past this, or half the device's local memory if that's smaller
+static const vk::DeviceSize default_texture_budget = 256ull << 20;
+
 Context::Context(std::weak_ptr<Animate::AppContext> context) : context(context)
 {
     this->create_instance();
@@ -19,15 +40,15 @@ Context::Context(std::weak_ptr<Animate::AppContext> context) : context(context)
     this->create_surface();
     this->pick_physical_device();
     this->create_logical_device();
+    this->texture_cache = std::make_shared<TextureCache>(this->choose_texture_budget());
+    this->create_pipeline_cache();
     this->create_swap_chain();
     this->create_image_views();
     this->create_depth_stencil();
-    this->create_render_pass();
-    this->create_multisample_target();
-    this->create_framebuffers();
+    this->get_render_pass(this->max_sample_count);
     this->create_pipeline_layout();
     this->create_command_pool();
-    this->create_descriptor_pool();
+    this->descriptor_pools.push_back(this->create_descriptor_pool());
     this->create_command_buffers();
     this->create_semaphores();
     this->create_fences();
@@ -39,19 +60,37 @@ Context::~Context()
         this->logical_device.destroyDescriptorSetLayout(this->descriptor_set_layout, nullptr);
     }
 
-    if (this->descriptor_pool) {
-        this->logical_device.destroyDescriptorPool(this->descriptor_pool, nullptr);
+    if (this->texture_table_layout) {
+        this->logical_device.destroyDescriptorSetLayout(this->texture_table_layout, nullptr);
+    }
+
+    for (auto const& descriptor_pool : this->descriptor_pools) {
+        this->logical_device.destroyDescriptorPool(descriptor_pool, nullptr);
     }
 
     if (this->pipeline_layout) {
         this->logical_device.destroyPipelineLayout(this->pipeline_layout, nullptr);
     }
     this->pipelines.clear();
+    this->compute_pipelines.clear();
+    this->texture_cache.reset();
+
+    //Textures give their slots back as they're destroyed, so the table goes after the pipelines
+    this->texture_table.reset();
 
     cleanup_swap_chain_dependancies();
 
+    for (auto &render_target : this->render_targets) {
+        this->destroy_render_passes(render_target.second);
+    }
+
     this->buffers.clear();
 
+    if (this->pipeline_cache) {
+        this->save_pipeline_cache();
+        this->logical_device.destroyPipelineCache(this->pipeline_cache, nullptr);
+    }
+
     if (this->swap_chain) {
         this->logical_device.destroySwapchainKHR(this->swap_chain, nullptr);
     }
@@ -92,28 +131,64 @@ Context::~Context()
     }
 }
 
+/**
+ * Switch present mode, the swap chain is recreated on the render thread before the next frame.
+ * Falls back to mailbox, immediate then FIFO if the surface doesn't support it.
+ */
+void Context::set_present_mode(vk::PresentModeKHR present_mode)
+{
+    this->preferred_present_mode = present_mode;
+    this->swap_chain_recreate_requested = true;
+}
+
+/**
+ * The present mode of the current swap chain.
+ */
+vk::PresentModeKHR Context::get_present_mode() const
+{
+    return this->present_mode;
+}
+
 void Context::recreate_swap_chain()
 {
     std::lock_guard<std::mutex> command_guard(this->command_mutex);
+    std::unique_lock<std::mutex> render_target_lock(this->render_target_mutex);
 
     this->logical_device.waitIdle();
 
     this->cleanup_swap_chain_dependancies();
 
     vk::SwapchainKHR tmp_swap_chain = this->swap_chain;
+    vk::Format previous_image_format = this->swap_chain_image_format;
 
     this->create_swap_chain();
 
     this->logical_device.destroySwapchainKHR(tmp_swap_chain, nullptr);
 
+    //Viewport and scissor are dynamic, so only a new attachment format invalidates pipelines
+    bool format_changed = previous_image_format != this->swap_chain_image_format;
+
     this->create_image_views();
     this->create_depth_stencil();
-    this->create_render_pass();
 
-    this->create_multisample_target();
-    this->recreate_pipelines();
+    for (auto &render_target : this->render_targets) {
+        if (format_changed) {
+            this->destroy_render_passes(render_target.second);
+        }
+        this->create_render_target(render_target.second);
+    }
+
+    //Pipelines look their render pass up again
+    render_target_lock.unlock();
+
+    this->resize_compute_pipelines();
+
+    if (format_changed) {
+        this->recreate_pipelines();
+    } else {
+        this->update_compute_descriptors();
+    }
 
-    this->create_framebuffers();
     this->create_command_buffers();
 }
 
@@ -131,34 +206,8 @@ void Context::cleanup_swap_chain_dependancies()
         this->logical_device.freeMemory(this->depth_memory, nullptr);
     }
 
-    if (this->multisample_target.colour.image) {
-        this->logical_device.destroyImage(this->multisample_target.colour.image, nullptr);
-    }
-
-    if (this->multisample_target.colour.view) {
-        this->logical_device.destroyImageView(this->multisample_target.colour.view, nullptr);
-    }
-
-    if (this->multisample_target.colour.memory) {
-        this->logical_device.freeMemory(this->multisample_target.colour.memory, nullptr);
-    }
-
-    if (this->multisample_target.depth.image) {
-        this->logical_device.destroyImage(this->multisample_target.depth.image, nullptr);
-    }
-
-    if (this->multisample_target.depth.view) {
-        this->logical_device.destroyImageView(this->multisample_target.depth.view, nullptr);
-    }
-
-    if (this->multisample_target.depth.memory) {
-        this->logical_device.freeMemory(this->multisample_target.depth.memory, nullptr);
-    }
-
-    for (size_t i = 0; i < this->swap_chain_framebuffers.size(); i++) {
-        if (this->swap_chain_framebuffers[i]) {
-            this->logical_device.destroyFramebuffer(this->swap_chain_framebuffers[i], nullptr);
-        }
+    for (auto &render_target : this->render_targets) {
+        this->destroy_render_target(render_target.second);
     }
 
     if (this->command_pool) {
@@ -169,10 +218,6 @@ void Context::cleanup_swap_chain_dependancies()
         );
     }
 
-    if (this->render_pass) {
-        this->logical_device.destroyRenderPass(this->render_pass, nullptr);
-    }
-
     for (size_t i = 0; i < this->swap_chain_image_views.size(); i++) {
         this->logical_device.destroyImageView(this->swap_chain_image_views[i], nullptr);
     }
@@ -180,25 +225,44 @@ void Context::cleanup_swap_chain_dependancies()
 
 void Context::recreate_pipelines()
 {
-    for(auto const& pipeline: this->pipelines) {
+    for(auto const& pipeline: this->get_pipelines()) {
         pipeline->recreate_pipeline();
     }
 }
 
+void Context::update_compute_descriptors()
+{
+    for(auto const& pipeline: this->get_pipelines()) {
+        pipeline->write_compute_descriptor();
+    }
+}
+
+void Context::resize_compute_pipelines()
+{
+    std::lock_guard<std::mutex> guard(this->pipeline_mutex);
+
+    for(auto const& compute_pipeline: this->compute_pipelines) {
+        compute_pipeline->resize(this->swap_chain_extent);
+    }
+}
+
 void Context::fill_command_buffer(int i)
 {
+    std::vector< std::shared_ptr<Pipeline> > pipelines = this->get_pipelines();
+
+    std::lock_guard<std::mutex> render_target_guard(this->render_target_mutex);
+
     vk::Rect2D render_area = vk::Rect2D(
         {0,0},
         this->swap_chain_extent
     );
 
-    vk::ClearValue clear_values[3];
-    clear_values[0] = vk::ClearValue()
+    vk::ClearValue colour_clear_value = vk::ClearValue()
         .setColor(vk::ClearColorValue().setFloat32({0.141176471f, 0.141176471f, 0.141176471f, 1.0f}));
-    clear_values[1] = vk::ClearValue()
-        .setColor(vk::ClearColorValue().setFloat32({0.0f, 0.0f, 0.0f, 1.0f}));
-    clear_values[2] = vk::ClearValue()
+    vk::ClearValue depth_clear_value = vk::ClearValue()
         .setDepthStencil(vk::ClearDepthStencilValue(1.0f, 0));
+    vk::ClearValue resolve_clear_value = vk::ClearValue()
+        .setColor(vk::ClearColorValue().setFloat32({0.0f, 0.0f, 0.0f, 1.0f}));
 
     vk::Viewport viewport = vk::Viewport()
         .setWidth(this->swap_chain_extent.width)
@@ -208,98 +272,200 @@ void Context::fill_command_buffer(int i)
     vk::CommandBufferBeginInfo begin_info = vk::CommandBufferBeginInfo()
         .setFlags(vk::CommandBufferUsageFlagBits::eSimultaneousUse);
 
-    vk::RenderPassBeginInfo render_pass_begin_info = vk::RenderPassBeginInfo()
-        .setRenderPass(this->render_pass)
-        .setRenderArea(render_area)
-        .setClearValueCount(3)
-        .setPClearValues(clear_values)
-        .setFramebuffer(this->swap_chain_framebuffers[i]);
-
     this->command_buffers[i].reset(vk::CommandBufferResetFlags());
     this->command_buffers[i].begin(&begin_info);
     this->command_buffers[i].setViewport(0, 1, &viewport);
-    this->command_buffers[i].beginRenderPass(&render_pass_begin_info, vk::SubpassContents::eInline);
+    this->command_buffers[i].setScissor(0, 1, &render_area);
 
-    vk::DeviceSize index_count = 0;
-    vk::DeviceSize offsets[] = {0};
-    vk::Buffer  last_vertex_buffer,
-                last_index_buffer;
-    bool first_pipeline_draw = true;
+    //Every pipeline shares the layout, so the texture table stays bound across pipeline switches
+    vk::DescriptorSet texture_table_set;
+    {
+        std::lock_guard<std::mutex> guard(this->texture_table_mutex);
+        if (this->texture_table) {
+            texture_table_set = this->texture_table->get_descriptor_set();
+        }
+    }
 
-    for(auto const& pipeline: this->pipelines) {
-        first_pipeline_draw = true;
+    if (texture_table_set) {
+        this->command_buffers[i].bindDescriptorSets(
+            vk::PipelineBindPoint::eGraphics,
+            this->pipeline_layout,
+            1,
+            1,
+            &texture_table_set,
+            0,
+            nullptr
+        );
+    }
 
-        std::vector< std::shared_ptr<Drawable> > drawables = pipeline->get_scene();
+    //Compute work feeding this frame's pipelines has to be recorded outside the render pass
+    for(auto const& pipeline: pipelines) {
+        std::shared_ptr<ComputePipeline> compute_pipeline = pipeline->get_compute_pipeline().lock();
+        if (compute_pipeline && !pipeline->get_scene().empty()) {
+            compute_pipeline->record(this->command_buffers[i], i);
+        }
+    }
 
-        for (auto const& drawable : drawables) {
-            if (!drawable) {
-                continue;
+    //Changed cells are copied into tile maps before anything samples them
+    for(auto const& pipeline: pipelines) {
+        std::shared_ptr<TileMap> tile_map = pipeline->get_tile_map().lock();
+        if (tile_map && !pipeline->get_scene().empty()) {
+            tile_map->record(this->command_buffers[i]);
+        }
+    }
+
+    //One render pass per sample count with something to draw, highest sample count first.
+    //Sample counts are clamped so only the first can be multisampled, see clamp_sample_count.
+    std::vector<RenderTarget*> passes;
+    for (auto it = this->render_targets.rbegin(); it != this->render_targets.rend(); it++) {
+        for(auto const& pipeline: pipelines) {
+            if (pipeline->get_sample_count() == it->first && !pipeline->get_scene().empty()) {
+                passes.push_back(&it->second);
+                break;
             }
+        }
+    }
 
-            vk::Buffer vertex_buffer = drawable->get_vertex_buffer();
-            vk::Buffer index_buffer = drawable->get_index_buffer();
-            index_count = drawable->get_index_count();
+    //The frame still has to be cleared when nothing is drawn
+    if (passes.empty() && !this->render_targets.empty()) {
+        passes.push_back(&this->render_targets.rbegin()->second);
+    }
 
-            if (vertex_buffer && index_buffer && index_count > 0) {
-                Matrix model_matrix = drawable->get_model_matrix();
+    for (size_t pass = 0; pass < passes.size(); pass++) {
+        RenderTarget *target = passes[pass];
+        bool multisampled = target->sample_count != vk::SampleCountFlagBits::e1;
 
-                if (first_pipeline_draw) {
-                    this->command_buffers[i].bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline.get());
+        std::vector<vk::ClearValue> clear_values = {colour_clear_value, depth_clear_value};
+        if (multisampled) {
+            clear_values.push_back(resolve_clear_value);
+        }
 
-                    vk::DescriptorSet descriptor_set = pipeline->get_descriptor_set();
+        vk::RenderPassBeginInfo render_pass_begin_info = vk::RenderPassBeginInfo()
+            .setRenderPass(pass == 0 || multisampled ? target->clear_render_pass : target->load_render_pass)
+            .setRenderArea(render_area)
+            .setClearValueCount(clear_values.size())
+            .setPClearValues(clear_values.data())
+            .setFramebuffer(target->framebuffers[i]);
 
-                    this->command_buffers[i].bindDescriptorSets(
-                        vk::PipelineBindPoint::eGraphics,
-                        this->pipeline_layout,
-                        0,
-                        1,
-                        &descriptor_set,
-                        0,
-                        nullptr
-                    );
+        this->command_buffers[i].beginRenderPass(&render_pass_begin_info, vk::SubpassContents::eInline);
 
-                    first_pipeline_draw = false;
-                }
+        for(auto const& pipeline: pipelines) {
+            if (pipeline->get_sample_count() == target->sample_count) {
+                this->record_pipeline(this->command_buffers[i], pipeline);
+            }
+        }
 
-                if (last_vertex_buffer != vertex_buffer) {
-                    this->command_buffers[i].bindVertexBuffers(0, 1, &vertex_buffer, offsets);
-                    last_vertex_buffer = vertex_buffer;
-                }
+        this->command_buffers[i].endRenderPass();
+    }
 
-                if (last_index_buffer != index_buffer) {
-                    this->command_buffers[i].bindIndexBuffer(index_buffer, 0, vk::IndexType::eUint16);
-                    last_index_buffer = index_buffer;
-                }
+    this->command_buffers[i].end();
+}
+
+void Context::record_pipeline(vk::CommandBuffer command_buffer, std::shared_ptr<Pipeline> pipeline)
+{
+    vk::DeviceSize index_count = 0;
+    vk::DeviceSize offsets[] = {0};
+    vk::Buffer  last_vertex_buffer,
+                last_index_buffer,
+                last_instance_buffer;
+    bool first_pipeline_draw = true;
 
-                Matrix mvp = pipeline->get_matrix() * drawable->get_model_matrix();
+    std::vector< std::shared_ptr<Drawable> > drawables = pipeline->get_scene();
+
+    for (auto const& drawable : drawables) {
+        if (!drawable) {
+            continue;
+        }
 
-                //Set push constants
-                this->command_buffers[i].pushConstants(
+        vk::Buffer vertex_buffer = drawable->get_vertex_buffer();
+        vk::Buffer index_buffer = drawable->get_index_buffer();
+        vk::Buffer instance_buffer = drawable->get_instance_buffer();
+        uint32_t instance_count = drawable->get_instance_count();
+        index_count = drawable->get_index_count();
+
+        if (vertex_buffer && index_buffer && index_count > 0 && instance_count > 0) {
+            if (first_pipeline_draw) {
+                command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline.get());
+
+                vk::DescriptorSet descriptor_set = pipeline->get_descriptor_set();
+
+                command_buffer.bindDescriptorSets(
+                    vk::PipelineBindPoint::eGraphics,
                     this->pipeline_layout,
-                    vk::ShaderStageFlagBits::eVertex,
                     0,
-                    sizeof(float)*16,
-                    &mvp
+                    1,
+                    &descriptor_set,
+                    0,
+                    nullptr
                 );
 
-                this->command_buffers[i].drawIndexed(index_count, 1, 0, 0, 0);
+                first_pipeline_draw = false;
+            }
+
+            if (last_vertex_buffer != vertex_buffer) {
+                command_buffer.bindVertexBuffers(0, 1, &vertex_buffer, offsets);
+                last_vertex_buffer = vertex_buffer;
             }
+
+            if (last_index_buffer != index_buffer) {
+                command_buffer.bindIndexBuffer(index_buffer, 0, vk::IndexType::eUint16);
+                last_index_buffer = index_buffer;
+            }
+
+            if (instance_buffer && last_instance_buffer != instance_buffer) {
+                command_buffer.bindVertexBuffers(1, 1, &instance_buffer, offsets);
+                last_instance_buffer = instance_buffer;
+            }
+
+            Matrix mvp = pipeline->get_matrix() * drawable->get_model_matrix();
+
+            //Set push constants
+            command_buffer.pushConstants(
+                this->pipeline_layout,
+                vk::ShaderStageFlagBits::eVertex,
+                0,
+                sizeof(float)*16,
+                &mvp
+            );
+
+            uint32_t texture_slot = drawable->get_texture_slot();
+            command_buffer.pushConstants(
+                this->pipeline_layout,
+                vk::ShaderStageFlagBits::eFragment,
+                sizeof(float)*16,
+                sizeof(uint32_t),
+                &texture_slot
+            );
+
+            command_buffer.drawIndexed(index_count, instance_count, 0, 0, 0);
         }
     }
+}
 
-    this->command_buffers[i].endRenderPass();
-    this->command_buffers[i].end();
+/**
+ * Take a copy of the pipeline list, pipelines may be created from other threads while it's in use.
+ */
+std::vector< std::shared_ptr<Pipeline> > Context::get_pipelines()
+{
+    std::lock_guard<std::mutex> guard(this->pipeline_mutex);
+    return this->pipelines;
 }
 
 void Context::commit_scenes()
 {
-    for(auto const& pipeline : this->pipelines) {
+    for(auto const& pipeline : this->get_pipelines()) {
         pipeline->commit_scene();
     }
 }
 
 void Context::render_scene()
 {
+    this->update_texture_descriptors();
+
+    if (this->swap_chain_recreate_requested.exchange(false)) {
+        this->recreate_swap_chain();
+    }
+
     uint32_t image_index;
     vk::Result result = this->logical_device.acquireNextImageKHR(
         this->swap_chain,
@@ -375,6 +541,63 @@ void Context::render_scene()
         }
     }
 }
+
+/**
+ * Write texture table slots changed since the last frame, including textures whose larger
+ * mip levels have finished streaming in.
+ * Streamed textures destroy their old views, and without descriptor indexing the table can't
+ * change under submitted frames, so either waits for the queue first.
+ */
+void Context::update_texture_descriptors()
+{
+    std::shared_ptr<TextureTable> texture_table;
+    {
+        std::lock_guard<std::mutex> guard(this->texture_table_mutex);
+        texture_table = this->texture_table;
+    }
+
+    if (!texture_table) {
+        return;
+    }
+
+    std::vector< std::shared_ptr<Pipeline> > pipelines = this->get_pipelines();
+
+    bool streamed = std::any_of(pipelines.begin(), pipelines.end(), [](std::shared_ptr<Pipeline> const& pipeline) {
+        return pipeline->has_streamed_textures();
+    });
+
+    //Evicted textures have had their slots cleared but may still be sampled by frames in flight
+    bool evicted = this->texture_cache->has_retired();
+
+    if (!streamed && !evicted && !texture_table->has_pending_writes()) {
+        return;
+    }
+
+    std::vector< std::shared_ptr<Texture> > retired;
+    {
+        std::lock_guard<std::mutex> resource_guard(this->vulkan_resource_mutex);
+        std::lock_guard<std::mutex> command_guard(this->command_mutex);
+
+        if (streamed || evicted || texture_table->writes_need_idle_queue()) {
+            this->graphics_queue.waitIdle();
+        }
+
+        //Their slots were cleared before they were retired, so the flush below covers them
+        if (evicted) {
+            retired = this->texture_cache->take_retired();
+        }
+
+        for(auto const& pipeline : pipelines) {
+            pipeline->commit_streamed_textures();
+        }
+
+        texture_table->flush();
+    }
+
+    //Destroyed outside the locks, nothing submitted from here on can use them
+    retired.clear();
+}
+
 uint32_t Context::find_memory_type(uint32_t type_filter, vk::MemoryPropertyFlags properties)
 {
     vk::PhysicalDeviceMemoryProperties memory_properties;
@@ -414,7 +637,7 @@ void Context::create_instance()
         .setApplicationVersion(1)
         .setPEngineName("No Engine")
         .setEngineVersion(1)
-        .setApiVersion(VK_API_VERSION_1_0);
+        .setApiVersion(VK_API_VERSION_1_1);
 
     vk::InstanceCreateInfo create_info = vk::InstanceCreateInfo()
         .setPApplicationInfo(&app_info)
@@ -489,7 +712,55 @@ void Context::pick_physical_device()
 
     std::cout << "Using device: " << properties.deviceName << std::endl;
 
-    this->multisample_target.sample_count = this->choose_sample_count(properties);
+    this->supported_sample_counts = this->choose_sample_counts(properties);
+
+    uint32_t sample_count = static_cast<uint32_t>(vk::SampleCountFlagBits::e64);
+    while (sample_count > 1 && !(this->supported_sample_counts & vk::SampleCountFlagBits(sample_count))) {
+        sample_count >>= 1;
+    }
+    this->max_sample_count = vk::SampleCountFlagBits(sample_count);
+
+    //Shaders needing double precision fall back to emulation when unsupported
+    vk::PhysicalDeviceFeatures features;
+    this->physical_device.getFeatures(&features);
+    this->shader_float64 = features.shaderFloat64;
+    this->texture_compression_bc = features.textureCompressionBC;
+    this->texture_compression_etc2 = features.textureCompressionETC2;
+
+    //Every stage sampling the table can also see one texture from its pipeline's own set
+    this->descriptor_indexing = this->supports_descriptor_indexing(this->physical_device, properties);
+    this->texture_table_size = std::min({
+        this->descriptor_indexing ? max_texture_table_size : fallback_texture_table_size,
+        properties.limits.maxPerStageDescriptorSamplers - 1,
+        properties.limits.maxPerStageDescriptorSampledImages - 1,
+        properties.limits.maxDescriptorSetSamplers - 1,
+        properties.limits.maxDescriptorSetSampledImages - 1
+    });
+
+    //Update after bind layouts have limits of their own
+    if (this->descriptor_indexing) {
+        vk::PhysicalDeviceDescriptorIndexingPropertiesEXT indexing_properties;
+        vk::PhysicalDeviceProperties2 properties2 = vk::PhysicalDeviceProperties2()
+            .setPNext(&indexing_properties);
+        this->physical_device.getProperties2(&properties2);
+
+        this->texture_table_size = std::min({
+            this->texture_table_size,
+            indexing_properties.maxPerStageDescriptorUpdateAfterBindSamplers - 1,
+            indexing_properties.maxPerStageDescriptorUpdateAfterBindSampledImages - 1,
+            indexing_properties.maxDescriptorSetUpdateAfterBindSamplers - 1,
+            indexing_properties.maxDescriptorSetUpdateAfterBindSampledImages - 1
+        });
+    }
+
+    std::cout << "Texture table: " << this->texture_table_size << " slots"
+        << (this->descriptor_indexing ? ", updated after bind" : "") << std::endl;
+
+    std::cout << "Double precision shaders: " << (this->shader_float64 ? "native" : "emulated") << std::endl;
+    std::cout << "Texture compression:"
+        << (this->texture_compression_bc ? " BC" : "")
+        << (this->texture_compression_etc2 ? " ETC2" : "")
+        << (this->texture_compression_bc || this->texture_compression_etc2 ? "" : " none, decoded on the CPU") << std::endl;
 }
 
 void Context::create_logical_device()
@@ -515,12 +786,27 @@ void Context::create_logical_device()
     vk::PhysicalDeviceFeatures features = vk::PhysicalDeviceFeatures()
         .setSamplerAnisotropy(VK_TRUE)
         .setSampleRateShading(VK_TRUE)
-        .setAlphaToOne(VK_TRUE);
+        .setAlphaToOne(VK_TRUE)
+        .setShaderSampledImageArrayDynamicIndexing(VK_TRUE)
+        .setShaderFloat64(this->shader_float64)
+        .setTextureCompressionBC(this->texture_compression_bc)
+        .setTextureCompressionETC2(this->texture_compression_etc2);
 
     std::vector<const char*> layers = this->get_required_instance_layers();
     std::vector<const char*> extensions = this->get_required_device_extensions();
 
+    vk::PhysicalDeviceDescriptorIndexingFeaturesEXT indexing_features = vk::PhysicalDeviceDescriptorIndexingFeaturesEXT()
+        .setDescriptorBindingSampledImageUpdateAfterBind(VK_TRUE)
+        .setDescriptorBindingUpdateUnusedWhilePending(VK_TRUE)
+        .setDescriptorBindingPartiallyBound(VK_TRUE);
+
+    if (this->descriptor_indexing) {
+        extensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+        extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    }
+
     vk::DeviceCreateInfo device_create_info = vk::DeviceCreateInfo()
+        .setPNext(this->descriptor_indexing ? &indexing_features : nullptr)
         .setPQueueCreateInfos(queue_create_infos.data())
         .setQueueCreateInfoCount(queue_create_infos.size())
         .setPEnabledFeatures(&features)
@@ -535,12 +821,36 @@ void Context::create_logical_device()
     this->logical_device.getQueue(indices.present_family, 0, &this->present_queue);
 }
 
+/**
+ * Device memory textures may hold before unpinned ones are evicted.
+ */
+vk::DeviceSize Context::choose_texture_budget()
+{
+    vk::PhysicalDeviceMemoryProperties memory_properties;
+    this->physical_device.getMemoryProperties(&memory_properties);
+
+    //Some devices also have a small device local heap for host visible memory, textures go in the largest
+    vk::DeviceSize local_size = 0;
+    for (uint32_t i = 0; i < memory_properties.memoryHeapCount; i++) {
+        if (memory_properties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal) {
+            local_size = std::max(local_size, memory_properties.memoryHeaps[i].size);
+        }
+    }
+
+    vk::DeviceSize budget = std::min(default_texture_budget, local_size / 2);
+
+    std::cout << "Texture budget: " << (budget >> 20) << "MiB" << std::endl;
+
+    return budget;
+}
+
 void Context::create_swap_chain()
 {
     SwapChainSupportDetails swap_chain_support = get_swap_chain_support(this->physical_device);
 
     vk::SurfaceFormatKHR surface_format = this->choose_swap_surface_format(swap_chain_support.formats);
     vk::PresentModeKHR present_mode = this->choose_swap_present_mode(swap_chain_support.present_modes);
+    this->present_mode = present_mode;
     vk::Extent2D extent = this->choose_swap_extent(swap_chain_support.capabilities);
 
     uint32_t image_count = swap_chain_support.capabilities.minImageCount + 1;
@@ -671,33 +981,40 @@ void Context::create_depth_stencil()
     }
 }
 
-void Context::create_render_pass()
+void Context::create_render_target(RenderTarget &target)
+{
+    //Render passes outlive swap chain recreation unless the image format changes
+    if (!target.clear_render_pass) {
+        this->create_render_passes(target);
+    }
+
+    if (target.sample_count != vk::SampleCountFlagBits::e1) {
+        this->create_multisample_target(target);
+    }
+
+    this->create_framebuffers(target);
+}
+
+void Context::create_render_passes(RenderTarget &target)
 {
-    std::array<vk::AttachmentDescription, 4> attachments = {};
+    bool multisampled = target.sample_count != vk::SampleCountFlagBits::e1;
 
+    std::vector<vk::AttachmentDescription> attachments(multisampled ? 3 : 2);
+
+    //Single sampled targets render straight into the swap chain image
     attachments[0] = vk::AttachmentDescription()
         .setFormat(this->swap_chain_image_format)
-        .setSamples(this->multisample_target.sample_count)
+        .setSamples(target.sample_count)
         .setLoadOp(vk::AttachmentLoadOp::eClear)
-        .setStoreOp(vk::AttachmentStoreOp::eDontCare)
+        .setStoreOp(multisampled ? vk::AttachmentStoreOp::eDontCare : vk::AttachmentStoreOp::eStore)
         .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
         .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
         .setInitialLayout(vk::ImageLayout::eUndefined)
-        .setFinalLayout(vk::ImageLayout::eColorAttachmentOptimal);
+        .setFinalLayout(multisampled ? vk::ImageLayout::eColorAttachmentOptimal : vk::ImageLayout::ePresentSrcKHR);
 
     attachments[1] = vk::AttachmentDescription()
-        .setFormat(this->swap_chain_image_format)
-        .setSamples(vk::SampleCountFlagBits::e1)
-        .setLoadOp(vk::AttachmentLoadOp::eDontCare)
-        .setStoreOp(vk::AttachmentStoreOp::eStore)
-        .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
-        .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
-        .setInitialLayout(vk::ImageLayout::eUndefined)
-        .setFinalLayout(vk::ImageLayout::ePresentSrcKHR);
-
-    attachments[2] = vk::AttachmentDescription()
         .setFormat(this->depth_format)
-        .setSamples(this->multisample_target.sample_count)
+        .setSamples(target.sample_count)
         .setLoadOp(vk::AttachmentLoadOp::eClear)
         .setStoreOp(vk::AttachmentStoreOp::eDontCare)
         .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
@@ -705,36 +1022,38 @@ void Context::create_render_pass()
         .setInitialLayout(vk::ImageLayout::eUndefined)
         .setFinalLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
 
-    attachments[3] = vk::AttachmentDescription()
-        .setFormat(this->depth_format)
-        .setSamples(vk::SampleCountFlagBits::e1)
-        .setLoadOp(vk::AttachmentLoadOp::eDontCare)
-        .setStoreOp(vk::AttachmentStoreOp::eStore)
-        .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
-        .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
-        .setInitialLayout(vk::ImageLayout::eUndefined)
-        .setFinalLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
+    if (multisampled) {
+        attachments[2] = vk::AttachmentDescription()
+            .setFormat(this->swap_chain_image_format)
+            .setSamples(vk::SampleCountFlagBits::e1)
+            .setLoadOp(vk::AttachmentLoadOp::eDontCare)
+            .setStoreOp(vk::AttachmentStoreOp::eStore)
+            .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
+            .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
+            .setInitialLayout(vk::ImageLayout::eUndefined)
+            .setFinalLayout(vk::ImageLayout::ePresentSrcKHR);
+    }
 
     vk::AttachmentReference colour_attachment_reference = vk::AttachmentReference()
         .setAttachment(0)
         .setLayout(vk::ImageLayout::eColorAttachmentOptimal);
 
     vk::AttachmentReference depth_attachment_reference = vk::AttachmentReference()
-        .setAttachment(2)
+        .setAttachment(1)
         .setLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
 
     vk::AttachmentReference resolve_attachment_reference = vk::AttachmentReference()
-        .setAttachment(1)
+        .setAttachment(2)
         .setLayout(vk::ImageLayout::eColorAttachmentOptimal);
 
     vk::SubpassDescription subpass = vk::SubpassDescription()
         .setPipelineBindPoint(vk::PipelineBindPoint::eGraphics)
         .setColorAttachmentCount(1)
         .setPColorAttachments(&colour_attachment_reference)
-        .setPResolveAttachments(&resolve_attachment_reference)
+        .setPResolveAttachments(multisampled ? &resolve_attachment_reference : nullptr)
         .setPDepthStencilAttachment(&depth_attachment_reference);
 
-    std::array<vk::SubpassDependency, 2> dependencies;
+    std::array<vk::SubpassDependency, 3> dependencies;
 
     dependencies[0] = vk::SubpassDependency()
         .setSrcSubpass(VK_SUBPASS_EXTERNAL)
@@ -754,41 +1073,135 @@ void Context::create_render_pass()
         .setDstAccessMask(vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite)
         .setDependencyFlags(vk::DependencyFlagBits::eByRegion);
 
+    //Orders this pass after the attachment writes of the pass before it
+    dependencies[2] = vk::SubpassDependency()
+        .setSrcSubpass(VK_SUBPASS_EXTERNAL)
+        .setDstSubpass(0)
+        .setSrcStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests)
+        .setDstStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests)
+        .setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite)
+        .setDstAccessMask(
+            vk::AccessFlagBits::eColorAttachmentRead |
+            vk::AccessFlagBits::eColorAttachmentWrite |
+            vk::AccessFlagBits::eDepthStencilAttachmentRead |
+            vk::AccessFlagBits::eDepthStencilAttachmentWrite
+        )
+        .setDependencyFlags(vk::DependencyFlagBits::eByRegion);
+
     vk::RenderPassCreateInfo render_pass_create_info = vk::RenderPassCreateInfo()
         .setAttachmentCount(attachments.size())
         .setPAttachments(attachments.data())
         .setSubpassCount(1)
         .setPSubpasses(&subpass)
-        .setDependencyCount(2)
+        .setDependencyCount(dependencies.size())
         .setPDependencies(dependencies.data());
 
     if (this->logical_device.createRenderPass(
             &render_pass_create_info,
             nullptr,
-            &this->render_pass
+            &target.clear_render_pass
+        ) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create render pass.");
+    }
+
+    //A resolve overwrites the whole swap chain image, so only single sampled targets can draw over earlier passes
+    if (multisampled) {
+        return;
+    }
+
+    attachments[0]
+        .setLoadOp(vk::AttachmentLoadOp::eLoad)
+        .setInitialLayout(vk::ImageLayout::ePresentSrcKHR);
+
+    if (this->logical_device.createRenderPass(
+            &render_pass_create_info,
+            nullptr,
+            &target.load_render_pass
         ) != vk::Result::eSuccess) {
         throw std::runtime_error("Couldn't create render pass.");
     }
 }
 
+/**
+ * The sample count pipelines asking for the given one are drawn with.
+ * Every multisampled pipeline shares the highest count the device supports, a multisampled
+ * target resolves over the whole frame so a second one would hide what the first drew.
+ */
+vk::SampleCountFlagBits Context::clamp_sample_count(vk::SampleCountFlagBits sample_count) const
+{
+    if (sample_count == vk::SampleCountFlagBits::e1) {
+        return vk::SampleCountFlagBits::e1;
+    }
+
+    return this->max_sample_count;
+}
+
+/**
+ * Get the render pass pipelines of the given sample count are drawn in.
+ * The render target for that count is created the first time it's asked for.
+ */
+vk::RenderPass Context::get_render_pass(vk::SampleCountFlagBits sample_count)
+{
+    std::lock_guard<std::mutex> guard(this->render_target_mutex);
+
+    sample_count = this->clamp_sample_count(sample_count);
+
+    std::map<vk::SampleCountFlagBits, RenderTarget>::iterator it = this->render_targets.find(sample_count);
+    if (it != this->render_targets.end()) {
+        return it->second.clear_render_pass;
+    }
+
+    RenderTarget &target = this->render_targets[sample_count];
+    target.sample_count = sample_count;
+    this->create_render_target(target);
+
+    std::cout << "Created render target: " << vk::to_string(sample_count) << " samples" << std::endl;
+
+    return target.clear_render_pass;
+}
+
 std::weak_ptr<Pipeline> Context::create_pipeline(
     std::string fragment_code_id,
     std::string vertex_code_id,
-    std::vector<std::string> resources
+    std::vector<std::string> resources,
+    size_t uniform_size,
+    RenderSettings settings
 ) {
     std::shared_ptr<Pipeline> pipeline(
         new Pipeline(
             this->shared_from_this(),
             fragment_code_id,
             vertex_code_id,
-            resources
+            resources,
+            uniform_size,
+            settings
         )
     );
 
+    std::lock_guard<std::mutex> guard(this->pipeline_mutex);
     this->pipelines.push_back(pipeline);
     return pipeline;
 }
 
+std::weak_ptr<ComputePipeline> Context::create_compute_pipeline(
+    std::string compute_code_id,
+    uint32_t push_constant_size
+) {
+    std::shared_ptr<ComputePipeline> compute_pipeline(
+        new ComputePipeline(
+            this->shared_from_this(),
+            compute_code_id,
+            push_constant_size
+        )
+    );
+
+    compute_pipeline->resize(this->swap_chain_extent);
+
+    std::lock_guard<std::mutex> guard(this->pipeline_mutex);
+    this->compute_pipelines.push_back(compute_pipeline);
+    return compute_pipeline;
+}
+
 std::weak_ptr<Buffer> Context::create_buffer(
     vk::DeviceSize size,
     vk::BufferUsageFlags usage,
@@ -803,6 +1216,7 @@ std::weak_ptr<Buffer> Context::create_buffer(
         )
     );
 
+    std::lock_guard<std::mutex> guard(this->buffer_mutex);
     this->buffers.insert(
         std::make_pair(
             buffer->get_id(),
@@ -812,8 +1226,18 @@ std::weak_ptr<Buffer> Context::create_buffer(
     return buffer;
 }
 
+/**
+ * The application's worker pool, for splitting up resource loading.
+ */
+std::shared_ptr<Tasks::ThreadPool> Context::get_thread_pool()
+{
+    return this->context.lock()->get_thread_pool().lock();
+}
+
 std::weak_ptr<Buffer> Context::get_buffer(uint64_t id)
 {
+    std::lock_guard<std::mutex> guard(this->buffer_mutex);
+
     std::map< uint64_t, std::shared_ptr<Buffer> >::const_iterator it;
     it = this->buffers.find(id);
     if (it != this->buffers.end()) {
@@ -826,9 +1250,15 @@ std::weak_ptr<Buffer> Context::get_buffer(uint64_t id)
 void Context::release_buffer(std::weak_ptr<Buffer> buffer)
 {
     uint64_t id = buffer.lock()->get_id();
-    std::map< uint64_t, std::shared_ptr<Buffer> >::const_iterator it;
+
+    //Destroyed after the lock is released, destruction waits on the device
+    std::shared_ptr<Buffer> released;
+
+    std::lock_guard<std::mutex> guard(this->buffer_mutex);
+    std::map< uint64_t, std::shared_ptr<Buffer> >::iterator it;
     it = this->buffers.find(id);
     if (it != this->buffers.end()) {
+        released = it->second;
         this->buffers.erase(it);
     }
 }
@@ -866,7 +1296,7 @@ void Context::run_one_time_commands(std::function<void(vk::CommandBuffer)> func)
     this->logical_device.freeCommandBuffers(this->command_pool, 1, &command_buffer);
 }
 
-void Context::create_multisample_target()
+void Context::create_multisample_target(RenderTarget &target)
 {
     vk::ImageCreateInfo image_create_info = vk::ImageCreateInfo()
         .setImageType(vk::ImageType::e2D)
@@ -881,16 +1311,16 @@ void Context::create_multisample_target()
         .setArrayLayers(1)
         .setSharingMode(vk::SharingMode::eExclusive)
         .setTiling(vk::ImageTiling::eOptimal)
-        .setSamples(this->multisample_target.sample_count)
+        .setSamples(target.sample_count)
         .setUsage(vk::ImageUsageFlagBits::eTransientAttachment | vk::ImageUsageFlagBits::eColorAttachment)
         .setInitialLayout(vk::ImageLayout::eUndefined);
 
-    if (this->logical_device.createImage(&image_create_info, nullptr, &this->multisample_target.colour.image) != vk::Result::eSuccess) {
+    if (this->logical_device.createImage(&image_create_info, nullptr, &target.colour.image) != vk::Result::eSuccess) {
         throw std::runtime_error("Couldn't create colour attachment image.");
     }
 
     vk::MemoryRequirements memory_requirements;
-    this->logical_device.getImageMemoryRequirements(this->multisample_target.colour.image, &memory_requirements);
+    this->logical_device.getImageMemoryRequirements(target.colour.image, &memory_requirements);
     vk::MemoryAllocateInfo allocation_info = vk::MemoryAllocateInfo()
         .setAllocationSize(memory_requirements.size)
         .setMemoryTypeIndex(
@@ -900,13 +1330,13 @@ void Context::create_multisample_target()
             )
         );
 
-    if (this->logical_device.allocateMemory(&allocation_info, nullptr, &this->multisample_target.colour.memory) != vk::Result::eSuccess) {
+    if (this->logical_device.allocateMemory(&allocation_info, nullptr, &target.colour.memory) != vk::Result::eSuccess) {
         throw std::runtime_error("Couldn't allocate colour attachment image memory.");
     }
-    this->logical_device.bindImageMemory(this->multisample_target.colour.image, this->multisample_target.colour.memory, 0);
+    this->logical_device.bindImageMemory(target.colour.image, target.colour.memory, 0);
 
     vk::ImageViewCreateInfo image_view_create_info = vk::ImageViewCreateInfo()
-        .setImage(this->multisample_target.colour.image)
+        .setImage(target.colour.image)
         .setViewType(vk::ImageViewType::e2D)
         .setFormat(this->swap_chain_image_format)
         .setComponents(
@@ -919,7 +1349,7 @@ void Context::create_multisample_target()
         )
         .setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
 
-    if (this->logical_device.createImageView(&image_view_create_info, nullptr, &this->multisample_target.colour.view) != vk::Result::eSuccess) {
+    if (this->logical_device.createImageView(&image_view_create_info, nullptr, &target.colour.view) != vk::Result::eSuccess) {
         throw std::runtime_error("Couldn't create colour attachment image view.");
     }
 
@@ -927,11 +1357,11 @@ void Context::create_multisample_target()
         .setFormat(this->depth_format)
         .setUsage(vk::ImageUsageFlagBits::eTransientAttachment | vk::ImageUsageFlagBits::eDepthStencilAttachment);
 
-    if (this->logical_device.createImage(&image_create_info, nullptr, &this->multisample_target.depth.image) != vk::Result::eSuccess) {
+    if (this->logical_device.createImage(&image_create_info, nullptr, &target.depth.image) != vk::Result::eSuccess) {
         throw std::runtime_error("Couldn't create depth attachment image.");
     }
 
-    this->logical_device.getImageMemoryRequirements(this->multisample_target.depth.image, &memory_requirements);
+    this->logical_device.getImageMemoryRequirements(target.depth.image, &memory_requirements);
     allocation_info = vk::MemoryAllocateInfo()
         .setAllocationSize(memory_requirements.size)
         .setMemoryTypeIndex(
@@ -941,14 +1371,14 @@ void Context::create_multisample_target()
             )
         );
 
-    if (this->logical_device.allocateMemory(&allocation_info, nullptr, &this->multisample_target.depth.memory) != vk::Result::eSuccess) {
+    if (this->logical_device.allocateMemory(&allocation_info, nullptr, &target.depth.memory) != vk::Result::eSuccess) {
         throw std::runtime_error("Couldn't allocate depth attachment image memory.");
     }
-    this->logical_device.bindImageMemory(this->multisample_target.depth.image, this->multisample_target.depth.memory, 0);
+    this->logical_device.bindImageMemory(target.depth.image, target.depth.memory, 0);
 
     image_view_create_info
         .setFormat(this->depth_format)
-        .setImage(this->multisample_target.depth.image)
+        .setImage(target.depth.image)
         .setSubresourceRange(
             vk::ImageSubresourceRange(
                 vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil,
@@ -959,38 +1389,212 @@ void Context::create_multisample_target()
             )
         );
 
-        if (this->logical_device.createImageView(&image_view_create_info, nullptr, &this->multisample_target.depth.view) != vk::Result::eSuccess) {
-            throw std::runtime_error("Couldn't create depth attachment image view.");
-        }
+    if (this->logical_device.createImageView(&image_view_create_info, nullptr, &target.depth.view) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create depth attachment image view.");
+    }
 }
 
-void Context::create_framebuffers()
+void Context::create_framebuffers(RenderTarget &target)
 {
-    this->swap_chain_framebuffers.resize(this->swap_chain_image_views.size());
+    bool multisampled = target.sample_count != vk::SampleCountFlagBits::e1;
 
-    std::array<vk::ImageView, 4> attachments;
+    target.framebuffers.resize(this->swap_chain_image_views.size());
 
-    attachments[0] = this->multisample_target.colour.view;
-    attachments[2] = this->multisample_target.depth.view;
-    attachments[3] = this->depth_view;
+    //Laid out as in create_render_passes: colour, depth, then the resolve target
+    std::vector<vk::ImageView> attachments;
+    size_t swap_chain_attachment;
+    if (multisampled) {
+        attachments = {target.colour.view, target.depth.view, vk::ImageView()};
+        swap_chain_attachment = 2;
+    } else {
+        attachments = {vk::ImageView(), this->depth_view};
+        swap_chain_attachment = 0;
+    }
 
     vk::FramebufferCreateInfo framebuffer_create_info = vk::FramebufferCreateInfo()
-        .setRenderPass(this->render_pass)
-        .setAttachmentCount(4)
+        .setRenderPass(target.clear_render_pass)
+        .setAttachmentCount(attachments.size())
         .setPAttachments(attachments.data())
         .setWidth(this->swap_chain_extent.width)
         .setHeight(this->swap_chain_extent.height)
         .setLayers(1);
 
     for (size_t i = 0; i < this->swap_chain_image_views.size(); i++) {
-        attachments[1] = this->swap_chain_image_views[i];
+        attachments[swap_chain_attachment] = this->swap_chain_image_views[i];
 
-        if (this->logical_device.createFramebuffer(&framebuffer_create_info, nullptr, &this->swap_chain_framebuffers[i]) != vk::Result::eSuccess) {
+        if (this->logical_device.createFramebuffer(&framebuffer_create_info, nullptr, &target.framebuffers[i]) != vk::Result::eSuccess) {
             throw std::runtime_error("Couldn't create framebuffer.");
         }
     }
 }
 
+void Context::destroy_render_target(RenderTarget &target)
+{
+    for (auto const& framebuffer : target.framebuffers) {
+        if (framebuffer) {
+            this->logical_device.destroyFramebuffer(framebuffer, nullptr);
+        }
+    }
+
+    if (target.colour.view) {
+        this->logical_device.destroyImageView(target.colour.view, nullptr);
+    }
+
+    if (target.colour.image) {
+        this->logical_device.destroyImage(target.colour.image, nullptr);
+    }
+
+    if (target.colour.memory) {
+        this->logical_device.freeMemory(target.colour.memory, nullptr);
+    }
+
+    if (target.depth.view) {
+        this->logical_device.destroyImageView(target.depth.view, nullptr);
+    }
+
+    if (target.depth.image) {
+        this->logical_device.destroyImage(target.depth.image, nullptr);
+    }
+
+    if (target.depth.memory) {
+        this->logical_device.freeMemory(target.depth.memory, nullptr);
+    }
+
+    target.framebuffers.clear();
+    target.colour = {};
+    target.depth = {};
+}
+
+void Context::destroy_render_passes(RenderTarget &target)
+{
+    if (target.clear_render_pass) {
+        this->logical_device.destroyRenderPass(target.clear_render_pass, nullptr);
+        target.clear_render_pass = nullptr;
+    }
+
+    if (target.load_render_pass) {
+        this->logical_device.destroyRenderPass(target.load_render_pass, nullptr);
+        target.load_render_pass = nullptr;
+    }
+}
+
+void Context::create_pipeline_cache()
+{
+    std::vector<char> initial_data = this->load_pipeline_cache_data();
+
+    vk::PipelineCacheCreateInfo create_info = vk::PipelineCacheCreateInfo()
+        .setInitialDataSize(initial_data.size())
+        .setPInitialData(initial_data.empty() ? nullptr : initial_data.data());
+
+    if (this->logical_device.createPipelineCache(&create_info, nullptr, &this->pipeline_cache) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create pipeline cache.");
+    }
+}
+
+std::string Context::get_pipeline_cache_path() const
+{
+    std::string directory = Utilities::get_cache_directory();
+    if (directory.empty()) {
+        return "";
+    }
+
+    return directory + "/pipeline_cache.bin";
+}
+
+/**
+ * Read the pipeline cache saved by a previous run.
+ *
+ * @return The cache data, empty if there was none or it belongs to another device or driver.
+ */
+std::vector<char> Context::load_pipeline_cache_data()
+{
+    std::string path = this->get_pipeline_cache_path();
+    if (path.empty()) {
+        return {};
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return {};
+    }
+
+    PipelineCacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(PipelineCacheHeader))) {
+        return {};
+    }
+
+    vk::PhysicalDeviceProperties properties;
+    this->physical_device.getProperties(&properties);
+
+    if (header.magic != pipeline_cache_magic ||
+        header.vendor_id != properties.vendorID ||
+        header.device_id != properties.deviceID ||
+        header.driver_version != properties.driverVersion ||
+        std::memcmp(header.uuid, &properties.pipelineCacheUUID[0], VK_UUID_SIZE) != 0
+    ) {
+        std::cout << "Discarding pipeline cache from another device or driver." << std::endl;
+        return {};
+    }
+
+    std::vector<char> data(header.data_size);
+    if (!file.read(data.data(), data.size())) {
+        std::cout << "Discarding truncated pipeline cache." << std::endl;
+        return {};
+    }
+
+    std::cout << "Loaded pipeline cache: " << data.size() << " bytes" << std::endl;
+
+    return data;
+}
+
+/**
+ * Write the pipeline cache to disk for the next run.
+ * Written to a temporary file first so an interrupted save never leaves a corrupt cache.
+ */
+void Context::save_pipeline_cache()
+{
+    std::string path = this->get_pipeline_cache_path();
+    if (path.empty()) {
+        return;
+    }
+
+    size_t data_size = 0;
+    if (this->logical_device.getPipelineCacheData(this->pipeline_cache, &data_size, nullptr) != vk::Result::eSuccess) {
+        return;
+    }
+
+    std::vector<char> data(data_size);
+    if (this->logical_device.getPipelineCacheData(this->pipeline_cache, &data_size, data.data()) != vk::Result::eSuccess) {
+        return;
+    }
+
+    vk::PhysicalDeviceProperties properties;
+    this->physical_device.getProperties(&properties);
+
+    PipelineCacheHeader header = {};
+    header.magic = pipeline_cache_magic;
+    header.vendor_id = properties.vendorID;
+    header.device_id = properties.deviceID;
+    header.driver_version = properties.driverVersion;
+    std::memcpy(header.uuid, &properties.pipelineCacheUUID[0], VK_UUID_SIZE);
+    header.data_size = data_size;
+
+    std::string temporary_path = path + ".tmp";
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<char const*>(&header), sizeof(PipelineCacheHeader));
+        file.write(data.data(), data_size);
+        if (!file) {
+            std::cerr << "Couldn't write pipeline cache: " << temporary_path << std::endl;
+            return;
+        }
+    }
+
+    if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Couldn't replace pipeline cache: " << path << std::endl;
+    }
+}
+
 void Context::create_command_pool()
 {
     QueueFamilyIndices indices = this->get_device_queue_families(this->physical_device);
@@ -1006,7 +1610,7 @@ void Context::create_command_pool()
 
 void Context::create_command_buffers()
 {
-    this->command_buffers.resize(this->swap_chain_framebuffers.size());
+    this->command_buffers.resize(this->swap_chain_image_views.size());
 
     vk::CommandBufferAllocateInfo command_buffer_allocate_info = vk::CommandBufferAllocateInfo()
         .setCommandPool(this->command_pool)
@@ -1017,9 +1621,8 @@ void Context::create_command_buffers()
         throw std::runtime_error("Couldn't create command buffers.");
     }
 
-    for (size_t i = 0; i < this->command_buffers.size(); i++) {
-        this->fill_command_buffer(i);
-    }
+    //Not filled here, render_scene fills each one just before submitting it. Recording uploads
+    //pending tile map cells, which would be lost from a buffer that's never submitted.
 }
 
 void Context::create_semaphores()
@@ -1035,7 +1638,7 @@ void Context::create_semaphores()
 
 void Context::create_fences()
 {
-    this->render_fences.resize(this->swap_chain_framebuffers.size());
+    this->render_fences.resize(this->swap_chain_image_views.size());
 
     vk::FenceCreateInfo create_info = vk::FenceCreateInfo()
         .setFlags(vk::FenceCreateFlagBits::eSignaled);
@@ -1072,41 +1675,140 @@ void Context::create_pipeline_layout()
         throw std::runtime_error("Couldn't create descriptor set layout.");
     }
 
-    vk::PushConstantRange push_constant_range = vk::PushConstantRange()
-        .setStageFlags(vk::ShaderStageFlagBits::eVertex)
-        .setOffset(0)
-        .setSize(sizeof(float)*16);
+    //Set 1, the texture table shared by every pipeline
+    vk::DescriptorSetLayoutBinding texture_table_binding = vk::DescriptorSetLayoutBinding()
+        .setBinding(0)
+        .setDescriptorCount(this->texture_table_size)
+        .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+        .setStageFlags(vk::ShaderStageFlagBits::eFragment);
+
+    vk::DescriptorBindingFlagsEXT texture_table_binding_flags =
+        vk::DescriptorBindingFlagBitsEXT::eUpdateAfterBind |
+        vk::DescriptorBindingFlagBitsEXT::eUpdateUnusedWhilePending |
+        vk::DescriptorBindingFlagBitsEXT::ePartiallyBound;
+
+    vk::DescriptorSetLayoutBindingFlagsCreateInfoEXT texture_table_flags_info = vk::DescriptorSetLayoutBindingFlagsCreateInfoEXT()
+        .setBindingCount(1)
+        .setPBindingFlags(&texture_table_binding_flags);
+
+    vk::DescriptorSetLayoutCreateInfo texture_table_layout_info = vk::DescriptorSetLayoutCreateInfo()
+        .setBindingCount(1)
+        .setPBindings(&texture_table_binding);
+
+    if (this->descriptor_indexing) {
+        texture_table_layout_info
+            .setPNext(&texture_table_flags_info)
+            .setFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPoolEXT);
+    }
+
+    if (this->logical_device.createDescriptorSetLayout(&texture_table_layout_info, nullptr, &this->texture_table_layout) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create texture table layout.");
+    }
+
+    std::array<vk::DescriptorSetLayout, 2> set_layouts = {this->descriptor_set_layout, this->texture_table_layout};
+
+    //The vertex stage gets the mvp matrix, the fragment stage the texture table slot
+    std::array<vk::PushConstantRange, 2> push_constant_ranges = {
+        vk::PushConstantRange()
+            .setStageFlags(vk::ShaderStageFlagBits::eVertex)
+            .setOffset(0)
+            .setSize(sizeof(float)*16),
+        vk::PushConstantRange()
+            .setStageFlags(vk::ShaderStageFlagBits::eFragment)
+            .setOffset(sizeof(float)*16)
+            .setSize(sizeof(uint32_t))
+    };
 
     vk::PipelineLayoutCreateInfo layout_info = vk::PipelineLayoutCreateInfo()
-        .setSetLayoutCount(1)
-        .setPSetLayouts(&this->descriptor_set_layout)
-        .setPushConstantRangeCount(1)
-        .setPPushConstantRanges(&push_constant_range);
+        .setSetLayoutCount(set_layouts.size())
+        .setPSetLayouts(set_layouts.data())
+        .setPushConstantRangeCount(push_constant_ranges.size())
+        .setPPushConstantRanges(push_constant_ranges.data());
 
     if (this->logical_device.createPipelineLayout(&layout_info, nullptr, &this->pipeline_layout) != vk::Result::eSuccess) {
         throw std::runtime_error("Couldn't create pipeline layout.");
     }
 }
 
-void Context::create_descriptor_pool()
+/**
+ * A pool for pipelines' own descriptor sets, see allocate_descriptor_set.
+ */
+vk::DescriptorPool Context::create_descriptor_pool()
 {
     std::array<vk::DescriptorPoolSize, 2> pool_sizes = {
         vk::DescriptorPoolSize()
             .setType(vk::DescriptorType::eUniformBuffer)
-            .setDescriptorCount(5),
+            .setDescriptorCount(descriptor_sets_per_pool),
         vk::DescriptorPoolSize()
             .setType(vk::DescriptorType::eCombinedImageSampler)
-            .setDescriptorCount(5)
+            .setDescriptorCount(descriptor_sets_per_pool)
     };
 
     vk::DescriptorPoolCreateInfo pool_create_info = vk::DescriptorPoolCreateInfo()
         .setPoolSizeCount(pool_sizes.size())
         .setPPoolSizes(pool_sizes.data())
-        .setMaxSets(5);
+        .setMaxSets(descriptor_sets_per_pool);
 
-    if (this->logical_device.createDescriptorPool(&pool_create_info, nullptr, &this->descriptor_pool) != vk::Result::eSuccess) {
+    vk::DescriptorPool descriptor_pool;
+    if (this->logical_device.createDescriptorPool(&pool_create_info, nullptr, &descriptor_pool) != vk::Result::eSuccess) {
         throw std::runtime_error("Couldn't create descriptor pool.");
     }
+
+    return descriptor_pool;
+}
+
+/**
+ * Allocate a set with the pipelines' layout, adding a pool when the current one is full.
+ * Safe to call from any thread.
+ *
+ * @param descriptor_set Set to the new descriptor set.
+ */
+void Context::allocate_descriptor_set(vk::DescriptorSet &descriptor_set)
+{
+    std::lock_guard<std::mutex> guard(this->descriptor_pool_mutex);
+
+    vk::DescriptorSetAllocateInfo allocation_info = vk::DescriptorSetAllocateInfo()
+        .setDescriptorPool(this->descriptor_pools.back())
+        .setDescriptorSetCount(1)
+        .setPSetLayouts(&this->descriptor_set_layout);
+
+    vk::Result result = this->logical_device.allocateDescriptorSets(&allocation_info, &descriptor_set);
+
+    if (result == vk::Result::eErrorOutOfPoolMemory || result == vk::Result::eErrorFragmentedPool) {
+        this->descriptor_pools.push_back(this->create_descriptor_pool());
+        allocation_info.setDescriptorPool(this->descriptor_pools.back());
+        result = this->logical_device.allocateDescriptorSets(&allocation_info, &descriptor_set);
+    }
+
+    if (result != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create descriptor set: " + vk::to_string(result));
+    }
+}
+
+/**
+ * The cache deciding which textures stay resident within the memory budget.
+ */
+std::shared_ptr<TextureCache> Context::get_texture_cache()
+{
+    return this->texture_cache;
+}
+
+/**
+ * The table every texture is registered in, created on first use.
+ * Must not be called for the first time while holding the command mutex.
+ */
+std::shared_ptr<TextureTable> Context::get_texture_table()
+{
+    //Creating it submits work, so it's done outside the mutex the render loop takes
+    std::call_once(this->texture_table_created, [this]() {
+        std::shared_ptr<TextureTable> texture_table = std::make_shared<TextureTable>(this->shared_from_this());
+
+        std::lock_guard<std::mutex> guard(this->texture_table_mutex);
+        this->texture_table = texture_table;
+    });
+
+    std::lock_guard<std::mutex> guard(this->texture_table_mutex);
+    return this->texture_table;
 }
 
 bool Context::is_device_suitable(vk::PhysicalDevice const & device)
@@ -1126,6 +1828,7 @@ bool Context::is_device_suitable(vk::PhysicalDevice const & device)
     return
         features.samplerAnisotropy &&
         features.geometryShader &&
+        features.shaderSampledImageArrayDynamicIndexing &&
         queue_families.is_complete() &&
         swap_chain_adequate;
 }
@@ -1236,6 +1939,36 @@ std::vector<vk::LayerProperties> Context::get_available_instance_layers() const
     return layers;
 }
 
+/**
+ * Whether textures in the table can be written while frames using it are in flight.
+ * Needs Vulkan 1.1 and VK_EXT_descriptor_indexing.
+ */
+bool Context::supports_descriptor_indexing(vk::PhysicalDevice const & device, vk::PhysicalDeviceProperties const & properties) const
+{
+    if (properties.apiVersion < VK_API_VERSION_1_1) {
+        return false;
+    }
+
+    std::vector<vk::ExtensionProperties> extensions = this->get_available_device_extensions(device);
+    bool available = std::any_of(extensions.begin(), extensions.end(), [](vk::ExtensionProperties const& extension) {
+        return strcmp(extension.extensionName, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) == 0;
+    });
+
+    if (!available) {
+        return false;
+    }
+
+    vk::PhysicalDeviceDescriptorIndexingFeaturesEXT indexing_features;
+    vk::PhysicalDeviceFeatures2 features = vk::PhysicalDeviceFeatures2()
+        .setPNext(&indexing_features);
+    device.getFeatures2(&features);
+
+    return
+        indexing_features.descriptorBindingSampledImageUpdateAfterBind &&
+        indexing_features.descriptorBindingUpdateUnusedWhilePending &&
+        indexing_features.descriptorBindingPartiallyBound;
+}
+
 std::vector<const char*> Context::get_required_device_extensions() const
 {
     return {
@@ -1333,6 +2066,11 @@ vk::SurfaceFormatKHR Context::choose_swap_surface_format(const std::vector<vk::S
 
 vk::PresentModeKHR Context::choose_swap_present_mode(std::vector<vk::PresentModeKHR> const & available_present_modes) const
 {
+    vk::PresentModeKHR preferred_mode = this->preferred_present_mode;
+    if (std::find(available_present_modes.begin(), available_present_modes.end(), preferred_mode) != available_present_modes.end()) {
+        return preferred_mode;
+    }
+
     vk::PresentModeKHR chosen_mode = vk::PresentModeKHR::eFifo;
 
     for (const auto& present_mode : available_present_modes) {
@@ -1363,20 +2101,13 @@ vk::Extent2D Context::choose_swap_extent(vk::SurfaceCapabilitiesKHR const & capa
     }
 }
 
-vk::SampleCountFlagBits Context::choose_sample_count(VkPhysicalDeviceProperties properties)
+vk::SampleCountFlags Context::choose_sample_counts(VkPhysicalDeviceProperties properties)
 {
-    vk::SampleCountFlags counts = vk::SampleCountFlagBits(std::min(
-        properties.limits.framebufferColorSampleCounts,
+    //Render targets need both their colour and depth attachments multisampled
+    return vk::SampleCountFlags(
+        properties.limits.framebufferColorSampleCounts &
         properties.limits.framebufferDepthSampleCounts
-    ));
-
-    if (counts & vk::SampleCountFlagBits::e64) { return vk::SampleCountFlagBits::e64; }
-    if (counts & vk::SampleCountFlagBits::e32) { return vk::SampleCountFlagBits::e32; }
-    if (counts & vk::SampleCountFlagBits::e16) { return vk::SampleCountFlagBits::e16; }
-    if (counts & vk::SampleCountFlagBits::e8) { return vk::SampleCountFlagBits::e8; }
-    if (counts & vk::SampleCountFlagBits::e4) { return vk::SampleCountFlagBits::e4; }
-    if (counts & vk::SampleCountFlagBits::e2) { return vk::SampleCountFlagBits::e2; }
-    return vk::SampleCountFlagBits::e1;
+    );
 }
 
 vk::Format Context::choose_depth_format(vk::PhysicalDevice physical_device)
@@ -12,11 +12,19 @@
 #include <functional>
 #include <thread>
 #include <mutex>
+#include <atomic>
+
+#include "RenderSettings.hh"
 
 namespace Animate
 {
     class AppContext;
 
+    namespace Tasks
+    {
+        class ThreadPool;
+    }
+
     namespace Object::Property
     {
         class Drawable;
@@ -28,7 +36,10 @@ namespace Animate
     {
         class Shader;
         class Pipeline;
+        class ComputePipeline;
         class Buffer;
+        class TextureTable;
+        class TextureCache;
         class Quad;
 
         struct QueueFamilyIndices {
@@ -46,6 +57,41 @@ namespace Animate
             std::vector<vk::PresentModeKHR> present_modes;
         };
 
+        /**
+         * Prefixed to the pipeline cache on disk.
+         * The cache is only reused on the device and driver it was built with.
+         */
+        struct PipelineCacheHeader {
+            uint32_t magic;
+            uint32_t vendor_id;
+            uint32_t device_id;
+            uint32_t driver_version;
+            uint8_t uuid[VK_UUID_SIZE];
+            uint64_t data_size;
+        };
+
+        /**
+         * Render passes, attachments and framebuffers shared by every pipeline of one sample count.
+         */
+        struct RenderTarget {
+            vk::SampleCountFlagBits sample_count = vk::SampleCountFlagBits::e1;
+
+            //Clears the frame, used by whichever target draws first
+            vk::RenderPass clear_render_pass;
+            //Draws over what earlier targets rendered, single sampled targets only
+            vk::RenderPass load_render_pass;
+
+            //Multisampled attachments, unused at one sample per pixel
+            struct {
+                vk::Image image;
+                vk::ImageView view;
+                vk::DeviceMemory memory;
+            } colour, depth;
+
+            //Compatible with both render passes
+            std::vector<vk::Framebuffer> framebuffers;
+        };
+
         class Context : public std::enable_shared_from_this<Context>
         {
             public:
@@ -59,6 +105,15 @@ namespace Animate
                 VkDebugReportCallbackEXT debug_callback_obj;
 
                 vk::PhysicalDevice physical_device;
+                bool shader_float64 = false;
+
+                //Block compressed texture formats the device may support, see Texture
+                bool texture_compression_bc = false;
+                bool texture_compression_etc2 = false;
+
+                //Whether the texture table can be written while frames using it are in flight
+                bool descriptor_indexing = false;
+                uint32_t texture_table_size = 0;
                 vk::Device logical_device;
                 vk::Queue   graphics_queue,
                             present_queue;
@@ -73,9 +128,16 @@ namespace Animate
                 vk::Format swap_chain_image_format;
                 vk::Extent2D swap_chain_extent;
                 std::vector<vk::ImageView> swap_chain_image_views;
-                std::vector<vk::Framebuffer> swap_chain_framebuffers;
 
-                vk::RenderPass render_pass;
+                //Asked for at runtime, used when the surface supports it
+                std::atomic<vk::PresentModeKHR> preferred_present_mode = vk::PresentModeKHR::eMailbox;
+                std::atomic<vk::PresentModeKHR> present_mode = vk::PresentModeKHR::eFifo;
+
+                //Set from other threads, the render thread recreates the swap chain before its next acquire
+                std::atomic_bool swap_chain_recreate_requested = false;
+
+                vk::SampleCountFlags supported_sample_counts;
+                vk::SampleCountFlagBits max_sample_count = vk::SampleCountFlagBits::e1;
 
                 vk::CommandPool command_pool;
                 std::vector<vk::CommandBuffer> command_buffers;
@@ -84,33 +146,26 @@ namespace Animate
                               render_finished_semaphore;
 
                 vk::DescriptorSetLayout descriptor_set_layout;
+                vk::DescriptorSetLayout texture_table_layout;
                 vk::PipelineLayout pipeline_layout;
-                vk::DescriptorPool descriptor_pool;
+                vk::PipelineCache pipeline_cache;
 
                 std::vector<vk::Fence> render_fences;
 
 
-                //Multisamling targets
-                struct {
-                    vk::SampleCountFlagBits sample_count = vk::SampleCountFlagBits::e1;
-                    struct {
-                        vk::Image image;
-                        vk::ImageView view;
-                        vk::DeviceMemory memory;
-                    } colour;
-                    struct {
-                        vk::Image image;
-                        vk::ImageView view;
-                        vk::DeviceMemory memory;
-                    } depth;
-                } multisample_target;
-
                 void fill_command_buffer(int i);
 
                 std::weak_ptr<Pipeline> create_pipeline(
                     std::string fragment_code_id,
                     std::string vertex_code_id,
-                    std::vector<std::string> resources = {}
+                    std::vector<std::string> resources = {},
+                    size_t uniform_size = sizeof(float),
+                    RenderSettings settings = RenderSettings()
+                );
+
+                std::weak_ptr<ComputePipeline> create_compute_pipeline(
+                    std::string compute_code_id,
+                    uint32_t push_constant_size = 0
                 );
 
                 std::weak_ptr<Buffer> create_buffer(
@@ -124,20 +179,48 @@ namespace Animate
 
                 void run_one_time_commands(std::function<void(vk::CommandBuffer)> func);
 
+                void allocate_descriptor_set(vk::DescriptorSet &descriptor_set);
+                std::shared_ptr<TextureTable> get_texture_table();
+                std::shared_ptr<TextureCache> get_texture_cache();
+
                 void render_scene();
+                void update_texture_descriptors();
                 void commit_scenes();
 
                 void recreate_swap_chain();
 
+                void set_present_mode(vk::PresentModeKHR present_mode);
+                vk::PresentModeKHR get_present_mode() const;
+
+                vk::SampleCountFlagBits clamp_sample_count(vk::SampleCountFlagBits sample_count) const;
+                vk::RenderPass get_render_pass(vk::SampleCountFlagBits sample_count);
+
                 uint32_t find_memory_type(uint32_t type_filter, vk::MemoryPropertyFlags properties);
 
+                std::shared_ptr<Tasks::ThreadPool> get_thread_pool();
+
             private:
                 std::weak_ptr<Animate::AppContext> context;
                 std::vector<std::thread> deferred_functions;
 
                 std::mutex command_mutex;
+                std::mutex render_target_mutex;
+                std::mutex pipeline_mutex;
+                std::mutex buffer_mutex;
+                std::mutex descriptor_pool_mutex;
+                std::mutex texture_table_mutex;
+                std::once_flag texture_table_created;
+
+                //Another pool is added whenever the last one fills up
+                std::vector<vk::DescriptorPool> descriptor_pools;
+                std::shared_ptr<TextureTable> texture_table;
+                std::shared_ptr<TextureCache> texture_cache;
+
+                //Keyed by sample count, drawn from the highest count down
+                std::map<vk::SampleCountFlagBits, RenderTarget> render_targets;
 
                 std::vector< std::shared_ptr<Pipeline> > pipelines;
+                std::vector< std::shared_ptr<ComputePipeline> > compute_pipelines;
                 std::map< uint64_t, std::shared_ptr<Buffer> > buffers;
 
                 void cleanup_swap_chain_dependancies();
@@ -146,22 +229,35 @@ namespace Animate
                 void bind_debug_callback();
                 void pick_physical_device();
                 void create_logical_device();
+                vk::DeviceSize choose_texture_budget();
                 void create_surface();
                 void create_swap_chain();
                 void create_image_views();
                 void create_depth_stencil();
-                void create_render_pass();
-                void create_multisample_target();
-                void create_framebuffers();
+                void create_render_target(RenderTarget &target);
+                void create_render_passes(RenderTarget &target);
+                void create_multisample_target(RenderTarget &target);
+                void create_framebuffers(RenderTarget &target);
+                void destroy_render_target(RenderTarget &target);
+                void destroy_render_passes(RenderTarget &target);
+                void create_pipeline_cache();
+                void save_pipeline_cache();
+                std::vector<char> load_pipeline_cache_data();
+                std::string get_pipeline_cache_path() const;
+                void record_pipeline(vk::CommandBuffer command_buffer, std::shared_ptr<Pipeline> pipeline);
                 void create_command_pool();
                 void create_command_buffers();
                 void create_semaphores();
                 void create_pipeline_layout();
                 void create_uniform_buffer();
-                void create_descriptor_pool();
+                vk::DescriptorPool create_descriptor_pool();
+                bool supports_descriptor_indexing(vk::PhysicalDevice const & device, vk::PhysicalDeviceProperties const & properties) const;
                 void create_fences();
 
+                std::vector< std::shared_ptr<Pipeline> > get_pipelines();
                 void recreate_pipelines();
+                void update_compute_descriptors();
+                void resize_compute_pipelines();
 
                 bool is_device_suitable(vk::PhysicalDevice const & device);
 
@@ -183,7 +279,7 @@ namespace Animate
                 vk::SurfaceFormatKHR choose_swap_surface_format(std::vector<vk::SurfaceFormatKHR> const & available_formats) const;
                 vk::PresentModeKHR choose_swap_present_mode(std::vector<vk::PresentModeKHR> const & available_present_modes) const;
                 vk::Extent2D choose_swap_extent(vk::SurfaceCapabilitiesKHR const & capabilities) const;
-                vk::SampleCountFlagBits choose_sample_count(VkPhysicalDeviceProperties properties);
+                vk::SampleCountFlags choose_sample_counts(VkPhysicalDeviceProperties properties);
                 vk::Format choose_depth_format(vk::PhysicalDevice physical_device);
 
                 static VKAPI_ATTR VkBool32 VKAPI_CALL debug_callback(
@@ -0,0 +1,48 @@
+#pragma once
+
+namespace Animate::VK
+{
+    /**
+     * Constants of the ETC2 RGBA8 block format, shared by the texture baker's encoder and the
+     * fallback decoder so the two can't disagree.
+     *
+     * Each 16 byte block is an EAC alpha block followed by an ETC2 colour block, both big endian.
+     */
+    namespace Etc2Format
+    {
+        //ETC intensity modifiers, in pixel index order
+        static const int modifiers[8][4] = {
+            {2, 8, -2, -8},
+            {5, 17, -5, -17},
+            {9, 29, -9, -29},
+            {13, 42, -13, -42},
+            {18, 60, -18, -60},
+            {24, 80, -24, -80},
+            {33, 106, -33, -106},
+            {47, 183, -47, -183}
+        };
+
+        //Distances between the paint colours of the T and H modes
+        static const int distances[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+        //EAC alpha modifiers, scaled by the block's multiplier
+        static const int alpha_modifiers[16][8] = {
+            {-3, -6, -9, -15, 2, 5, 8, 14},
+            {-3, -7, -10, -13, 2, 6, 9, 12},
+            {-2, -5, -8, -13, 1, 4, 7, 12},
+            {-2, -4, -6, -13, 1, 3, 5, 12},
+            {-3, -6, -8, -12, 2, 5, 7, 11},
+            {-3, -7, -9, -11, 2, 6, 8, 10},
+            {-4, -7, -8, -11, 3, 6, 7, 10},
+            {-3, -5, -8, -11, 2, 4, 7, 10},
+            {-2, -6, -8, -10, 1, 5, 7, 9},
+            {-2, -5, -8, -10, 1, 4, 7, 9},
+            {-2, -4, -8, -10, 1, 3, 7, 9},
+            {-2, -5, -7, -10, 1, 4, 6, 9},
+            {-3, -4, -7, -10, 2, 3, 6, 9},
+            {-1, -2, -3, -10, 0, 1, 2, 9},
+            {-4, -6, -8, -9, 3, 5, 7, 8},
+            {-3, -5, -7, -9, 2, 4, 6, 8}
+        };
+    }
+}
@@ -0,0 +1,101 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "InstancedQuad.hh"
+#include "Context.hh"
+#include "Buffer.hh"
+
+using namespace Animate::VK;
+using namespace Animate::Geometry;
+
+/**
+ * Constructor
+ *
+ * @param instance_count How many copies to draw.
+ */
+InstancedQuad::InstancedQuad(std::weak_ptr<VK::Context> context, uint32_t instance_count, Scale size)
+    : Quad(context, Point(), size), instance_count(instance_count)
+{}
+
+/**
+ * Destructor.
+ */
+InstancedQuad::~InstancedQuad()
+{
+    if (!this->context.expired()) {
+        this->context.lock()->release_buffer(this->instance_buffer);
+    }
+}
+
+/**
+ * Initialise the quads ibo and vbo, and the instance buffer.
+ */
+void InstancedQuad::initialise_buffers()
+{
+    Quad::initialise_buffers();
+    this->create_instance_buffer();
+}
+
+void InstancedQuad::create_instance_buffer()
+{
+    //Check if the buffer is already initialised
+    if (!this->instance_buffer.expired()) {
+        return;
+    }
+
+    this->instance_buffer = this->context.lock()->create_buffer(
+        this->instance_count * sizeof(Instance),
+        vk::BufferUsageFlagBits::eVertexBuffer,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+    );
+
+    this->set_instances(std::vector<Instance>(this->instance_count));
+}
+
+/**
+ * Replace every instance.
+ */
+void InstancedQuad::set_instances(std::vector<Instance> const& instances)
+{
+    if (instances.size() != this->instance_count) {
+        throw std::runtime_error("Wrong number of instances given.");
+    }
+
+    std::shared_ptr<Buffer> buffer = this->instance_buffer.lock();
+    if (!buffer) {
+        return;
+    }
+
+    void *data = buffer->map();
+    memcpy(data, instances.data(), instances.size() * sizeof(Instance));
+    buffer->unmap();
+}
+
+/**
+ * Replace one instance, leaving the rest of the buffer alone.
+ */
+void InstancedQuad::set_instance(uint32_t index, Instance instance)
+{
+    if (index >= this->instance_count) {
+        throw std::runtime_error("Invalid instance index given.");
+    }
+
+    std::shared_ptr<Buffer> buffer = this->instance_buffer.lock();
+    if (!buffer) {
+        return;
+    }
+
+    Instance *data = static_cast<Instance *>(buffer->map());
+    data[index] = instance;
+    buffer->unmap();
+}
+
+vk::Buffer const InstancedQuad::get_instance_buffer()
+{
+    return *this->instance_buffer.lock().get();
+}
+
+uint32_t InstancedQuad::get_instance_count()
+{
+    return this->instance_count;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "Quad.hh"
+#include "../Geometry/Instance.hh"
+
+using namespace Animate::Geometry;
+
+namespace Animate::VK
+{
+    /**
+     * A quad drawn once per instance in a single draw, for pipelines created with
+     * RenderSettings::instanced. Instances are host visible so single entries can be
+     * rewritten without a transfer.
+     */
+    class InstancedQuad : public Quad
+    {
+        public:
+            InstancedQuad(std::weak_ptr<VK::Context> context, uint32_t instance_count, Scale size = Scale(1.,1.,1.));
+            ~InstancedQuad();
+
+            void initialise_buffers() override;
+
+            void set_instances(std::vector<Instance> const& instances);
+            void set_instance(uint32_t index, Instance instance);
+
+            vk::Buffer const get_instance_buffer() override;
+            uint32_t get_instance_count() override;
+
+        protected:
+            uint32_t instance_count;
+
+            std::weak_ptr<Buffer> instance_buffer;
+
+            void create_instance_buffer();
+    };
+}
@@ -1,10 +1,13 @@
 #include <iostream>
+#include <algorithm>
 
 #include "Pipeline.hh"
 #include "Context.hh"
 #include "../Utilities.hh"
 #include "../Geometry/Vertex.hh"
+#include "../Geometry/Instance.hh"
 #include "Buffer.hh"
+#include "TextureCache.hh"
 
 using namespace Animate::VK;
 
@@ -15,16 +18,21 @@ Pipeline::Pipeline(
     std::weak_ptr<VK::Context> context,
     std::string fragment_code_id,
     std::string vertex_code_id,
-    std::vector<std::string> resources
-) : context(context), fragment_code_id(fragment_code_id), vertex_code_id(vertex_code_id)
+    std::vector<std::string> resources,
+    size_t uniform_size,
+    RenderSettings settings
+) : context(context), fragment_code_id(fragment_code_id), vertex_code_id(vertex_code_id), settings(settings)
 {
     this->logical_device = context.lock()->logical_device;
     this->load_shader(vk::ShaderStageFlagBits::eFragment, fragment_code_id);
     this->load_shader(vk::ShaderStageFlagBits::eVertex, vertex_code_id);
     this->create_pipeline();
-    this->create_uniform_buffer();
+    this->create_uniform_buffer(
+        settings.tile_map_width > 0 ? std::max(uniform_size, sizeof(TileMap::Uniforms)) : uniform_size
+    );
     this->create_textures(resources);
     this->create_descriptor_set();
+    this->create_tile_map();
 }
 
 /**
@@ -44,13 +52,12 @@ Pipeline::~Pipeline()
 
 void Pipeline::load_shader(vk::ShaderStageFlagBits type, std::string resource_id)
 {
-    size_t code_size;
-
-    const uint32_t *code = reinterpret_cast<const uint32_t*>(Utilities::get_resource_as_bytes(resource_id, &code_size));
+    //Resources are aligned in the pack, so the code can be used in place
+    ResourceSpan code = Utilities::get_resource_as_bytes(resource_id);
 
     vk::ShaderModuleCreateInfo shader_module_create_info = vk::ShaderModuleCreateInfo()
-        .setCodeSize(code_size)
-        .setPCode(code);
+        .setCodeSize(code.size)
+        .setPCode(reinterpret_cast<const uint32_t*>(code.data));
 
     vk::ShaderModule shader_module;
 
@@ -76,39 +83,56 @@ void Pipeline::recreate_pipeline()
     if (tmp) {
         this->context.lock()->logical_device.destroyPipeline(tmp, nullptr);
     }
+
+    //The compute image is recreated along with the swap chain
+    this->write_compute_descriptor();
+}
+
+/**
+ * The sample count this pipeline was built for, after clamping to what the device supports.
+ */
+vk::SampleCountFlagBits Pipeline::get_sample_count() const
+{
+    return this->sample_count;
 }
 
 void Pipeline::create_pipeline()
 {
     std::shared_ptr<Context> context = this->context.lock();
 
-    auto binding_description = Geometry::Vertex::get_binding_description();
-    auto attribute_descriptions = Geometry::Vertex::get_attribute_descriptions();
+    this->sample_count = context->clamp_sample_count(this->settings.sample_count);
+    vk::RenderPass render_pass = context->get_render_pass(this->sample_count);
+
+    std::vector<vk::VertexInputBindingDescription> binding_descriptions = {
+        Geometry::Vertex::get_binding_description()
+    };
+
+    auto vertex_attributes = Geometry::Vertex::get_attribute_descriptions();
+    std::vector<vk::VertexInputAttributeDescription> attribute_descriptions(
+        vertex_attributes.begin(),
+        vertex_attributes.end()
+    );
+
+    if (this->settings.instanced) {
+        binding_descriptions.push_back(Geometry::Instance::get_binding_description());
+
+        auto instance_attributes = Geometry::Instance::get_attribute_descriptions();
+        attribute_descriptions.insert(attribute_descriptions.end(), instance_attributes.begin(), instance_attributes.end());
+    }
 
     vk::PipelineVertexInputStateCreateInfo vertex_input_info = vk::PipelineVertexInputStateCreateInfo()
-        .setVertexBindingDescriptionCount(1)
+        .setVertexBindingDescriptionCount(binding_descriptions.size())
         .setVertexAttributeDescriptionCount(attribute_descriptions.size())
-        .setPVertexBindingDescriptions(&binding_description)
+        .setPVertexBindingDescriptions(binding_descriptions.data())
         .setPVertexAttributeDescriptions(attribute_descriptions.data());
 
     vk::PipelineInputAssemblyStateCreateInfo input_assembly_info = vk::PipelineInputAssemblyStateCreateInfo()
         .setTopology(vk::PrimitiveTopology::eTriangleStrip);
 
-    vk::Viewport viewport = vk::Viewport()
-        .setWidth((float)context->swap_chain_extent.width)
-        .setHeight((float)context->swap_chain_extent.height)
-        .setMaxDepth(1.0f);
-
-    vk::Rect2D scissor = vk::Rect2D(
-        {0,0},
-        context->swap_chain_extent
-    );
-
+    //Both are set when recording, so resizing the window never rebuilds the pipeline
     vk::PipelineViewportStateCreateInfo viewport_info = vk::PipelineViewportStateCreateInfo()
         .setViewportCount(1)
-        .setPViewports(&viewport)
-        .setScissorCount(1)
-        .setPScissors(&scissor);
+        .setScissorCount(1);
 
     vk::PipelineRasterizationStateCreateInfo rasteriser_info = vk::PipelineRasterizationStateCreateInfo()
         .setLineWidth(1.0f)
@@ -129,9 +153,9 @@ void Pipeline::create_pipeline()
         );
 
     vk::PipelineMultisampleStateCreateInfo multisampling_state_info = vk::PipelineMultisampleStateCreateInfo()
-        .setRasterizationSamples(context->multisample_target.sample_count)
-        .setSampleShadingEnable(VK_TRUE)
-        .setMinSampleShading(.25f)
+        .setRasterizationSamples(this->sample_count)
+        .setSampleShadingEnable(this->settings.sample_shading && this->sample_count != vk::SampleCountFlagBits::e1)
+        .setMinSampleShading(this->settings.min_sample_shading)
         .setAlphaToOneEnable(VK_TRUE)
         .setAlphaToCoverageEnable(VK_TRUE);
 
@@ -147,15 +171,36 @@ void Pipeline::create_pipeline()
         .setAttachmentCount(1)
         .setPAttachments(&colour_blend_attachment_info);
 
-    vk::DynamicState dynamic_states[] = { vk::DynamicState::eViewport };
+    vk::DynamicState dynamic_states[] = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
 
     vk::PipelineDynamicStateCreateInfo dynamic_state_info = vk::PipelineDynamicStateCreateInfo()
-        .setDynamicStateCount(1)
+        .setDynamicStateCount(2)
         .setPDynamicStates(dynamic_states);
 
+    //Fragment shaders size their view of the texture table with constant 0
+    uint32_t texture_table_size = context->texture_table_size;
+
+    vk::SpecializationMapEntry specialization_entry = vk::SpecializationMapEntry()
+        .setConstantID(0)
+        .setOffset(0)
+        .setSize(sizeof(uint32_t));
+
+    vk::SpecializationInfo specialization_info = vk::SpecializationInfo()
+        .setMapEntryCount(1)
+        .setPMapEntries(&specialization_entry)
+        .setDataSize(sizeof(uint32_t))
+        .setPData(&texture_table_size);
+
+    std::vector<vk::PipelineShaderStageCreateInfo> shader_stages = this->shader_stages;
+    for (auto &shader_stage : shader_stages) {
+        if (shader_stage.stage == vk::ShaderStageFlagBits::eFragment) {
+            shader_stage.setPSpecializationInfo(&specialization_info);
+        }
+    }
+
     vk::GraphicsPipelineCreateInfo pipeline_create_info = vk::GraphicsPipelineCreateInfo()
-        .setStageCount(this->shader_stages.size())
-        .setPStages(this->shader_stages.data())
+        .setStageCount(shader_stages.size())
+        .setPStages(shader_stages.data())
         .setPVertexInputState(&vertex_input_info)
         .setPInputAssemblyState(&input_assembly_info)
         .setPViewportState(&viewport_info)
@@ -165,12 +210,12 @@ void Pipeline::create_pipeline()
         .setPDynamicState(&dynamic_state_info)
         .setPDepthStencilState(&depth_Stencil_info)
         .setLayout(context->pipeline_layout)
-        .setRenderPass(context->render_pass)
+        .setRenderPass(render_pass)
         .setSubpass(0)
         .setBasePipelineHandle(this->pipeline)
         .setFlags(vk::PipelineCreateFlagBits::eAllowDerivatives);
 
-    if (context->logical_device.createGraphicsPipelines(nullptr, 1, &pipeline_create_info, nullptr, &this->pipeline) != vk::Result::eSuccess) {
+    if (context->logical_device.createGraphicsPipelines(context->pipeline_cache, 1, &pipeline_create_info, nullptr, &this->pipeline) != vk::Result::eSuccess) {
         throw std::runtime_error("Couldn't create graphics pipeline.");
     }
 }
@@ -179,15 +224,7 @@ void Pipeline::create_descriptor_set()
 {
     std::shared_ptr<Context> context = this->context.lock();
 
-    vk::DescriptorSetAllocateInfo allocation_info = vk::DescriptorSetAllocateInfo()
-        .setDescriptorPool(context->descriptor_pool)
-        .setDescriptorSetCount(1)
-        .setPSetLayouts(&context->descriptor_set_layout);
-
-    vk::Result result = this->logical_device.allocateDescriptorSets(&allocation_info, &this->descriptor_set);
-    if (result != vk::Result::eSuccess) {
-        throw std::runtime_error("Couldn't create descriptor set: " + vk::to_string(result));
-    }
+    context->allocate_descriptor_set(this->descriptor_set);
 
     vk::DescriptorBufferInfo buffer_info = vk::DescriptorBufferInfo()
         .setBuffer(this->uniform_buffer.lock()->get_ident())
@@ -202,26 +239,7 @@ void Pipeline::create_descriptor_set()
         .setDescriptorCount(1)
         .setPBufferInfo(&buffer_info);
 
-    std::vector<vk::WriteDescriptorSet> descriptor_writes = {descriptor_uniform_write};
-
-    if (this->textures) {
-        vk::DescriptorImageInfo image_info = vk::DescriptorImageInfo()
-            .setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
-            .setImageView(this->textures->get_image_view())
-            .setSampler(this->textures->get_sampler());
-
-        vk::WriteDescriptorSet descriptor_sampler_write = vk::WriteDescriptorSet()
-            .setDstSet(this->descriptor_set)
-            .setDstBinding(1)
-            .setDstArrayElement(0)
-            .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
-            .setDescriptorCount(1)
-            .setPImageInfo(&image_info);
-
-        descriptor_writes.push_back(descriptor_sampler_write);
-    }
-
-    this->logical_device.updateDescriptorSets(descriptor_writes.size(), descriptor_writes.data(), 0, nullptr);
+    this->logical_device.updateDescriptorSets(1, &descriptor_uniform_write, 0, nullptr);
 }
 
 vk::DescriptorSet Pipeline::get_descriptor_set()
@@ -231,8 +249,10 @@ vk::DescriptorSet Pipeline::get_descriptor_set()
 
 void Pipeline::create_textures(std::vector<std::string> resources)
 {
+    //Loaded when first used, the cache evicts them while their animation isn't shown
     if (resources.size() > 0) {
-        this->textures.reset(new Textures(this->context, resources));
+        this->textures.reset(new Textures(this->context, resources, this->settings.stream_textures));
+        this->context.lock()->get_texture_cache()->add(this->textures);
     }
 }
 
@@ -241,20 +261,153 @@ std::weak_ptr<Textures> Pipeline::get_textures()
     return this->textures;
 }
 
-void Pipeline::create_uniform_buffer()
+/**
+ * Whether this pipeline's textures have finished streaming and are waiting to be committed.
+ */
+bool Pipeline::has_streamed_textures()
+{
+    return this->textures && this->textures->has_streamed_view();
+}
+
+/**
+ * Switch to the fully streamed textures.
+ * Destroys the views they replace, so nothing using them may be in flight.
+ */
+void Pipeline::commit_streamed_textures()
+{
+    if (this->textures) {
+        this->textures->commit_streamed_view();
+    }
+}
+
+/**
+ * Sample the storage image of the given compute pipeline in place of textures.
+ * The compute pipeline is dispatched before each frame this pipeline draws in.
+ *
+ * @param compute_pipeline The compute pipeline.
+ */
+void Pipeline::set_compute_pipeline(std::weak_ptr<ComputePipeline> compute_pipeline)
+{
+    this->compute_pipeline = compute_pipeline;
+    this->write_compute_descriptor();
+}
+
+std::weak_ptr<ComputePipeline> Pipeline::get_compute_pipeline()
+{
+    return this->compute_pipeline;
+}
+
+/**
+ * Point the texture binding at the compute pipeline's image.
+ * Needs calling again whenever that image is recreated.
+ */
+void Pipeline::write_compute_descriptor()
+{
+    std::shared_ptr<ComputePipeline> compute_pipeline = this->compute_pipeline.lock();
+    if (!compute_pipeline) {
+        return;
+    }
+
+    vk::DescriptorImageInfo image_info = vk::DescriptorImageInfo()
+        .setImageLayout(vk::ImageLayout::eGeneral)
+        .setImageView(compute_pipeline->get_image_view())
+        .setSampler(compute_pipeline->get_sampler());
+
+    vk::WriteDescriptorSet descriptor_sampler_write = vk::WriteDescriptorSet()
+        .setDstSet(this->descriptor_set)
+        .setDstBinding(1)
+        .setDstArrayElement(0)
+        .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+        .setDescriptorCount(1)
+        .setPImageInfo(&image_info);
+
+    this->logical_device.updateDescriptorSets(1, &descriptor_sampler_write, 0, nullptr);
+}
+
+/**
+ * Create the grid of cells drawn by tile mapped pipelines and point the sampler binding at it.
+ */
+void Pipeline::create_tile_map()
+{
+    if (this->settings.tile_map_width == 0 || this->settings.tile_map_height == 0) {
+        return;
+    }
+
+    this->tile_map = std::make_shared<TileMap>(
+        this->context,
+        this->settings.tile_map_width,
+        this->settings.tile_map_height
+    );
+
+    vk::DescriptorImageInfo image_info = vk::DescriptorImageInfo()
+        .setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+        .setImageView(this->tile_map->get_image_view())
+        .setSampler(this->tile_map->get_sampler());
+
+    vk::WriteDescriptorSet descriptor_sampler_write = vk::WriteDescriptorSet()
+        .setDstSet(this->descriptor_set)
+        .setDstBinding(1)
+        .setDstArrayElement(0)
+        .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+        .setDescriptorCount(1)
+        .setPImageInfo(&image_info);
+
+    this->logical_device.updateDescriptorSets(1, &descriptor_sampler_write, 0, nullptr);
+}
+
+/**
+ * The grid of cells this pipeline draws, if it was created with RenderSettings::tile_mapped.
+ */
+std::weak_ptr<TileMap> Pipeline::get_tile_map()
+{
+    return this->tile_map;
+}
+
+/**
+ * Tell a tile mapped pipeline's shader where each kind of cell's image is.
+ *
+ * @param tile_types Each kind's image, kind 0 first.
+ */
+void Pipeline::set_tile_types(std::vector<TextureRegion> const& tile_types)
+{
+    if (!this->tile_map) {
+        throw std::runtime_error("Pipeline has no tile map.");
+    }
+
+    TileMap::Uniforms uniforms = this->tile_map->get_uniforms(tile_types);
+    this->set_uniform_data(&uniforms, sizeof(uniforms));
+}
+
+void Pipeline::create_uniform_buffer(size_t size)
 {
     this->uniform_buffer = this->context.lock()->create_buffer(
-        sizeof(float),
+        size,
         vk::BufferUsageFlagBits::eUniformBuffer,
         vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
     );
 }
 
 void Pipeline::set_uniform_float(float value)
+{
+    this->set_uniform_data(&value, sizeof(float));
+}
+
+/**
+ * Copy a block of uniform data, laid out to match the shader's uniform block.
+ *
+ * @param value Pointer to the data.
+ * @param size Size of the data in bytes.
+ */
+void Pipeline::set_uniform_data(void const *value, size_t size)
 {
     std::shared_ptr<Buffer> uniform_buffer = this->uniform_buffer.lock();
+
+    if (size > uniform_buffer->get_size()) {
+        throw std::runtime_error("Uniform data is larger than the uniform buffer.");
+    }
+
     void *data = uniform_buffer->map();
-    memcpy(data, &value, sizeof(float));
+    memcpy(data, value, size);
     uniform_buffer->unmap();
 }
 
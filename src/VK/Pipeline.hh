@@ -9,6 +9,9 @@
 #include <mutex>
 
 #include "Textures.hh"
+#include "ComputePipeline.hh"
+#include "TileMap.hh"
+#include "RenderSettings.hh"
 #include "../Geometry/Definitions.hh"
 #include "../Geometry/Matrix.hh"
 #include "../Object/Property/Drawable.hh"
@@ -27,7 +30,9 @@ namespace Animate::VK
                 std::weak_ptr<Context> context,
                 std::string fragment_code_id,
                 std::string vertex_code_id,
-                std::vector<std::string> resources
+                std::vector<std::string> resources,
+                size_t uniform_size = sizeof(float),
+                RenderSettings settings = RenderSettings()
             );
             ~Pipeline();
 
@@ -38,15 +43,27 @@ namespace Animate::VK
 
             void recreate_pipeline();
 
+            vk::SampleCountFlagBits get_sample_count() const;
+
             vk::DescriptorSet get_descriptor_set();
 
             void create_textures(std::vector<std::string> resources);
             std::weak_ptr<Textures> get_textures();
+            bool has_streamed_textures();
+            void commit_streamed_textures();
+
+            void set_compute_pipeline(std::weak_ptr<ComputePipeline> compute_pipeline);
+            std::weak_ptr<ComputePipeline> get_compute_pipeline();
+            void write_compute_descriptor();
+
+            std::weak_ptr<TileMap> get_tile_map();
+            void set_tile_types(std::vector<TextureRegion> const& tile_types);
 
             void set_matrices(Matrix view, Matrix projection);
             Matrix get_matrix();
 
             void set_uniform_float(float value);
+            void set_uniform_data(void const *value, size_t size);
 
             void add_drawable(std::shared_ptr<Drawable> drawable);
             std::vector< std::shared_ptr<Drawable> > get_drawables();
@@ -64,10 +81,14 @@ namespace Animate::VK
             std::weak_ptr<Buffer> uniform_buffer;
             vk::DescriptorSet descriptor_set;
             std::shared_ptr<Textures> textures;
+            std::weak_ptr<ComputePipeline> compute_pipeline;
+            std::shared_ptr<TileMap> tile_map;
 
             std::string fragment_code_id;
             std::string vertex_code_id;
             vk::Pipeline pipeline;
+            RenderSettings settings;
+            vk::SampleCountFlagBits sample_count = vk::SampleCountFlagBits::e1;
             Matrix pv;
 
             std::vector<std::shared_ptr<Drawable> > staging_drawables;
@@ -79,6 +100,7 @@ namespace Animate::VK
             void load_shader(vk::ShaderStageFlagBits type, std::string resource_id);
             void create_pipeline();
             void create_descriptor_set();
-            void create_uniform_buffer();
+            void create_uniform_buffer(size_t size);
+            void create_tile_map();
     };
 }
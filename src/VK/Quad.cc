@@ -34,9 +34,28 @@ void Quad::set_texture_position(Vector3 texture_position, Vector3 texture_size)
     this->update_buffer();
 }
 
-void Quad::set_texture_layer(uint32_t layer)
+/**
+ * Map the quad to part of an image in a texture atlas.
+ *
+ * @param texture_region   The image's region in the atlas.
+ * @param texture_position The corner to sample from, relative to the region.
+ * @param texture_size     The size to sample, relative to the region.
+ */
+void Quad::set_texture_position(TextureRegion texture_region, Vector3 texture_position, Vector3 texture_size)
 {
-    this->texture_position.z = layer;
+    this->texture_region = texture_region;
+    this->texture_position = texture_position;
+    this->texture_size = texture_size;
+
+    this->update_buffer();
+}
+
+/**
+ * Switch to another image in the atlas, keeping the same relative position.
+ */
+void Quad::set_texture_region(TextureRegion texture_region)
+{
+    this->texture_region = texture_region;
 
     this->update_buffer();
 }
@@ -153,8 +172,18 @@ void Quad::update_buffer()
 
 const std::vector<Vertex> Quad::get_data()
 {
-    Vector3 t = this->texture_position;
-    Vector3 u = this->texture_position + this->texture_size;
+    TextureRegion const& r = this->texture_region;
+
+    Vector3 t = Vector3(
+        r.u + this->texture_position.x * r.width,
+        r.v + this->texture_position.y * r.height,
+        r.page
+    );
+    Vector3 u = Vector3(
+        t.x + this->texture_size.x * r.width,
+        t.y + this->texture_size.y * r.height,
+        r.page
+    );
 
     Matrix bt = this->buffer_transform;
 
@@ -185,6 +214,11 @@ vk::Buffer const Quad::get_index_buffer()
     return *this->index_buffer.lock().get();
 }
 
+uint32_t Quad::get_texture_slot()
+{
+    return this->texture_region.slot;
+}
+
 /**
  * @param model_matrix the current model_matrix to manipulate for sizing and positioning.
  */
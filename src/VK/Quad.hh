@@ -11,6 +11,7 @@
 #include "../Object/Property/Drawable.hh"
 #include "../Object/Property/Movable.hh"
 #include "../Object/Property/Scalable.hh"
+#include "TextureRegion.hh"
 
 using namespace Animate::Geometry;
 using namespace Animate::Object::Property;
@@ -26,15 +27,24 @@ namespace Animate::VK
             void initialise_buffers() override;
 
             void set_texture_position(Vector3 texture_position, Vector3 texture_size = Vector3(1., 1., 0.));
-            void set_texture_layer(uint32_t layer);
+            void set_texture_position(
+                TextureRegion texture_region,
+                Vector3 texture_position = Vector3(0., 0., 0.),
+                Vector3 texture_size = Vector3(1., 1., 0.)
+            );
+            void set_texture_region(TextureRegion texture_region);
             void set_buffer_transform(Matrix transform);
 
             vk::Buffer const get_vertex_buffer() override;
             vk::Buffer const get_index_buffer() override;
+            uint32_t get_texture_slot() override;
 
             void set_model_matrix(Matrix model_matrix) override;
 
         protected:
+            TextureRegion texture_region;
+
+            //Relative to the texture region
             Vector3 texture_position;
             Vector3 texture_size = Vector3(1., 1., 0.);
             Matrix buffer_transform = Matrix::identity();
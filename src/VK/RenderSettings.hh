@@ -0,0 +1,81 @@
+#pragma once
+
+#define VULKAN_HPP_DISABLE_ENHANCED_MODE 1
+#include <vulkan/vulkan.hpp>
+
+namespace Animate::VK
+{
+    /**
+     * Rasterisation settings chosen per pipeline.
+     * Pipelines sharing a sample count are drawn in the same render pass.
+     */
+    struct RenderSettings {
+        //Any count above one becomes the highest the device supports. Multisampled passes resolve
+        //over the whole frame, so every multisampled pipeline has to share one count and pass.
+        vk::SampleCountFlagBits sample_count = vk::SampleCountFlagBits::e64;
+        bool sample_shading = true;
+        float min_sample_shading = .25f;
+
+        //Show textures at low resolution while their larger mip levels upload in the background
+        bool stream_textures = false;
+
+        //Reads Geometry::Instance data from a second vertex binding
+        bool instanced = false;
+
+        //Cells across and down of a TileMap sampled at binding 1, none if zero
+        uint32_t tile_map_width = 0;
+        uint32_t tile_map_height = 0;
+
+        /**
+         * Multisampled with sample shading, suited to geometry with lots of edges.
+         */
+        static RenderSettings multisampled()
+        {
+            return RenderSettings();
+        }
+
+        /**
+         * Multisampled, with textures streamed in so the animation can show sooner.
+         */
+        static RenderSettings streamed()
+        {
+            RenderSettings settings;
+            settings.stream_textures = true;
+            return settings;
+        }
+
+        /**
+         * Streamed, drawing many copies of one drawable from its instance buffer.
+         */
+        static RenderSettings instanced_streamed()
+        {
+            RenderSettings settings = RenderSettings::streamed();
+            settings.instanced = true;
+            return settings;
+        }
+
+        /**
+         * Streamed and single sampled, drawing a grid from a TileMap onto one quad.
+         * Cells are only edged by each other, so multisampling gains nothing.
+         */
+        static RenderSettings tile_mapped(uint32_t width, uint32_t height)
+        {
+            RenderSettings settings = RenderSettings::single_sampled();
+            settings.stream_textures = true;
+            settings.tile_map_width = width;
+            settings.tile_map_height = height;
+            return settings;
+        }
+
+        /**
+         * One sample per pixel, for full screen shaders that gain nothing from MSAA.
+         */
+        static RenderSettings single_sampled()
+        {
+            RenderSettings settings;
+            settings.sample_count = vk::SampleCountFlagBits::e1;
+            settings.sample_shading = false;
+            return settings;
+        }
+    };
+}
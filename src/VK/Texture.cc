@@ -1,269 +1,957 @@
 #include <iostream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <functional>
 
 #include "Texture.hh"
+#include "TextureContainer.hh"
 #include "Context.hh"
 #include "Buffer.hh"
 #include "../Utilities.hh"
+#include "../Tasks/ThreadPool.hh"
+#include "TextureTable.hh"
+#include "BlockDecoder.hh"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "../libs/stb_image.h"
 
 using namespace Animate::VK;
 
-Texture::Texture(std::weak_ptr<Context> context, std::vector<std::string> resources) : context(context)
+//Streamed textures upload levels no larger than this straight away
+static const uint32_t resident_size = 64;
+
+//Atlas rects are placed on this grid, keeping their first six mip levels aligned
+static const uint32_t atlas_granularity = 32;
+static const uint32_t max_atlas_page_size = 4096;
+
+/**
+ * Constructor.
+ * Packs the resources into an atlas over the layers of one array texture, with a mip chain.
+ *
+ * @param context   The graphics context.
+ * @param resources One resource per image, baked or not.
+ * @param slot      The texture table slot to point at the texture.
+ * @param streamed  Upload only the small levels now and the rest in the background.
+ */
+Texture::Texture(std::weak_ptr<Context> context, std::vector<std::string> resources, uint32_t slot, bool streamed) :
+    context(context),
+    slot(slot)
 {
     this->logical_device = context.lock()->logical_device;
 
-    std::vector<LayerData> layers = Texture::load_resources_as_layers(resources);
-
-    //Find the total size needed for the staging buffer.
-    vk::DeviceSize total_size = 0;
-    for(auto const& layer : layers) {
-        total_size += layer.size;
+    if (resources.empty()) {
+        throw std::runtime_error("A texture needs at least one image.");
     }
 
-    //Create the staging buffer.
-    VK::Buffer staging_buffer(
-        this->context.lock(),
-        total_size,
-        vk::BufferUsageFlagBits::eTransferSrc,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
-    );
+    std::shared_ptr<Tasks::ThreadPool> thread_pool = context.lock()->get_thread_pool();
+
+    //Checksum and read the headers of each image in parallel, no pixels are touched yet.
+    std::vector<ImageData> images(resources.size());
+    auto describe_images = [&images, &resources, &thread_pool](std::vector<vk::Format> const& formats) {
+        thread_pool->parallel_for(resources.size(), [&images, &resources, &formats](size_t i) {
+            auto start = std::chrono::steady_clock::now();
+            auto load_time = images[i].load_time;
+            images[i] = Texture::describe_image(resources[i], formats);
+            images[i].load_time = load_time + (std::chrono::steady_clock::now() - start);
+        });
+    };
+
+    describe_images(this->get_compressed_formats());
+
+    //Images can differ in size but are copied into the same image, so must share a format.
+    //If only some were baked, the baked ones are decoded to match the rest.
+    bool mixed_formats = std::any_of(images.begin(), images.end(), [&images](ImageData const& image) {
+        return image.format != images.front().format;
+    });
 
-    //Extend width & height.
-    int width=0, height=0;
+    if (mixed_formats) {
+        describe_images({});
+    }
 
-    //Copy each image into it.
-    size_t offset = 0;
-    void *data = staging_buffer.map();
-    for(auto const& layer : layers) {
-        memcpy(
-            (reinterpret_cast<unsigned char *>(data) + offset),
-            layer.pixels,
-            layer.size
-        );
-        offset += layer.size;
+    uint32_t provided_levels = images.front().levels.size();
+    for(auto const& image : images) {
+        if (image.format != images.front().format) {
+            throw std::runtime_error("Texture images differ in format.");
+        }
+        provided_levels = std::min<uint32_t>(provided_levels, image.levels.size());
+    }
 
-        width = std::max(width, layer.width);
-        height = std::max(height, layer.height);
+    this->format = images.front().format;
+    this->block_width = images.front().block_width;
+    this->block_height = images.front().block_height;
+    this->bytes_per_block = images.front().bytes_per_block;
 
-        //Free pixel memory
-        stbi_image_free(layer.pixels);
+    uint32_t aligned_levels = this->pack_atlas(images);
+    this->mip_levels = std::min(provided_levels, aligned_levels);
+
+    //Resources that weren't baked come with one level, the rest are blitted on the GPU if the format allows
+    if (provided_levels == 1 && aligned_levels > 1 && this->supports_mipmap_generation()) {
+        this->generate_mipmaps = true;
+        this->mip_levels = aligned_levels;
     }
-    staging_buffer.unmap();
 
-    this->create_image(width, height, layers.size());
-    this->copy_buffer_to_image(staging_buffer, layers, width, height);
-    this->create_image_view(layers.size());
+    //Generated chains come from the top level so can't be streamed
+    uint32_t resident_level = (streamed && !this->generate_mipmaps) ? Texture::get_resident_level(images, this->mip_levels) : 0;
+
+    this->create_image();
+    this->upload_levels(images, resident_level, (this->generate_mipmaps ? 1 : this->mip_levels) - resident_level);
+    this->image_view = this->create_image_view(resident_level);
     this->create_sampler();
+
+    //Shaders find the texture through its slot in the table
+    std::shared_ptr<TextureTable> texture_table = context.lock()->get_texture_table();
+    this->texture_table = texture_table;
+    texture_table->update(this->slot, this->image_view, this->sampler);
+    for (auto &region : this->regions) {
+        region.slot = this->slot;
+    }
+
+    for(auto const& image : images) {
+        std::cout << "Loaded Texture: " << image.resource_id << " (" << image.load_time.count() << "ms)" << std::endl;
+    }
+
+    if (resident_level == 0) {
+        return;
+    }
+
+    //The larger levels follow in the background and are swapped in by commit_streamed_view
+    this->streaming = thread_pool->submit([this, images, resident_level]() mutable {
+        try {
+            for(auto &image : images) {
+                image.load_time = {};
+            }
+
+            this->upload_levels(images, 0, resident_level);
+            vk::ImageView view = this->create_image_view(0);
+
+            {
+                std::lock_guard<std::mutex> guard(this->view_mutex);
+                this->streamed_view = view;
+            }
+
+            for(auto const& image : images) {
+                std::cout << "Streamed Texture: " << image.resource_id << " (" << image.load_time.count() << "ms)" << std::endl;
+            }
+        } catch (std::runtime_error const& e) {
+            std::cerr << "Couldn't stream texture levels: " << e.what() << std::endl;
+        }
+    });
 }
 
 Texture::~Texture()
 {
+    if (this->streaming.valid()) {
+        this->streaming.wait();
+    }
+
+    if (this->streamed_view) {
+        this->logical_device.destroyImageView(this->streamed_view, nullptr);
+    }
+
     this->logical_device.destroySampler(this->sampler, nullptr);
     this->logical_device.destroyImageView(this->image_view, nullptr);
     this->logical_device.destroyImage(this->image, nullptr);
     this->logical_device.freeMemory(this->memory, nullptr);
 }
 
-std::vector<LayerData> Texture::load_resources_as_layers(std::vector<std::string> resources)
+/**
+ * Place every image in the atlas, choosing the page size that needs the least memory.
+ *
+ * @param images The images, their rects are set.
+ *
+ * @return How many mip levels stay aligned to the packed rects.
+ */
+uint32_t Texture::pack_atlas(std::vector<ImageData> &images)
 {
-    std::vector<LayerData> layers;
+    vk::PhysicalDeviceProperties properties;
+    this->context.lock()->physical_device.getProperties(&properties);
+    uint32_t max_page_size = std::min(max_atlas_page_size, properties.limits.maxImageDimension2D);
+
+    //Tallest first packs tightest on a skyline
+    std::vector<size_t> order(images.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&images](size_t a, size_t b) {
+        return images[a].levels[0].height > images[b].levels[0].height;
+    });
 
-    for(auto const& resource_id : resources) {
-        LayerData layer;
+    uint32_t smallest_page_size = atlas_granularity;
+    for(auto const& image : images) {
+        while (smallest_page_size < std::max(image.levels[0].width, image.levels[0].height)) {
+            smallest_page_size *= 2;
+        }
+    }
 
-        size_t data_length;
-        uint8_t const *data = reinterpret_cast<const uint8_t*>(Utilities::get_resource_as_bytes(resource_id, &data_length));
+    if (smallest_page_size > max_page_size) {
+        throw std::runtime_error("Texture image is too large for an atlas page.");
+    }
 
-        layer.pixels = stbi_load_from_memory(
-            data,
-            static_cast<int>(data_length),
-            &layer.width,
-            &layer.height,
-            &layer.channels,
-            STBI_rgb_alpha
-        );
+    //Equally sized images fill pages of their own size best, mixed sizes share larger pages
+    uint64_t best_area = std::numeric_limits<uint64_t>::max();
+    for (uint32_t page_size = smallest_page_size; page_size <= max_page_size; page_size *= 2) {
+        AtlasPacker packer(page_size, atlas_granularity);
 
-        if (!layer.pixels) {
-            throw std::runtime_error("Couldn't load texture resource: " + resource_id + " (" + stbi_failure_reason() + ")");
-        } else {
-            std::cout << "Loaded Texture: " + resource_id << std::endl;
+        std::vector<AtlasRect> rects(images.size());
+        for(auto i : order) {
+            rects[i] = packer.add(images[i].levels[0].width, images[i].levels[0].height);
+        }
+
+        uint64_t area = static_cast<uint64_t>(page_size) * page_size * packer.get_page_count();
+        if (area > best_area || packer.get_page_count() > properties.limits.maxImageArrayLayers) {
+            continue;
+        }
+
+        best_area = area;
+        this->page_size = page_size;
+        this->page_count = packer.get_page_count();
+        for (size_t i = 0; i < images.size(); i++) {
+            images[i].rect = rects[i];
         }
 
-        layer.size = layer.width * layer.height * 4;
+        if (packer.get_page_count() == 1) {
+            break;
+        }
+    }
 
-        layers.push_back(layer);
+    if (best_area == std::numeric_limits<uint64_t>::max()) {
+        throw std::runtime_error("Texture needs more atlas pages than the device supports.");
     }
 
-    return layers;
-}
+    std::cout << "Packed " << images.size() << " images onto " << this->page_count << " "
+        << this->page_size << "px atlas pages (" << vk::to_string(this->format) << ")" << std::endl;
+
+    //Level n of an image is copied to its rect's offset halved n times, which has to stay on a whole block
+    uint32_t alignment = this->page_size;
+    this->regions.clear();
+    for(auto const& image : images) {
+        for (uint32_t offset : {image.rect.x, image.rect.y}) {
+            if (offset != 0) {
+                alignment = std::min(alignment, offset & (~offset + 1));
+            }
+        }
 
-vk::ImageView Texture::get_image_view()
-{
-    return this->image_view;
-}
+        TextureRegion region;
+        region.page = image.rect.page;
+        region.u = static_cast<float>(image.rect.x) / this->page_size;
+        region.v = static_cast<float>(image.rect.y) / this->page_size;
+        region.width = static_cast<float>(image.rect.width) / this->page_size;
+        region.height = static_cast<float>(image.rect.height) / this->page_size;
+        this->regions.push_back(region);
+    }
 
-vk::Sampler Texture::get_sampler()
-{
-    return this->sampler;
+    //Blocks are square
+    uint32_t levels = 0;
+    while ((this->block_width << levels) <= alignment) {
+        levels++;
+    }
+
+    return levels;
 }
 
-void Texture::create_image(uint32_t width, uint32_t height, uint32_t layers)
+/**
+ * Write a range of levels of every image to a staging buffer and copy them to the image.
+ * Layers are written in parallel, each straight to its offset in the mapped buffer.
+ *
+ * @param images      The images, their load times are added to.
+ * @param base_level  The first level to upload.
+ * @param level_count The number of levels to upload.
+ */
+void Texture::upload_levels(std::vector<ImageData> &images, uint32_t base_level, uint32_t level_count)
 {
-    vk::ImageCreateInfo create_info = vk::ImageCreateInfo()
-        .setImageType(vk::ImageType::e2D)
-        .setExtent({width, height, 1})
-        .setMipLevels(1)
-        .setArrayLayers(layers)
-        .setFormat(vk::Format::eR8G8B8A8Unorm)
-        .setTiling(vk::ImageTiling::eOptimal)
-        .setInitialLayout(vk::ImageLayout::ePreinitialized)
-        .setUsage(vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled)
-        .setSamples(vk::SampleCountFlagBits::e1)
-        .setSharingMode(vk::SharingMode::eExclusive);
-
     std::shared_ptr<Context> context = this->context.lock();
 
-    if (context->logical_device.createImage(&create_info, nullptr, &this->image) != vk::Result::eSuccess) {
-        throw std::runtime_error("Couldn't create image.");
+    //Compressed images can't be cleared, so are zeroed by copying from a blank level at the start of the buffer
+    bool compressed = this->block_width > 1;
+    std::vector<vk::BufferImageCopy> blank_regions;
+    vk::DeviceSize blank_size = 0;
+    if (compressed) {
+        uint32_t blocks_wide = ((this->page_size >> base_level) + this->block_width - 1) / this->block_width;
+        uint32_t blocks_high = ((this->page_size >> base_level) + this->block_height - 1) / this->block_height;
+        blank_size = static_cast<vk::DeviceSize>(blocks_wide) * blocks_high * this->bytes_per_block;
+
+        for (uint32_t level_index = base_level; level_index < base_level + level_count; level_index++) {
+            for (uint32_t page = 0; page < this->page_count; page++) {
+                blank_regions.push_back(
+                    vk::BufferImageCopy()
+                        .setBufferOffset(0)
+                        .setImageSubresource(
+                            vk::ImageSubresourceLayers()
+                                .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                                .setMipLevel(level_index)
+                                .setBaseArrayLayer(page)
+                                .setLayerCount(1)
+                        )
+                        .setImageOffset({0, 0, 0})
+                        .setImageExtent({this->page_size >> level_index, this->page_size >> level_index, 1})
+                );
+            }
+        }
     }
 
-    vk::MemoryRequirements memory_requirements;
-    context->logical_device.getImageMemoryRequirements(this->image, &memory_requirements);
+    //Lay out every level in the staging buffer up front so images can be written independently.
+    std::vector<vk::BufferImageCopy> copy_regions;
+    vk::DeviceSize total_size = blank_size;
+    for(auto &image : images) {
+        for (uint32_t level_index = base_level; level_index < base_level + level_count; level_index++) {
+            LevelData &level = image.levels[level_index];
+
+            level.staging_offset = TextureContainer::align(total_size, TextureContainer::level_alignment);
+            total_size = level.staging_offset + level.size;
+
+            copy_regions.push_back(
+                vk::BufferImageCopy()
+                    .setBufferOffset(level.staging_offset)
+                    .setBufferRowLength(level.row_pitch / image.bytes_per_block * image.block_width)
+                    .setBufferImageHeight(0)
+                    .setImageSubresource(
+                        vk::ImageSubresourceLayers()
+                            .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                            .setMipLevel(level_index)
+                            .setBaseArrayLayer(image.rect.page)
+                            .setLayerCount(1)
+                    )
+                    .setImageOffset({
+                        static_cast<int32_t>(image.rect.x >> level_index),
+                        static_cast<int32_t>(image.rect.y >> level_index),
+                        0
+                    })
+                    //Partial blocks are copied whole, the rect's padding has room for them
+                    .setImageExtent({
+                        static_cast<uint32_t>(TextureContainer::align(level.width, image.block_width)),
+                        static_cast<uint32_t>(TextureContainer::align(level.height, image.block_height)),
+                        1
+                    })
+            );
+        }
+    }
 
-    vk::MemoryAllocateInfo allocation_info = vk::MemoryAllocateInfo()
-        .setAllocationSize(memory_requirements.size)
-        .setMemoryTypeIndex(
-            context->find_memory_type(
-                memory_requirements.memoryTypeBits,
-                vk::MemoryPropertyFlagBits::eDeviceLocal
-            )
+    //Create the staging buffer.
+    VK::Buffer staging_buffer(
+        context,
+        total_size,
+        vk::BufferUsageFlagBits::eTransferSrc,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+    );
+
+    //Each image is copied or decoded straight into its place in the mapped buffer.
+    uint8_t *staging = reinterpret_cast<uint8_t *>(staging_buffer.map());
+    memset(staging, 0, blank_size);
+    context->get_thread_pool()->parallel_for(images.size(), [&images, staging, base_level, level_count](size_t i) {
+        auto start = std::chrono::steady_clock::now();
+        Texture::write_image(images[i], staging, base_level, level_count);
+        images[i].load_time += std::chrono::steady_clock::now() - start;
+    });
+    staging_buffer.unmap();
+
+    //Generated levels are written by the blits so start out as transfer destinations too
+    vk::ImageSubresourceRange subresource_range = vk::ImageSubresourceRange()
+        .setAspectMask(vk::ImageAspectFlagBits::eColor)
+        .setBaseMipLevel(base_level)
+        .setLevelCount(this->generate_mipmaps ? this->mip_levels : level_count)
+        .setBaseArrayLayer(0)
+        .setLayerCount(this->page_count);
+
+    vk::ImageMemoryBarrier transfer_barrier = vk::ImageMemoryBarrier()
+        .setOldLayout(vk::ImageLayout::eUndefined)
+        .setNewLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setSrcAccessMask(vk::AccessFlags())
+        .setDstAccessMask(vk::AccessFlagBits::eTransferWrite)
+        .setImage(this->image)
+        .setSubresourceRange(subresource_range);
+
+    vk::ImageMemoryBarrier shader_barrier = vk::ImageMemoryBarrier()
+        .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+        .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+        .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+        .setImage(this->image)
+        .setSubresourceRange(subresource_range);
+
+    //Space between packed images is cleared so filtering at their edges doesn't pick up garbage
+    vk::ClearColorValue clear_colour = vk::ClearColorValue().setFloat32({0.0f, 0.0f, 0.0f, 0.0f});
+
+    vk::ImageMemoryBarrier clear_barrier = vk::ImageMemoryBarrier()
+        .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setNewLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+        .setDstAccessMask(vk::AccessFlagBits::eTransferWrite)
+        .setImage(this->image)
+        .setSubresourceRange(subresource_range);
+
+    context->run_one_time_commands([&](vk::CommandBuffer command_buffer){
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTopOfPipe,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlags(),
+            0, nullptr,
+            0, nullptr,
+            1, &transfer_barrier
         );
 
-    if (context->logical_device.allocateMemory(&allocation_info, nullptr, &this->memory) != vk::Result::eSuccess) {
-        throw std::runtime_error("Couldn't allocate image memory.");
-    }
+        if (compressed) {
+            command_buffer.copyBufferToImage(
+                staging_buffer,
+                this->image,
+                vk::ImageLayout::eTransferDstOptimal,
+                blank_regions.size(),
+                blank_regions.data()
+            );
+        } else {
+            command_buffer.clearColorImage(
+                this->image,
+                vk::ImageLayout::eTransferDstOptimal,
+                &clear_colour,
+                1,
+                &subresource_range
+            );
+        }
 
-    context->logical_device.bindImageMemory(this->image, this->memory, 0);
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlags(),
+            0, nullptr,
+            0, nullptr,
+            1, &clear_barrier
+        );
+
+        command_buffer.copyBufferToImage(
+            staging_buffer,
+            this->image,
+            vk::ImageLayout::eTransferDstOptimal,
+            copy_regions.size(),
+            copy_regions.data()
+        );
+
+        if (this->generate_mipmaps) {
+            this->record_mipmap_generation(command_buffer);
+            return;
+        }
+
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eFragmentShader,
+            vk::DependencyFlags(),
+            0, nullptr,
+            0, nullptr,
+            1, &shader_barrier
+        );
+    });
 }
 
-void Texture::transition_image_layout(vk::ImageLayout old_layout, vk::ImageLayout new_layout, uint32_t layers)
+/**
+ * Fill every level below the first by halving the level above it, for all pages at once.
+ * Expects the whole chain in the transfer destination layout and leaves it ready to sample.
+ */
+void Texture::record_mipmap_generation(vk::CommandBuffer command_buffer)
 {
     vk::ImageMemoryBarrier barrier = vk::ImageMemoryBarrier()
-        .setOldLayout(old_layout)
-        .setNewLayout(new_layout)
         .setImage(this->image)
         .setSubresourceRange(
             vk::ImageSubresourceRange()
                 .setAspectMask(vk::ImageAspectFlagBits::eColor)
-                .setBaseMipLevel(0)
                 .setLevelCount(1)
                 .setBaseArrayLayer(0)
-                .setLayerCount(layers)
+                .setLayerCount(this->page_count)
         );
 
-    if (
-        old_layout == vk::ImageLayout::ePreinitialized &&
-        new_layout == vk::ImageLayout::eTransferDstOptimal
-    ) {
-        barrier
-            .setSrcAccessMask(vk::AccessFlagBits::eHostWrite)
-            .setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
-    } else if (
-        old_layout == vk::ImageLayout::eTransferDstOptimal &&
-        new_layout == vk::ImageLayout::eShaderReadOnlyOptimal
-    ) {
+    int32_t level_width = static_cast<int32_t>(this->page_size);
+    int32_t level_height = static_cast<int32_t>(this->page_size);
+
+    for (uint32_t level = 1; level < this->mip_levels; level++) {
+        int32_t next_width = std::max(level_width / 2, 1);
+        int32_t next_height = std::max(level_height / 2, 1);
+
+        //Read from the level above once its copy or blit has landed
+        barrier.subresourceRange.setBaseMipLevel(level - 1);
         barrier
+            .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+            .setNewLayout(vk::ImageLayout::eTransferSrcOptimal)
             .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+            .setDstAccessMask(vk::AccessFlagBits::eTransferRead);
+
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlags(),
+            0, nullptr,
+            0, nullptr,
+            1, &barrier
+        );
+
+        vk::ImageBlit blit = vk::ImageBlit()
+            .setSrcSubresource(
+                vk::ImageSubresourceLayers()
+                    .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                    .setMipLevel(level - 1)
+                    .setBaseArrayLayer(0)
+                    .setLayerCount(this->page_count)
+            )
+            .setDstSubresource(
+                vk::ImageSubresourceLayers()
+                    .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                    .setMipLevel(level)
+                    .setBaseArrayLayer(0)
+                    .setLayerCount(this->page_count)
+            );
+        blit.srcOffsets[0] = vk::Offset3D(0, 0, 0);
+        blit.srcOffsets[1] = vk::Offset3D(level_width, level_height, 1);
+        blit.dstOffsets[0] = vk::Offset3D(0, 0, 0);
+        blit.dstOffsets[1] = vk::Offset3D(next_width, next_height, 1);
+
+        command_buffer.blitImage(
+            this->image,
+            vk::ImageLayout::eTransferSrcOptimal,
+            this->image,
+            vk::ImageLayout::eTransferDstOptimal,
+            1,
+            &blit,
+            vk::Filter::eLinear
+        );
+
+        barrier
+            .setOldLayout(vk::ImageLayout::eTransferSrcOptimal)
+            .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+            .setSrcAccessMask(vk::AccessFlagBits::eTransferRead)
             .setDstAccessMask(vk::AccessFlagBits::eShaderRead);
-    } else {
-        throw std::runtime_error("Unsupported image layout transition requested.");
-    }
 
-    this->context.lock()->run_one_time_commands([&barrier](vk::CommandBuffer command_buffer){
         command_buffer.pipelineBarrier(
-            vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eHost,
-            vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eFragmentShader,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eFragmentShader,
             vk::DependencyFlags(),
             0, nullptr,
             0, nullptr,
             1, &barrier
         );
-    });
+
+        level_width = next_width;
+        level_height = next_height;
+    }
+
+    //The last level is only ever written to
+    barrier.subresourceRange.setBaseMipLevel(this->mip_levels - 1);
+    barrier
+        .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+        .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+        .setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+
+    command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eFragmentShader,
+        vk::DependencyFlags(),
+        0, nullptr,
+        0, nullptr,
+        1, &barrier
+    );
 }
 
-void Texture::copy_buffer_to_image(VK::Buffer &staging_buffer, std::vector<LayerData> layers, uint32_t width, uint32_t height)
+/**
+ * Whether the device can blit between levels of this texture's format with linear filtering.
+ */
+bool Texture::supports_mipmap_generation()
 {
-    this->transition_image_layout(
-        vk::ImageLayout::ePreinitialized,
-        vk::ImageLayout::eTransferDstOptimal,
-        layers.size()
+    vk::FormatFeatureFlags required =
+        vk::FormatFeatureFlagBits::eBlitSrc |
+        vk::FormatFeatureFlagBits::eBlitDst |
+        vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+
+    vk::FormatProperties properties;
+    this->context.lock()->physical_device.getFormatProperties(this->format, &properties);
+
+    return (properties.optimalTilingFeatures & required) == required;
+}
+
+/**
+ * Block compressed formats the device can sample and filter.
+ * Baked images use the first of their variants in this list, in the order they were baked.
+ */
+std::vector<vk::Format> Texture::get_compressed_formats()
+{
+    std::shared_ptr<Context> context = this->context.lock();
+
+    std::vector<vk::Format> candidates;
+    if (context->texture_compression_bc) {
+        candidates.push_back(vk::Format::eBc7UnormBlock);
+    }
+    if (context->texture_compression_etc2) {
+        candidates.push_back(vk::Format::eEtc2R8G8B8A8UnormBlock);
+    }
+
+    vk::FormatFeatureFlags required =
+        vk::FormatFeatureFlagBits::eSampledImage |
+        vk::FormatFeatureFlagBits::eSampledImageFilterLinear |
+        vk::FormatFeatureFlagBits::eTransferDst;
+
+    std::vector<vk::Format> formats;
+    for (vk::Format format : candidates) {
+        vk::FormatProperties properties;
+        context->physical_device.getFormatProperties(format, &properties);
+
+        if ((properties.optimalTilingFeatures & required) == required) {
+            formats.push_back(format);
+        }
+    }
+
+    return formats;
+}
+
+/**
+ * The first level at which every image is small enough to be uploaded straight away when streaming.
+ */
+uint32_t Texture::get_resident_level(std::vector<ImageData> const& images, uint32_t mip_levels)
+{
+    for (uint32_t i = 0; i < mip_levels; i++) {
+        bool small = std::all_of(images.begin(), images.end(), [i](ImageData const& image) {
+            return std::max(image.levels[i].width, image.levels[i].height) <= resident_size;
+        });
+
+        if (small) {
+            return i;
+        }
+    }
+
+    return mip_levels - 1;
+}
+
+/**
+ * Find an image's format and level sizes without decoding it.
+ *
+ * @param resource_id The image's resource.
+ * @param formats     Compressed formats the device can sample.
+ */
+ImageData Texture::describe_image(std::string const& resource_id, std::vector<vk::Format> const& formats)
+{
+    ResourceSpan data = Utilities::get_resource_as_bytes(resource_id);
+
+    ImageData image = (data.type == ResourceType::TEXTURE) ?
+        Texture::describe_baked_image(resource_id, data, formats) :
+        Texture::describe_encoded_image(resource_id, data);
+
+    image.resource_id = resource_id;
+    image.source = data;
+
+    return image;
+}
+
+/**
+ * Read a texture baked by texture-baker, the levels point straight into the pack.
+ * Uses the first variant the device can sample, or decodes ETC2 to RGBA8 if there's none.
+ */
+ImageData Texture::describe_baked_image(std::string const& resource_id, ResourceSpan data, std::vector<vk::Format> const& formats)
+{
+    TextureContainer::Header header;
+    if (data.size < sizeof(TextureContainer::Header)) {
+        throw std::runtime_error("Texture resource is truncated: " + resource_id);
+    }
+    memcpy(&header, data.data, sizeof(TextureContainer::Header));
+
+    if (memcmp(header.magic, TextureContainer::magic, 4) != 0 || header.version != TextureContainer::version) {
+        throw std::runtime_error("Texture resource has an unknown format: " + resource_id);
+    }
+
+    if (TextureContainer::mip_offset(header, header.variant_count, 0) > data.size ||
+        header.mip_levels == 0 ||
+        header.variant_count == 0
+    ) {
+        throw std::runtime_error("Texture resource is truncated: " + resource_id);
+    }
+
+    std::vector<TextureContainer::Variant> variants(header.variant_count);
+    memcpy(
+        variants.data(),
+        data.data + sizeof(TextureContainer::Header),
+        sizeof(TextureContainer::Variant) * header.variant_count
     );
 
-    std::vector<vk::BufferImageCopy> copy_regions;
-    size_t offset = 0;
-    uint32_t index = 0;
-
-    for(auto const& layer : layers) {
-        vk::BufferImageCopy copy_region = vk::BufferImageCopy()
-            .setBufferOffset(offset)
-            .setBufferRowLength(0)
-            .setBufferImageHeight(0)
-            .setImageSubresource(
-                vk::ImageSubresourceLayers()
-                    .setAspectMask(vk::ImageAspectFlagBits::eColor)
-                    .setMipLevel(0)
-                    .setBaseArrayLayer(index++)
-                    .setLayerCount(1)
-            )
-            .setImageOffset({0,0,0})
-            .setImageExtent({
-                static_cast<uint32_t>(layer.width),
-                static_cast<uint32_t>(layer.height),
-                1
-            });
+    auto find_variant = [&variants](std::function<bool(vk::Format)> usable) {
+        return std::find_if(variants.begin(), variants.end(), [&usable](TextureContainer::Variant const& variant) {
+            return usable(static_cast<vk::Format>(variant.format));
+        });
+    };
 
-        copy_regions.push_back(copy_region);
+    auto variant = find_variant([&formats](vk::Format format) {
+        return std::find(formats.begin(), formats.end(), format) != formats.end();
+    });
 
-        offset += layer.size;
+    bool decode = variant == variants.end();
+    if (decode) {
+        variant = find_variant([](vk::Format format) {
+            return format == vk::Format::eEtc2R8G8B8A8UnormBlock;
+        });
     }
 
-    this->context.lock()->run_one_time_commands([&](vk::CommandBuffer command_buffer){
-        command_buffer.copyBufferToImage(
-            staging_buffer,
-            image,
-            vk::ImageLayout::eTransferDstOptimal,
-            copy_regions.size(),
-            copy_regions.data()
+    if (variant == variants.end()) {
+        throw std::runtime_error("Texture resource has no format the device can use: " + resource_id);
+    }
+
+    ImageData image;
+    image.source_format = static_cast<vk::Format>(variant->format);
+    if (decode) {
+        image.format = vk::Format::eR8G8B8A8Unorm;
+        image.bytes_per_block = 4;
+    } else {
+        image.format = image.source_format;
+        image.block_width = variant->block_width;
+        image.block_height = variant->block_height;
+        image.bytes_per_block = variant->bytes_per_block;
+    }
+
+    for (uint32_t i = 0; i < header.mip_levels; i++) {
+        TextureContainer::Mip mip;
+        memcpy(
+            &mip,
+            data.data + TextureContainer::mip_offset(header, variant - variants.begin(), i),
+            sizeof(TextureContainer::Mip)
         );
-    });
 
-    this->transition_image_layout(
-        vk::ImageLayout::eTransferDstOptimal,
-        vk::ImageLayout::eShaderReadOnlyOptimal,
-        layers.size()
+        if (mip.offset + mip.size > data.size) {
+            throw std::runtime_error("Texture resource is truncated: " + resource_id);
+        }
+
+        LevelData level;
+        level.pixels = data.data + mip.offset;
+        level.width = mip.width;
+        level.height = mip.height;
+
+        if (decode) {
+            level.source_row_pitch = mip.row_pitch;
+            level.row_pitch = mip.width * 4;
+            level.size = static_cast<uint64_t>(level.row_pitch) * level.height;
+        } else {
+            level.row_pitch = mip.row_pitch;
+            level.size = mip.size;
+        }
+
+        image.levels.push_back(level);
+    }
+
+    return image;
+}
+
+/**
+ * Read the size of an image that wasn't baked, it's decoded to a single level later.
+ */
+ImageData Texture::describe_encoded_image(std::string const& resource_id, ResourceSpan data)
+{
+    int width, height, channels;
+
+    if (!stbi_info_from_memory(data.data, static_cast<int>(data.size), &width, &height, &channels)) {
+        throw std::runtime_error("Couldn't load texture resource: " + resource_id + " (" + stbi_failure_reason() + ")");
+    }
+
+    ImageData image;
+    image.source_format = vk::Format::eR8G8B8A8Unorm;
+    image.format = vk::Format::eR8G8B8A8Unorm;
+    image.bytes_per_block = 4;
+
+    LevelData level;
+    level.width = static_cast<uint32_t>(width);
+    level.height = static_cast<uint32_t>(height);
+    level.row_pitch = level.width * 4;
+    level.size = static_cast<uint64_t>(level.row_pitch) * level.height;
+
+    image.levels.push_back(level);
+
+    return image;
+}
+
+/**
+ * Write a range of levels of an image to their offsets in the staging buffer.
+ * Baked levels are copied from the pack or transcoded, anything else is decoded first.
+ */
+void Texture::write_image(ImageData const& image, uint8_t *staging, uint32_t base_level, uint32_t level_count)
+{
+    if (image.source.type == ResourceType::TEXTURE) {
+        for (uint32_t i = base_level; i < base_level + level_count; i++) {
+            LevelData const& level = image.levels[i];
+
+            if (image.source_format == image.format) {
+                memcpy(staging + level.staging_offset, level.pixels, level.size);
+            } else {
+                BlockDecoder::decode_etc2_rgba(
+                    level.pixels,
+                    level.source_row_pitch,
+                    level.width,
+                    level.height,
+                    staging + level.staging_offset,
+                    level.row_pitch
+                );
+            }
+        }
+        return;
+    }
+
+    //stb can't decode into our memory, so this is the one extra copy
+    int width, height, channels;
+    stbi_uc *pixels = stbi_load_from_memory(
+        image.source.data,
+        static_cast<int>(image.source.size),
+        &width,
+        &height,
+        &channels,
+        STBI_rgb_alpha
     );
+
+    if (!pixels) {
+        throw std::runtime_error("Couldn't load texture resource: " + image.resource_id + " (" + stbi_failure_reason() + ")");
+    }
+
+    LevelData const& level = image.levels[0];
+    if (static_cast<uint32_t>(width) != level.width || static_cast<uint32_t>(height) != level.height) {
+        stbi_image_free(pixels);
+        throw std::runtime_error("Texture resource decoded to an unexpected size: " + image.resource_id);
+    }
+
+    memcpy(staging + level.staging_offset, pixels, level.size);
+    stbi_image_free(pixels);
+}
+
+vk::ImageView Texture::get_image_view()
+{
+    std::lock_guard<std::mutex> guard(this->view_mutex);
+    return this->image_view;
+}
+
+vk::Sampler Texture::get_sampler()
+{
+    return this->sampler;
+}
+
+/**
+ * Where a resource was packed.
+ *
+ * @param index The resource's position in the list the texture was created with.
+ */
+TextureRegion Texture::get_region(size_t index) const
+{
+    return this->regions.at(index);
+}
+
+/**
+ * Device memory held by the image.
+ */
+vk::DeviceSize Texture::get_memory_size() const
+{
+    return this->memory_size;
+}
+
+/**
+ * Whether the larger levels are still being uploaded in the background.
+ */
+bool Texture::is_streaming() const
+{
+    return this->streaming.valid() &&
+        this->streaming.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+/**
+ * Whether streaming has finished and a view over the full mip chain is waiting.
+ */
+bool Texture::has_streamed_view()
+{
+    std::lock_guard<std::mutex> guard(this->view_mutex);
+    return static_cast<bool>(this->streamed_view);
 }
 
-void Texture::create_image_view(uint32_t layers)
+/**
+ * Swap in the view over the full mip chain once streaming has finished.
+ * The old view is destroyed, so no submitted work may still be using it.
+ *
+ * @return Whether the view changed, descriptors using the old one need rewriting.
+ */
+bool Texture::commit_streamed_view()
+{
+    std::lock_guard<std::mutex> guard(this->view_mutex);
+
+    if (!this->streamed_view) {
+        return false;
+    }
+
+    this->logical_device.destroyImageView(this->image_view, nullptr);
+    this->image_view = this->streamed_view;
+    this->streamed_view = nullptr;
+
+    if (std::shared_ptr<TextureTable> texture_table = this->texture_table.lock()) {
+        texture_table->update(this->slot, this->image_view, this->sampler);
+    }
+
+    return true;
+}
+
+void Texture::create_image()
+{
+    vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled;
+    if (this->generate_mipmaps) {
+        usage |= vk::ImageUsageFlagBits::eTransferSrc;
+    }
+
+    vk::ImageCreateInfo create_info = vk::ImageCreateInfo()
+        .setImageType(vk::ImageType::e2D)
+        .setExtent({this->page_size, this->page_size, 1})
+        .setMipLevels(this->mip_levels)
+        .setArrayLayers(this->page_count)
+        .setFormat(this->format)
+        .setTiling(vk::ImageTiling::eOptimal)
+        .setInitialLayout(vk::ImageLayout::eUndefined)
+        .setUsage(usage)
+        .setSamples(vk::SampleCountFlagBits::e1)
+        .setSharingMode(vk::SharingMode::eExclusive);
+
+    std::shared_ptr<Context> context = this->context.lock();
+
+    if (context->logical_device.createImage(&create_info, nullptr, &this->image) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create image.");
+    }
+
+    vk::MemoryRequirements memory_requirements;
+    context->logical_device.getImageMemoryRequirements(this->image, &memory_requirements);
+
+    vk::MemoryAllocateInfo allocation_info = vk::MemoryAllocateInfo()
+        .setAllocationSize(memory_requirements.size)
+        .setMemoryTypeIndex(
+            context->find_memory_type(
+                memory_requirements.memoryTypeBits,
+                vk::MemoryPropertyFlagBits::eDeviceLocal
+            )
+        );
+
+    if (context->logical_device.allocateMemory(&allocation_info, nullptr, &this->memory) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't allocate image memory.");
+    }
+
+    context->logical_device.bindImageMemory(this->image, this->memory, 0);
+    this->memory_size = memory_requirements.size;
+}
+
+/**
+ * Create a view of every image from the given level down.
+ *
+ * @param base_level The largest level the view includes.
+ */
+vk::ImageView Texture::create_image_view(uint32_t base_level)
 {
     vk::ImageViewCreateInfo view_info = vk::ImageViewCreateInfo()
         .setImage(this->image)
         .setViewType(vk::ImageViewType::e2DArray)
-        .setFormat(vk::Format::eR8G8B8A8Unorm)
+        .setFormat(this->format)
         .setSubresourceRange(
             vk::ImageSubresourceRange()
                 .setAspectMask(vk::ImageAspectFlagBits::eColor)
-                .setBaseMipLevel(0)
-                .setLevelCount(1)
+                .setBaseMipLevel(base_level)
+                .setLevelCount(this->mip_levels - base_level)
                 .setBaseArrayLayer(0)
-                .setLayerCount(layers)
+                .setLayerCount(this->page_count)
         );
 
-    if (this->context.lock()->logical_device.createImageView(&view_info, nullptr, &this->image_view) != vk::Result::eSuccess) {
+    vk::ImageView image_view;
+    if (this->logical_device.createImageView(&view_info, nullptr, &image_view) != vk::Result::eSuccess) {
         throw std::runtime_error("Couldn't create texture image view.");
     }
+
+    return image_view;
 }
 
 void Texture::create_sampler()
@@ -271,9 +959,9 @@ void Texture::create_sampler()
     vk::SamplerCreateInfo create_info = vk::SamplerCreateInfo()
         .setMagFilter(vk::Filter::eLinear)
         .setMinFilter(vk::Filter::eLinear)
-        .setAddressModeU(vk::SamplerAddressMode::eRepeat)
-        .setAddressModeV(vk::SamplerAddressMode::eRepeat)
-        .setAddressModeW(vk::SamplerAddressMode::eRepeat)
+        .setAddressModeU(vk::SamplerAddressMode::eClampToEdge)
+        .setAddressModeV(vk::SamplerAddressMode::eClampToEdge)
+        .setAddressModeW(vk::SamplerAddressMode::eClampToEdge)
         .setAnisotropyEnable(VK_TRUE)
         .setMaxAnisotropy(16)
         .setBorderColor(vk::BorderColor::eIntOpaqueBlack)
@@ -283,7 +971,7 @@ void Texture::create_sampler()
         .setMipmapMode(vk::SamplerMipmapMode::eLinear)
         .setMipLodBias(0.0f)
         .setMinLod(0.0f)
-        .setMaxLod(0.0f);
+        .setMaxLod(static_cast<float>(this->mip_levels));
 
     if (this->context.lock()->logical_device.createSampler(&create_info, nullptr, &this->sampler) != vk::Result::eSuccess) {
         throw std::runtime_error("Couldn't create texture sampler.");
@@ -6,30 +6,73 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <chrono>
+#include <mutex>
+#include <future>
 
-#include "../libs/stb_image.h"
+#include "../Resources.hh"
+#include "AtlasPacker.hh"
+#include "TextureRegion.hh"
 
 namespace Animate::VK
 {
     class Context;
     class Buffer;
+    class TextureTable;
 
-    struct LayerData {
-        size_t size;
-        int width;
-        int height;
-        int channels;
-        stbi_uc *pixels;
+    /**
+     * One mip level of an image and where it goes in the staging buffer.
+     */
+    struct LevelData {
+        //Points into the resource pack, null until decoded if the image wasn't baked
+        uint8_t const *pixels = nullptr;
+        uint64_t size;
+        uint32_t width;
+        uint32_t height;
+        uint32_t row_pitch;
+        uint64_t staging_offset = 0;
+
+        //Bytes between rows of blocks in the pack, for levels decoded on the CPU
+        uint32_t source_row_pitch = 0;
+    };
+
+    /**
+     * A source image and where it was packed in the atlas.
+     */
+    struct ImageData {
+        std::string resource_id;
+        ResourceSpan source;
+
+        //Differ when the device can't sample any baked variant and ETC2 is decoded to RGBA8
+        vk::Format source_format;
+        vk::Format format;
+
+        uint32_t block_width = 1;
+        uint32_t block_height = 1;
+        uint32_t bytes_per_block;
+        std::vector<LevelData> levels;
+        AtlasRect rect;
+        std::chrono::duration<double, std::milli> load_time{0};
     };
 
+    /**
+     * An atlas of images packed onto the layers of an array texture.
+     * Shaders sample it through a texture table slot reserved by its owner, see Textures.
+     */
     class Texture
     {
         public:
-            Texture(std::weak_ptr<Context> context, std::vector<std::string> resources);
+            Texture(std::weak_ptr<Context> context, std::vector<std::string> resources, uint32_t slot, bool streamed = false);
             ~Texture();
 
             vk::ImageView get_image_view();
             vk::Sampler get_sampler();
+            TextureRegion get_region(size_t index) const;
+            vk::DeviceSize get_memory_size() const;
+            bool is_streaming() const;
+
+            bool has_streamed_view();
+            bool commit_streamed_view();
 
         private:
             std::weak_ptr<Context> context;
@@ -38,13 +81,43 @@ namespace Animate::VK
             vk::DeviceMemory memory;
             vk::ImageView image_view;
             vk::Sampler sampler;
+            vk::DeviceSize memory_size = 0;
+
+            vk::Format format;
+            uint32_t block_width = 1;
+            uint32_t block_height = 1;
+            uint32_t bytes_per_block = 4;
+            uint32_t mip_levels;
+            uint32_t page_size;
+            uint32_t page_count;
+
+            //Where each resource was packed, in the order given
+            std::vector<TextureRegion> regions;
+
+            std::weak_ptr<TextureTable> texture_table;
+            uint32_t slot = 0;
+
+            //Set when the resources carry a single level and the rest are blitted on upload
+            bool generate_mipmaps = false;
+
+            //The full mip chain, waiting for commit_streamed_view once the background upload finishes
+            std::mutex view_mutex;
+            vk::ImageView streamed_view;
+            std::future<void> streaming;
 
-            void create_image(uint32_t width, uint32_t height, uint32_t layers);
-            void transition_image_layout(vk::ImageLayout old_layout, vk::ImageLayout new_layout, uint32_t layers);
-            void copy_buffer_to_image(VK::Buffer &staging_buffer, std::vector<LayerData> layers, uint32_t width, uint32_t height);
-            void create_image_view(uint32_t layers);
+            uint32_t pack_atlas(std::vector<ImageData> &images);
+            void create_image();
+            void upload_levels(std::vector<ImageData> &images, uint32_t base_level, uint32_t level_count);
+            void record_mipmap_generation(vk::CommandBuffer command_buffer);
+            vk::ImageView create_image_view(uint32_t base_level);
             void create_sampler();
+            bool supports_mipmap_generation();
+            std::vector<vk::Format> get_compressed_formats();
 
-            static std::vector<LayerData> load_resources_as_layers(std::vector<std::string> resources);
+            static uint32_t get_resident_level(std::vector<ImageData> const& images, uint32_t mip_levels);
+            static ImageData describe_image(std::string const& resource_id, std::vector<vk::Format> const& formats);
+            static ImageData describe_baked_image(std::string const& resource_id, ResourceSpan data, std::vector<vk::Format> const& formats);
+            static ImageData describe_encoded_image(std::string const& resource_id, ResourceSpan data);
+            static void write_image(ImageData const& image, uint8_t *staging, uint32_t base_level, uint32_t level_count);
     };
 }
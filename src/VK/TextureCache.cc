@@ -0,0 +1,165 @@
+#include <iostream>
+#include <algorithm>
+
+#include "TextureCache.hh"
+#include "Textures.hh"
+
+using namespace Animate::VK;
+
+/**
+ * Constructor.
+ *
+ * @param budget Bytes of device memory textures may hold, pinned textures are kept even past it.
+ */
+TextureCache::TextureCache(vk::DeviceSize budget) : budget(budget)
+{
+}
+
+void TextureCache::set_budget(vk::DeviceSize budget)
+{
+    {
+        std::lock_guard<std::mutex> guard(this->mutex);
+        this->budget = budget;
+    }
+
+    this->trim();
+}
+
+vk::DeviceSize TextureCache::get_budget()
+{
+    std::lock_guard<std::mutex> guard(this->mutex);
+    return this->budget;
+}
+
+/**
+ * Start tracking a pipeline's textures, they're only loaded once used.
+ */
+void TextureCache::add(std::weak_ptr<Textures> textures)
+{
+    std::lock_guard<std::mutex> guard(this->mutex);
+
+    Entry entry;
+    entry.textures = textures;
+    this->entries.push_front(entry);
+}
+
+/**
+ * Pin the textures of an animation being loaded so they can't be evicted.
+ */
+void TextureCache::pin(std::vector< std::shared_ptr<Textures> > const& set)
+{
+    std::lock_guard<std::mutex> guard(this->mutex);
+    for (auto const& textures : set) {
+        this->touch(textures)->pins++;
+    }
+}
+
+/**
+ * Unpin the textures of an animation being unloaded, they're kept until the budget runs out.
+ */
+void TextureCache::unpin(std::vector< std::shared_ptr<Textures> > const& set)
+{
+    {
+        std::lock_guard<std::mutex> guard(this->mutex);
+        for (auto const& textures : set) {
+            auto entry = this->touch(textures);
+            if (entry->pins > 0) {
+                entry->pins--;
+            }
+        }
+    }
+
+    this->trim();
+}
+
+/**
+ * Load any textures that aren't resident, blocking until they are, then trim back to the budget.
+ */
+void TextureCache::load(std::vector< std::shared_ptr<Textures> > const& set)
+{
+    for (auto const& textures : set) {
+        textures->make_resident();
+    }
+
+    this->trim();
+}
+
+bool TextureCache::has_retired()
+{
+    std::lock_guard<std::mutex> guard(this->mutex);
+    return !this->retired.empty();
+}
+
+/**
+ * Hand over evicted textures to be destroyed, only once the queue is idle.
+ */
+std::vector< std::shared_ptr<Texture> > TextureCache::take_retired()
+{
+    std::lock_guard<std::mutex> guard(this->mutex);
+
+    std::vector< std::shared_ptr<Texture> > retired;
+    retired.swap(this->retired);
+    return retired;
+}
+
+/**
+ * Move textures to the most recently used end, tracking them if they weren't already.
+ */
+std::list<TextureCache::Entry>::iterator TextureCache::touch(std::shared_ptr<Textures> const& textures)
+{
+    auto entry = std::find_if(this->entries.begin(), this->entries.end(), [&textures](Entry const& entry) {
+        return entry.textures.lock() == textures;
+    });
+
+    if (entry == this->entries.end()) {
+        Entry new_entry;
+        new_entry.textures = textures;
+        return this->entries.insert(this->entries.end(), new_entry);
+    }
+
+    this->entries.splice(this->entries.end(), this->entries, entry);
+    return entry;
+}
+
+/**
+ * Evict unpinned textures, least recently used first, until everything resident fits in the budget.
+ */
+void TextureCache::trim()
+{
+    std::lock_guard<std::mutex> guard(this->mutex);
+
+    vk::DeviceSize resident_size = 0;
+    for (auto it = this->entries.begin(); it != this->entries.end();) {
+        std::shared_ptr<Textures> textures = it->textures.lock();
+
+        //Forget textures whose pipeline is gone
+        if (!textures) {
+            it = this->entries.erase(it);
+            continue;
+        }
+
+        resident_size += textures->get_memory_size();
+        it++;
+    }
+
+    for (auto &entry : this->entries) {
+        if (resident_size <= this->budget) {
+            break;
+        }
+
+        if (entry.pins > 0) {
+            continue;
+        }
+
+        std::shared_ptr<Textures> textures = entry.textures.lock();
+        std::shared_ptr<Texture> texture = textures->evict();
+        if (!texture) {
+            continue;
+        }
+
+        std::cout << "Evicted texture: " << (texture->get_memory_size() >> 20) << "MiB" << std::endl;
+
+        resident_size -= texture->get_memory_size();
+        this->retired.push_back(texture);
+    }
+}
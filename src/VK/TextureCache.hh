@@ -0,0 +1,59 @@
+#pragma once
+
+#define VULKAN_HPP_DISABLE_ENHANCED_MODE 1
+#include <vulkan/vulkan.hpp>
+
+#include <memory>
+#include <mutex>
+#include <list>
+#include <vector>
+
+namespace Animate::VK
+{
+    class Texture;
+    class Textures;
+
+    /**
+     * Decides which Textures stay on the GPU.
+     *
+     * Textures in use by a loaded animation are pinned. The rest stay loaded while everything
+     * fits in the budget and are evicted least recently used first once it doesn't.
+     * Evicted textures are destroyed by the render loop once no frame can be using them,
+     * see Context::update_texture_descriptors.
+     */
+    class TextureCache
+    {
+        public:
+            TextureCache(vk::DeviceSize budget);
+
+            void set_budget(vk::DeviceSize budget);
+            vk::DeviceSize get_budget();
+
+            void add(std::weak_ptr<Textures> textures);
+
+            void pin(std::vector< std::shared_ptr<Textures> > const& set);
+            void unpin(std::vector< std::shared_ptr<Textures> > const& set);
+            void load(std::vector< std::shared_ptr<Textures> > const& set);
+
+            bool has_retired();
+            std::vector< std::shared_ptr<Texture> > take_retired();
+
+        private:
+            struct Entry {
+                std::weak_ptr<Textures> textures;
+                uint32_t pins = 0;
+            };
+
+            std::mutex mutex;
+            vk::DeviceSize budget;
+
+            //Least recently used first
+            std::list<Entry> entries;
+
+            //Evicted but maybe still sampled by frames in flight
+            std::vector< std::shared_ptr<Texture> > retired;
+
+            std::list<Entry>::iterator touch(std::shared_ptr<Textures> const& textures);
+            void trim();
+    };
+}
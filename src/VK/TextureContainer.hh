@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Animate::VK
+{
+    /**
+     * Layout of textures baked by the texture-baker tool.
+     *
+     * A header, one Variant per encoding of the image, then for each variant one Mip per
+     * mip level (largest first), then each level's blocks. Levels start on a
+     * TextureContainer::level_alignment byte boundary and rows of blocks are padded to
+     * TextureContainer::row_pitch_alignment bytes, so each level can be copied to a staging
+     * buffer as is and uploaded with a single buffer to image copy.
+     *
+     * Variants are ordered by preference. ETC2 is always present, so a device that can't
+     * sample any of them can still decode it on the CPU.
+     */
+    namespace TextureContainer
+    {
+        static const char magic[4] = {'A', 'N', 'T', 'X'};
+        static const uint32_t version = 2;
+
+        static const uint32_t level_alignment = 16;
+        static const uint32_t row_pitch_alignment = 256;
+
+        //Values match VkFormat
+        enum Format : uint32_t {
+            RGBA8_UNORM = 37,
+            BC7_UNORM = 145,
+            ETC2_RGBA8_UNORM = 151
+        };
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint32_t width;
+            uint32_t height;
+            uint32_t mip_levels;
+            uint32_t variant_count;
+            uint32_t reserved[2];
+        };
+
+        //Texels are stored in blocks, uncompressed formats have 1x1 blocks
+        struct Variant {
+            uint32_t format;
+            uint32_t block_width;
+            uint32_t block_height;
+            uint32_t bytes_per_block;
+            uint32_t reserved[4];
+        };
+
+        struct Mip {
+            uint64_t offset;
+            uint64_t size;
+            uint32_t width;
+            uint32_t height;
+            uint32_t row_pitch;
+            uint32_t reserved;
+        };
+
+        static_assert(sizeof(Header) == 32, "Texture header layout is fixed");
+        static_assert(sizeof(Variant) == 32, "Texture variant layout is fixed");
+        static_assert(sizeof(Mip) == 32, "Texture mip layout is fixed");
+
+        inline uint64_t align(uint64_t value, uint64_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        /**
+         * Where the Mip describing a level of a variant is stored.
+         */
+        inline uint64_t mip_offset(Header const& header, uint32_t variant, uint32_t level)
+        {
+            return sizeof(Header) +
+                sizeof(Variant) * header.variant_count +
+                sizeof(Mip) * (static_cast<uint64_t>(variant) * header.mip_levels + level);
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Animate::VK
+{
+    /**
+     * Where an image sits: its texture's slot in the texture table, an array layer of that
+     * texture and a rectangle in normalised coordinates.
+     */
+    struct TextureRegion {
+        uint32_t slot = 0;
+        uint32_t page = 0;
+        float u = 0.f;
+        float v = 0.f;
+        float width = 1.f;
+        float height = 1.f;
+
+        bool operator==(TextureRegion const& other) const
+        {
+            return this->slot == other.slot &&
+                this->page == other.page &&
+                this->u == other.u &&
+                this->v == other.v &&
+                this->width == other.width &&
+                this->height == other.height;
+        }
+
+        bool operator!=(TextureRegion const& other) const
+        {
+            return !(*this == other);
+        }
+    };
+}
@@ -0,0 +1,314 @@
+#include <stdexcept>
+
+#include "TextureTable.hh"
+#include "Context.hh"
+
+using namespace Animate::VK;
+
+/**
+ * Constructor.
+ * Allocates the table's set from the layout the context made for it and fills every slot with the fallback.
+ */
+TextureTable::TextureTable(std::weak_ptr<Context> context) : context(context)
+{
+    std::shared_ptr<Context> shared_context = context.lock();
+
+    this->logical_device = shared_context->logical_device;
+    this->slot_count = shared_context->texture_table_size;
+    this->update_after_bind = shared_context->descriptor_indexing;
+
+    this->create_descriptor_set();
+    this->create_fallback_texture();
+
+    for (uint32_t slot = 0; slot < this->slot_count; slot++) {
+        this->pending_writes[slot] = {this->fallback_view, this->fallback_sampler};
+    }
+    this->flush();
+}
+
+TextureTable::~TextureTable()
+{
+    this->logical_device.destroyDescriptorPool(this->descriptor_pool, nullptr);
+    this->logical_device.destroySampler(this->fallback_sampler, nullptr);
+    this->logical_device.destroyImageView(this->fallback_view, nullptr);
+    this->logical_device.destroyImage(this->fallback_image, nullptr);
+    this->logical_device.freeMemory(this->fallback_memory, nullptr);
+}
+
+vk::DescriptorSet TextureTable::get_descriptor_set() const
+{
+    return this->descriptor_set;
+}
+
+uint32_t TextureTable::get_slot_count() const
+{
+    return this->slot_count;
+}
+
+/**
+ * Take a free slot for a texture, reusing released slots first.
+ * The slot samples the fallback until the next flush.
+ *
+ * @return The slot, to be pushed with draws using the texture.
+ */
+uint32_t TextureTable::allocate(vk::ImageView image_view, vk::Sampler sampler)
+{
+    std::lock_guard<std::mutex> guard(this->mutex);
+
+    uint32_t slot;
+    if (!this->free_slots.empty()) {
+        slot = this->free_slots.back();
+        this->free_slots.pop_back();
+    } else if (this->next_slot < this->slot_count) {
+        slot = this->next_slot++;
+    } else {
+        throw std::runtime_error("Texture table is full.");
+    }
+
+    this->pending_writes[slot] = {image_view, sampler};
+
+    return slot;
+}
+
+/**
+ * Take a free slot that samples the fallback until a texture is loaded into it.
+ */
+uint32_t TextureTable::reserve()
+{
+    return this->allocate(this->fallback_view, this->fallback_sampler);
+}
+
+/**
+ * Point a slot at a new view, e.g. once a streamed texture has its full mip chain.
+ */
+void TextureTable::update(uint32_t slot, vk::ImageView image_view, vk::Sampler sampler)
+{
+    std::lock_guard<std::mutex> guard(this->mutex);
+    this->pending_writes[slot] = {image_view, sampler};
+}
+
+/**
+ * Point a slot back at the fallback without giving it up, e.g. while its texture is evicted.
+ */
+void TextureTable::clear(uint32_t slot)
+{
+    this->update(slot, this->fallback_view, this->fallback_sampler);
+}
+
+/**
+ * Return a slot to the free list, it samples the fallback until reused.
+ */
+void TextureTable::release(uint32_t slot)
+{
+    if (slot == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(this->mutex);
+    this->pending_writes[slot] = {this->fallback_view, this->fallback_sampler};
+    this->free_slots.push_back(slot);
+}
+
+bool TextureTable::has_pending_writes()
+{
+    std::lock_guard<std::mutex> guard(this->mutex);
+    return !this->pending_writes.empty();
+}
+
+/**
+ * Without update after bind the set can't change while any submitted frame uses it.
+ */
+bool TextureTable::writes_need_idle_queue() const
+{
+    return !this->update_after_bind;
+}
+
+/**
+ * Write every pending slot to the set.
+ * Called from the render thread between frames, see Context::update_texture_descriptors.
+ */
+void TextureTable::flush()
+{
+    std::lock_guard<std::mutex> guard(this->mutex);
+
+    if (this->pending_writes.empty()) {
+        return;
+    }
+
+    std::vector<vk::DescriptorImageInfo> image_infos;
+    image_infos.reserve(this->pending_writes.size());
+
+    std::vector<vk::WriteDescriptorSet> descriptor_writes;
+    descriptor_writes.reserve(this->pending_writes.size());
+
+    for (auto const& write : this->pending_writes) {
+        image_infos.push_back(
+            vk::DescriptorImageInfo()
+                .setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+                .setImageView(write.second.image_view)
+                .setSampler(write.second.sampler)
+        );
+
+        descriptor_writes.push_back(
+            vk::WriteDescriptorSet()
+                .setDstSet(this->descriptor_set)
+                .setDstBinding(0)
+                .setDstArrayElement(write.first)
+                .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+                .setDescriptorCount(1)
+                .setPImageInfo(&image_infos.back())
+        );
+    }
+
+    this->logical_device.updateDescriptorSets(descriptor_writes.size(), descriptor_writes.data(), 0, nullptr);
+    this->pending_writes.clear();
+}
+
+void TextureTable::create_descriptor_set()
+{
+    std::shared_ptr<Context> context = this->context.lock();
+
+    vk::DescriptorPoolSize pool_size = vk::DescriptorPoolSize()
+        .setType(vk::DescriptorType::eCombinedImageSampler)
+        .setDescriptorCount(this->slot_count);
+
+    vk::DescriptorPoolCreateInfo pool_create_info = vk::DescriptorPoolCreateInfo()
+        .setPoolSizeCount(1)
+        .setPPoolSizes(&pool_size)
+        .setMaxSets(1);
+
+    if (this->update_after_bind) {
+        pool_create_info.setFlags(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBindEXT);
+    }
+
+    if (this->logical_device.createDescriptorPool(&pool_create_info, nullptr, &this->descriptor_pool) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create texture table descriptor pool.");
+    }
+
+    vk::DescriptorSetAllocateInfo allocation_info = vk::DescriptorSetAllocateInfo()
+        .setDescriptorPool(this->descriptor_pool)
+        .setDescriptorSetCount(1)
+        .setPSetLayouts(&context->texture_table_layout);
+
+    if (this->logical_device.allocateDescriptorSets(&allocation_info, &this->descriptor_set) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create texture table descriptor set.");
+    }
+}
+
+/**
+ * A single white texel, sampled by empty slots.
+ */
+void TextureTable::create_fallback_texture()
+{
+    std::shared_ptr<Context> context = this->context.lock();
+
+    vk::ImageCreateInfo image_info = vk::ImageCreateInfo()
+        .setImageType(vk::ImageType::e2D)
+        .setExtent({1, 1, 1})
+        .setMipLevels(1)
+        .setArrayLayers(1)
+        .setFormat(vk::Format::eR8G8B8A8Unorm)
+        .setTiling(vk::ImageTiling::eOptimal)
+        .setInitialLayout(vk::ImageLayout::eUndefined)
+        .setUsage(vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled)
+        .setSamples(vk::SampleCountFlagBits::e1)
+        .setSharingMode(vk::SharingMode::eExclusive);
+
+    if (this->logical_device.createImage(&image_info, nullptr, &this->fallback_image) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create fallback texture image.");
+    }
+
+    vk::MemoryRequirements memory_requirements;
+    this->logical_device.getImageMemoryRequirements(this->fallback_image, &memory_requirements);
+
+    vk::MemoryAllocateInfo allocation_info = vk::MemoryAllocateInfo()
+        .setAllocationSize(memory_requirements.size)
+        .setMemoryTypeIndex(
+            context->find_memory_type(
+                memory_requirements.memoryTypeBits,
+                vk::MemoryPropertyFlagBits::eDeviceLocal
+            )
+        );
+
+    if (this->logical_device.allocateMemory(&allocation_info, nullptr, &this->fallback_memory) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't allocate fallback texture memory.");
+    }
+
+    this->logical_device.bindImageMemory(this->fallback_image, this->fallback_memory, 0);
+
+    vk::ImageSubresourceRange subresource_range = vk::ImageSubresourceRange()
+        .setAspectMask(vk::ImageAspectFlagBits::eColor)
+        .setBaseMipLevel(0)
+        .setLevelCount(1)
+        .setBaseArrayLayer(0)
+        .setLayerCount(1);
+
+    vk::ImageMemoryBarrier transfer_barrier = vk::ImageMemoryBarrier()
+        .setOldLayout(vk::ImageLayout::eUndefined)
+        .setNewLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setDstAccessMask(vk::AccessFlagBits::eTransferWrite)
+        .setImage(this->fallback_image)
+        .setSubresourceRange(subresource_range);
+
+    vk::ImageMemoryBarrier shader_barrier = vk::ImageMemoryBarrier()
+        .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+        .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+        .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+        .setImage(this->fallback_image)
+        .setSubresourceRange(subresource_range);
+
+    vk::ClearColorValue white = vk::ClearColorValue().setFloat32({1.0f, 1.0f, 1.0f, 1.0f});
+
+    context->run_one_time_commands([&](vk::CommandBuffer command_buffer){
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTopOfPipe,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlags(),
+            0, nullptr,
+            0, nullptr,
+            1, &transfer_barrier
+        );
+
+        command_buffer.clearColorImage(
+            this->fallback_image,
+            vk::ImageLayout::eTransferDstOptimal,
+            &white,
+            1,
+            &subresource_range
+        );
+
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eFragmentShader,
+            vk::DependencyFlags(),
+            0, nullptr,
+            0, nullptr,
+            1, &shader_barrier
+        );
+    });
+
+    vk::ImageViewCreateInfo view_info = vk::ImageViewCreateInfo()
+        .setImage(this->fallback_image)
+        .setViewType(vk::ImageViewType::e2DArray)
+        .setFormat(vk::Format::eR8G8B8A8Unorm)
+        .setSubresourceRange(subresource_range);
+
+    if (this->logical_device.createImageView(&view_info, nullptr, &this->fallback_view) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create fallback texture image view.");
+    }
+
+    vk::SamplerCreateInfo sampler_info = vk::SamplerCreateInfo()
+        .setMagFilter(vk::Filter::eNearest)
+        .setMinFilter(vk::Filter::eNearest)
+        .setAddressModeU(vk::SamplerAddressMode::eClampToEdge)
+        .setAddressModeV(vk::SamplerAddressMode::eClampToEdge)
+        .setAddressModeW(vk::SamplerAddressMode::eClampToEdge)
+        .setBorderColor(vk::BorderColor::eIntOpaqueBlack)
+        .setCompareOp(vk::CompareOp::eAlways)
+        .setMipmapMode(vk::SamplerMipmapMode::eNearest);
+
+    if (this->logical_device.createSampler(&sampler_info, nullptr, &this->fallback_sampler) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create fallback texture sampler.");
+    }
+}
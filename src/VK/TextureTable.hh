@@ -0,0 +1,69 @@
+#pragma once
+
+#define VULKAN_HPP_DISABLE_ENHANCED_MODE 1
+#include <vulkan/vulkan.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <map>
+
+namespace Animate::VK
+{
+    class Context;
+
+    /**
+     * One descriptor set holding every loaded texture, bound once per frame for all pipelines.
+     * Shaders pick a texture by slot, pushed with each draw.
+     *
+     * Slot 0 is a white texel, as is any slot not in use, so every slot is always valid.
+     */
+    class TextureTable
+    {
+        public:
+            TextureTable(std::weak_ptr<Context> context);
+            ~TextureTable();
+
+            vk::DescriptorSet get_descriptor_set() const;
+            uint32_t get_slot_count() const;
+
+            uint32_t allocate(vk::ImageView image_view, vk::Sampler sampler);
+            uint32_t reserve();
+            void update(uint32_t slot, vk::ImageView image_view, vk::Sampler sampler);
+            void clear(uint32_t slot);
+            void release(uint32_t slot);
+
+            bool has_pending_writes();
+            bool writes_need_idle_queue() const;
+            void flush();
+
+        private:
+            struct Entry {
+                vk::ImageView image_view;
+                vk::Sampler sampler;
+            };
+
+            std::weak_ptr<Context> context;
+            vk::Device logical_device;
+
+            vk::DescriptorPool descriptor_pool;
+            vk::DescriptorSet descriptor_set;
+            uint32_t slot_count;
+            bool update_after_bind;
+
+            vk::Image fallback_image;
+            vk::DeviceMemory fallback_memory;
+            vk::ImageView fallback_view;
+            vk::Sampler fallback_sampler;
+
+            std::mutex mutex;
+            std::vector<uint32_t> free_slots;
+            uint32_t next_slot = 1;
+
+            //Written by flush on the render thread, so sets in use are never touched mid frame
+            std::map<uint32_t, Entry> pending_writes;
+
+            void create_descriptor_set();
+            void create_fallback_texture();
+    };
+}
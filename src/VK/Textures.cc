@@ -1,40 +1,124 @@
 #include "Textures.hh"
-#include "../AppContext.hh"
+#include "TextureTable.hh"
+#include "Context.hh"
 
 using namespace Animate::VK;
 
-Textures::Textures(std::weak_ptr<Context> context, std::vector<std::string> resources) : context(context)
+/**
+ * Constructor.
+ * Reserves a texture table slot, nothing is loaded until first use.
+ */
+Textures::Textures(std::weak_ptr<Context> context, std::vector<std::string> resources, bool streamed) :
+    context(context),
+    resources(resources),
+    streamed(streamed)
 {
-    this->array_texture.reset(new Texture(this->context, resources));
+    std::shared_ptr<TextureTable> texture_table = context.lock()->get_texture_table();
+    this->texture_table = texture_table;
+    this->slot = texture_table->reserve();
+}
 
-    uint32_t i=0;
-    for(auto const& resource : resources) {
-        this->texture_layers.insert(std::pair(resource, i++));
+Textures::~Textures()
+{
+    if (std::shared_ptr<TextureTable> texture_table = this->texture_table.lock()) {
+        texture_table->release(this->slot);
     }
 }
 
 std::weak_ptr<Texture> Textures::get_texture()
 {
+    std::lock_guard<std::mutex> guard(this->texture_mutex);
     return this->array_texture;
 }
 
-uint32_t Textures::get_layer(std::string resource_id)
+/**
+ * Where a resource was packed in the atlas, the whole first page if it isn't part of it.
+ * Loads the textures if this is their first use.
+ */
+TextureRegion Textures::get_region(std::string resource_id)
 {
-    std::map< std::string, uint32_t >::iterator it = this->texture_layers.find(resource_id);
+    this->make_resident();
 
-    if (it != this->texture_layers.end()) {
+    std::lock_guard<std::mutex> guard(this->texture_mutex);
+    std::map< std::string, TextureRegion >::iterator it = this->texture_regions.find(resource_id);
+
+    if (it != this->texture_regions.end()) {
         return it->second;
     }
 
-    return 0;
+    TextureRegion region;
+    region.slot = this->slot;
+    return region;
+}
+
+/**
+ * Load the textures to the GPU if they aren't already, blocking until the resident levels are uploaded.
+ */
+void Textures::make_resident()
+{
+    std::lock_guard<std::mutex> load_guard(this->load_mutex);
+
+    if (this->is_resident()) {
+        return;
+    }
+
+    std::shared_ptr<Texture> texture = std::make_shared<Texture>(this->context, this->resources, this->slot, this->streamed);
+
+    std::lock_guard<std::mutex> guard(this->texture_mutex);
+    this->array_texture = texture;
+
+    //Packing is deterministic so later loads put each image back where it was
+    if (this->texture_regions.empty()) {
+        size_t i=0;
+        for(auto const& resource : this->resources) {
+            this->texture_regions.insert(std::pair(resource, this->array_texture->get_region(i++)));
+        }
+    }
 }
 
-vk::ImageView Textures::get_image_view()
+bool Textures::is_resident()
 {
-    return this->array_texture->get_image_view();
+    std::lock_guard<std::mutex> guard(this->texture_mutex);
+    return static_cast<bool>(this->array_texture);
 }
 
-vk::Sampler Textures::get_sampler()
+/**
+ * Give up the GPU texture, pointing the slot back at the fallback.
+ * Frames in flight may still sample it, so it's returned to be destroyed once the queue is idle.
+ *
+ * @return The evicted texture, or null if there was none or it's still streaming.
+ */
+std::shared_ptr<Texture> Textures::evict()
 {
-    return this->array_texture->get_sampler();
-}
\ No newline at end of file
+    std::lock_guard<std::mutex> guard(this->texture_mutex);
+
+    if (!this->array_texture || this->array_texture->is_streaming()) {
+        return nullptr;
+    }
+
+    if (std::shared_ptr<TextureTable> texture_table = this->texture_table.lock()) {
+        texture_table->clear(this->slot);
+    }
+
+    std::shared_ptr<Texture> texture;
+    texture.swap(this->array_texture);
+    return texture;
+}
+
+vk::DeviceSize Textures::get_memory_size()
+{
+    std::lock_guard<std::mutex> guard(this->texture_mutex);
+    return this->array_texture ? this->array_texture->get_memory_size() : 0;
+}
+
+bool Textures::has_streamed_view()
+{
+    std::lock_guard<std::mutex> guard(this->texture_mutex);
+    return this->array_texture && this->array_texture->has_streamed_view();
+}
+
+bool Textures::commit_streamed_view()
+{
+    std::lock_guard<std::mutex> guard(this->texture_mutex);
+    return this->array_texture && this->array_texture->commit_streamed_view();
+}
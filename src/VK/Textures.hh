@@ -4,27 +4,50 @@
 #include <map>
 #include <vector>
 #include <memory>
+#include <mutex>
 
 #include "Texture.hh"
 
 namespace Animate::VK
 {
+    class TextureTable;
+
+    /**
+     * A pipeline's textures, loaded to the GPU on first use and evictable by the TextureCache.
+     * The texture table slot and the atlas regions stay the same while evicted, so drawables
+     * holding regions keep working once the texture is loaded again.
+     */
     class Textures
     {
         public:
-            Textures(std::weak_ptr<Context> context, std::vector<std::string> resources);
+            Textures(std::weak_ptr<Context> context, std::vector<std::string> resources, bool streamed = false);
+            ~Textures();
 
             std::weak_ptr<Texture> get_texture();
-            uint32_t get_layer(std::string resource_id);
+            TextureRegion get_region(std::string resource_id);
+
+            void make_resident();
+            bool is_resident();
+            std::shared_ptr<Texture> evict();
+            vk::DeviceSize get_memory_size();
 
-            vk::ImageView get_image_view();
-            vk::Sampler get_sampler();
+            bool has_streamed_view();
+            bool commit_streamed_view();
 
         protected:
             std::weak_ptr<Context> context;
+            std::vector<std::string> resources;
+            bool streamed;
+
+            std::weak_ptr<TextureTable> texture_table;
+            uint32_t slot;
 
+            //Held while loading, the render loop only ever takes texture_mutex
+            std::mutex load_mutex;
+            std::mutex texture_mutex;
             std::shared_ptr<Texture> array_texture;
 
-            std::map< std::string, uint32_t> texture_layers;
+            //Filled by the first load
+            std::map< std::string, TextureRegion> texture_regions;
     };
 }
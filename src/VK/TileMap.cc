@@ -0,0 +1,319 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "TileMap.hh"
+#include "Context.hh"
+#include "Buffer.hh"
+
+using namespace Animate::VK;
+
+//Past this many changed cells one copy of the whole grid is cheaper than a copy per cell
+static const size_t max_cell_copies = 4096;
+
+/**
+ * Constructor.
+ * Every cell starts as kind 0.
+ *
+ * @param width  Cells across.
+ * @param height Cells down.
+ */
+TileMap::TileMap(std::weak_ptr<Context> context, uint32_t width, uint32_t height) :
+    context(context),
+    width(width),
+    height(height),
+    cells(width * height, 0),
+    is_changed(width * height, false)
+{
+    if (width == 0 || height == 0) {
+        throw std::runtime_error("Invalid tile map size given.");
+    }
+
+    this->logical_device = context.lock()->logical_device;
+
+    this->staging_buffer = context.lock()->create_buffer(
+        this->cells.size() * sizeof(uint32_t),
+        vk::BufferUsageFlagBits::eTransferSrc,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+    );
+
+    this->create_image();
+    this->create_sampler();
+}
+
+/**
+ * Destructor.
+ */
+TileMap::~TileMap()
+{
+    this->logical_device.waitIdle();
+
+    if (!this->context.expired()) {
+        this->context.lock()->release_buffer(this->staging_buffer);
+    }
+
+    if (this->sampler) {
+        this->logical_device.destroySampler(this->sampler, nullptr);
+    }
+
+    if (this->image_view) {
+        this->logical_device.destroyImageView(this->image_view, nullptr);
+    }
+
+    if (this->image) {
+        this->logical_device.destroyImage(this->image, nullptr);
+    }
+
+    if (this->memory) {
+        this->logical_device.freeMemory(this->memory, nullptr);
+    }
+}
+
+void TileMap::create_image()
+{
+    std::shared_ptr<Context> context = this->context.lock();
+
+    vk::ImageCreateInfo create_info = vk::ImageCreateInfo()
+        .setImageType(vk::ImageType::e2D)
+        .setExtent({this->width, this->height, 1})
+        .setMipLevels(1)
+        .setArrayLayers(1)
+        .setFormat(vk::Format::eR32Uint)
+        .setTiling(vk::ImageTiling::eOptimal)
+        .setInitialLayout(vk::ImageLayout::eUndefined)
+        .setUsage(vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled)
+        .setSamples(vk::SampleCountFlagBits::e1)
+        .setSharingMode(vk::SharingMode::eExclusive);
+
+    if (this->logical_device.createImage(&create_info, nullptr, &this->image) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create tile map image.");
+    }
+
+    vk::MemoryRequirements memory_requirements;
+    this->logical_device.getImageMemoryRequirements(this->image, &memory_requirements);
+
+    vk::MemoryAllocateInfo allocation_info = vk::MemoryAllocateInfo()
+        .setAllocationSize(memory_requirements.size)
+        .setMemoryTypeIndex(
+            context->find_memory_type(
+                memory_requirements.memoryTypeBits,
+                vk::MemoryPropertyFlagBits::eDeviceLocal
+            )
+        );
+
+    if (this->logical_device.allocateMemory(&allocation_info, nullptr, &this->memory) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't allocate tile map memory.");
+    }
+
+    this->logical_device.bindImageMemory(this->image, this->memory, 0);
+
+    vk::ImageViewCreateInfo view_info = vk::ImageViewCreateInfo()
+        .setImage(this->image)
+        .setViewType(vk::ImageViewType::e2D)
+        .setFormat(vk::Format::eR32Uint)
+        .setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
+
+    if (this->logical_device.createImageView(&view_info, nullptr, &this->image_view) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create tile map image view.");
+    }
+}
+
+/**
+ * Integer images can't be filtered, and the shaders only fetch texels anyway.
+ */
+void TileMap::create_sampler()
+{
+    vk::SamplerCreateInfo create_info = vk::SamplerCreateInfo()
+        .setMagFilter(vk::Filter::eNearest)
+        .setMinFilter(vk::Filter::eNearest)
+        .setAddressModeU(vk::SamplerAddressMode::eClampToEdge)
+        .setAddressModeV(vk::SamplerAddressMode::eClampToEdge)
+        .setAddressModeW(vk::SamplerAddressMode::eClampToEdge)
+        .setAnisotropyEnable(VK_FALSE)
+        .setMaxAnisotropy(1)
+        .setBorderColor(vk::BorderColor::eIntOpaqueBlack)
+        .setUnnormalizedCoordinates(VK_FALSE)
+        .setCompareEnable(VK_FALSE)
+        .setCompareOp(vk::CompareOp::eAlways)
+        .setMipmapMode(vk::SamplerMipmapMode::eNearest);
+
+    if (this->logical_device.createSampler(&create_info, nullptr, &this->sampler) != vk::Result::eSuccess) {
+        throw std::runtime_error("Couldn't create tile map sampler.");
+    }
+}
+
+/**
+ * Change the kind of one cell, copied in with the next frame.
+ */
+void TileMap::set_cell(uint32_t cell, uint32_t tile_type)
+{
+    if (cell >= this->cells.size() || tile_type >= TileMap::max_tile_types) {
+        throw std::runtime_error("Invalid tile map cell given.");
+    }
+
+    std::lock_guard<std::mutex> guard(this->cell_mutex);
+
+    if (this->cells[cell] == tile_type) {
+        return;
+    }
+
+    this->cells[cell] = tile_type;
+
+    if (!this->is_changed[cell]) {
+        this->is_changed[cell] = true;
+        this->changed_cells.push_back(cell);
+    }
+}
+
+/**
+ * Change every cell, copied in with the next frame.
+ */
+void TileMap::set_cells(std::vector<uint32_t> const& tile_types)
+{
+    if (tile_types.size() != this->cells.size()) {
+        throw std::runtime_error("Wrong number of tile map cells given.");
+    }
+
+    std::lock_guard<std::mutex> guard(this->cell_mutex);
+
+    this->cells = tile_types;
+    this->full_upload = true;
+}
+
+/**
+ * Copy the cells changed since the last frame into the image, before anything samples it.
+ * Must be recorded outside a render pass.
+ */
+void TileMap::record(vk::CommandBuffer command_buffer)
+{
+    std::lock_guard<std::mutex> guard(this->cell_mutex);
+
+    if (this->changed_cells.size() > max_cell_copies) {
+        this->full_upload = true;
+    }
+
+    if (!this->full_upload && this->changed_cells.empty()) {
+        return;
+    }
+
+    //Frames still in flight may copy from the staging buffer while it's written, but it only
+    //ever holds the latest cells so they'd copy the same or newer values
+    std::shared_ptr<Buffer> staging_buffer = this->staging_buffer.lock();
+    uint32_t *staged_cells = static_cast<uint32_t *>(staging_buffer->map());
+
+    std::vector<vk::BufferImageCopy> copy_regions;
+    if (this->full_upload) {
+        memcpy(staged_cells, this->cells.data(), this->cells.size() * sizeof(uint32_t));
+
+        copy_regions.push_back(
+            vk::BufferImageCopy()
+                .setBufferOffset(0)
+                .setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1))
+                .setImageExtent({this->width, this->height, 1})
+        );
+    } else {
+        copy_regions.reserve(this->changed_cells.size());
+        for (uint32_t cell : this->changed_cells) {
+            staged_cells[cell] = this->cells[cell];
+
+            copy_regions.push_back(
+                vk::BufferImageCopy()
+                    .setBufferOffset(cell * sizeof(uint32_t))
+                    .setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1))
+                    .setImageOffset({static_cast<int32_t>(cell % this->width), static_cast<int32_t>(cell / this->width), 0})
+                    .setImageExtent({1, 1, 1})
+            );
+        }
+    }
+
+    staging_buffer->unmap();
+
+    for (uint32_t cell : this->changed_cells) {
+        this->is_changed[cell] = false;
+    }
+    this->changed_cells.clear();
+
+    vk::ImageSubresourceRange range(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+
+    //Don't overwrite the image while the last frame is still sampling it.
+    //Until the first upload there's nothing worth keeping.
+    vk::ImageMemoryBarrier transfer_barrier = vk::ImageMemoryBarrier()
+        .setOldLayout(this->uploaded ? vk::ImageLayout::eShaderReadOnlyOptimal : vk::ImageLayout::eUndefined)
+        .setNewLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setSrcAccessMask(vk::AccessFlagBits::eShaderRead)
+        .setDstAccessMask(vk::AccessFlagBits::eTransferWrite)
+        .setImage(this->image)
+        .setSubresourceRange(range);
+
+    vk::ImageMemoryBarrier shader_barrier = vk::ImageMemoryBarrier()
+        .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+        .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+        .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+        .setImage(this->image)
+        .setSubresourceRange(range);
+
+    command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eFragmentShader,
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::DependencyFlags(),
+        0, nullptr,
+        0, nullptr,
+        1, &transfer_barrier
+    );
+
+    command_buffer.copyBufferToImage(
+        staging_buffer->get_ident(),
+        this->image,
+        vk::ImageLayout::eTransferDstOptimal,
+        copy_regions.size(),
+        copy_regions.data()
+    );
+
+    command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eFragmentShader,
+        vk::DependencyFlags(),
+        0, nullptr,
+        0, nullptr,
+        1, &shader_barrier
+    );
+
+    this->full_upload = false;
+    this->uploaded = true;
+}
+
+/**
+ * The uniform block telling the shaders the grid size and where each kind of cell's image is.
+ *
+ * @param tile_types Each kind's image, kind 0 first. Images are sampled whole.
+ */
+TileMap::Uniforms TileMap::get_uniforms(std::vector<TextureRegion> const& tile_types)
+{
+    if (tile_types.size() > TileMap::max_tile_types) {
+        throw std::runtime_error("Too many tile types given.");
+    }
+
+    Uniforms uniforms = {};
+    uniforms.width = this->width;
+    uniforms.height = this->height;
+
+    for (size_t i = 0; i < tile_types.size(); i++) {
+        uniforms.regions[i][0] = tile_types[i].u;
+        uniforms.regions[i][1] = tile_types[i].v;
+        uniforms.regions[i][2] = tile_types[i].width;
+        uniforms.regions[i][3] = tile_types[i].height;
+        uniforms.pages[i][0] = static_cast<float>(tile_types[i].page);
+    }
+
+    return uniforms;
+}
+
+vk::ImageView TileMap::get_image_view()
+{
+    return this->image_view;
+}
+
+vk::Sampler TileMap::get_sampler()
+{
+    return this->sampler;
+}
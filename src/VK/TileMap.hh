@@ -0,0 +1,82 @@
+#pragma once
+
+#define VULKAN_HPP_DISABLE_ENHANCED_MODE 1
+#include <vulkan/vulkan.hpp>
+#include <GLFW/glfw3.h>
+
+#include <vector>
+#include <mutex>
+#include <memory>
+
+#include "TextureRegion.hh"
+
+namespace Animate::VK
+{
+    class Context;
+    class Buffer;
+
+    /**
+     * The kind of each cell of a grid, one texel per cell, for pipelines created with
+     * RenderSettings::tile_mapped. Their fragment shader looks the kind up and samples that
+     * kind's image, so a whole grid is one quad and changing a cell is one texel.
+     */
+    class TileMap
+    {
+        public:
+            //Most kinds of cell a grid can show, matches TILE_TYPES in the shaders
+            static const uint32_t max_tile_types = 32;
+
+            /**
+             * The shaders' uniform block, std140.
+             */
+            struct Uniforms {
+                uint32_t width;
+                uint32_t height;
+                uint32_t padding[2];
+
+                //u, v, width and height of each kind's image
+                float regions[max_tile_types][4];
+
+                //Array layer of each kind's image, in x
+                float pages[max_tile_types][4];
+            };
+
+            TileMap(std::weak_ptr<Context> context, uint32_t width, uint32_t height);
+            ~TileMap();
+
+            void set_cell(uint32_t cell, uint32_t tile_type);
+            void set_cells(std::vector<uint32_t> const& tile_types);
+            void record(vk::CommandBuffer command_buffer);
+
+            Uniforms get_uniforms(std::vector<TextureRegion> const& tile_types);
+
+            vk::ImageView get_image_view();
+            vk::Sampler get_sampler();
+
+        private:
+            std::weak_ptr<Context> context;
+            vk::Device logical_device;
+
+            uint32_t width;
+            uint32_t height;
+
+            //Guards everything below, cells are set on the tick thread and recorded on the render thread
+            std::mutex cell_mutex;
+            std::vector<uint32_t> cells;
+            std::vector<uint32_t> changed_cells;
+            std::vector<bool> is_changed;
+            bool full_upload = true;
+            bool uploaded = false;
+
+            //Mirrors cells, copied into the image a texel at a time
+            std::weak_ptr<Buffer> staging_buffer;
+
+            vk::Image image;
+            vk::DeviceMemory memory;
+            vk::ImageView image_view;
+            vk::Sampler sampler;
+
+            void create_image();
+            void create_sampler();
+    };
+}
@@ -0,0 +1,198 @@
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <queue>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include <cstdlib>
+
+#include "../src/Animation/Cat/Search.hh"
+#include "../src/Animation/Cat/PatternDatabase.hh"
+#include "../src/Animation/Cat/TranspositionTable.hh"
+#include "../src/Tasks/ThreadPool.hh"
+
+using namespace Animate;
+using namespace Animate::Animation::Cat;
+
+//Written by pattern-db-builder before the checks run, see Makefile.am
+static const char *database_path = "pattern-3x3.pdb";
+
+static const int grid_size = 3;
+static const size_t board_count = 30;
+
+static uint64_t encode(std::vector<uint8_t> const& board)
+{
+    uint64_t key = 0;
+    for (uint8_t tile : board) {
+        key = key * board.size() + tile;
+    }
+    return key;
+}
+
+static std::vector<uint8_t> solved_board()
+{
+    std::vector<uint8_t> board(grid_size * grid_size);
+    for (size_t i = 0; i + 1 < board.size(); i++) {
+        board[i] = static_cast<uint8_t>(i + 1);
+    }
+    board.back() = 0;
+    return board;
+}
+
+/**
+ * Move the blank, false if it would leave the board.
+ */
+static bool apply(std::vector<uint8_t> &board, TaquinSolve::Moves move)
+{
+    int blank = static_cast<int>(std::find(board.begin(), board.end(), 0) - board.begin());
+    int to = -1;
+    switch (move) {
+        case TaquinSolve::Moves::UP:
+            to = blank >= grid_size ? blank - grid_size : -1;
+            break;
+        case TaquinSolve::Moves::DOWN:
+            to = blank < grid_size * (grid_size - 1) ? blank + grid_size : -1;
+            break;
+        case TaquinSolve::Moves::LEFT:
+            to = blank % grid_size > 0 ? blank - 1 : -1;
+            break;
+        case TaquinSolve::Moves::RIGHT:
+            to = blank % grid_size < grid_size - 1 ? blank + 1 : -1;
+            break;
+    }
+
+    if (to < 0) {
+        return false;
+    }
+
+    std::swap(board[blank], board[to]);
+    return true;
+}
+
+/**
+ * Whether the moves take the board to the solved one.
+ */
+static bool replays_to_goal(std::vector<uint8_t> board, std::queue<TaquinSolve::Moves> move_sequence)
+{
+    while (!move_sequence.empty()) {
+        if (!apply(board, move_sequence.front())) {
+            return false;
+        }
+        move_sequence.pop();
+    }
+
+    return board == solved_board();
+}
+
+/**
+ * Fewest moves to every solvable board, by breadth first search back from the solved one.
+ */
+static std::unordered_map<uint64_t, size_t> reference_distances()
+{
+    static const TaquinSolve::Moves moves[4] = {
+        TaquinSolve::Moves::UP,
+        TaquinSolve::Moves::DOWN,
+        TaquinSolve::Moves::LEFT,
+        TaquinSolve::Moves::RIGHT
+    };
+
+    std::unordered_map<uint64_t, size_t> distances;
+    std::queue< std::vector<uint8_t> > open;
+
+    distances[encode(solved_board())] = 0;
+    open.push(solved_board());
+
+    while (!open.empty()) {
+        std::vector<uint8_t> board = open.front();
+        open.pop();
+        size_t distance = distances[encode(board)];
+
+        for (TaquinSolve::Moves move : moves) {
+            std::vector<uint8_t> next = board;
+            if (apply(next, move) && distances.emplace(encode(next), distance + 1).second) {
+                open.push(next);
+            }
+        }
+    }
+
+    return distances;
+}
+
+static std::vector< std::vector<uint8_t> > generate_boards()
+{
+    std::mt19937 generator(1);
+    std::vector< std::vector<uint8_t> > boards;
+
+    while (boards.size() < board_count) {
+        std::vector<uint8_t> board = solved_board();
+        std::shuffle(board.begin(), board.end(), generator);
+        if (Search::is_solvable(board, grid_size)) {
+            boards.push_back(board);
+        }
+    }
+
+    return boards;
+}
+
+/**
+ * Optimal and realtime Cat solves of random 3x3 boards, checked against breadth first search.
+ */
+int main(void)
+{
+    std::ifstream file(database_path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Couldn't read: " << database_path << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    PatternDatabase database(data.data(), data.size());
+
+    std::unordered_map<uint64_t, size_t> distances = reference_distances();
+    std::vector< std::vector<uint8_t> > boards = generate_boards();
+
+    Tasks::ThreadPool thread_pool(3);
+    TranspositionTable table;
+    std::atomic_bool cancelled = false;
+
+    int failures = 0;
+
+    //Every combination of pattern database, threads and transposition table
+    for (int configuration = 0; configuration < 8; configuration++) {
+        bool use_database = configuration & 1;
+        bool use_threads = configuration & 2;
+        bool use_table = configuration & 4;
+
+        for (std::vector<uint8_t> const& board : boards) {
+            std::queue<TaquinSolve::Moves> move_sequence;
+            bool solved = Search::solve_optimal(
+                board,
+                grid_size,
+                use_database ? &database : nullptr,
+                std::chrono::steady_clock::time_point::max(),
+                cancelled,
+                move_sequence,
+                use_threads ? &thread_pool : nullptr,
+                use_table ? &table : nullptr
+            );
+
+            if (!solved || move_sequence.size() != distances[encode(board)] || !replays_to_goal(board, move_sequence)) {
+                std::cerr << "Optimal solve wrong, configuration " << configuration
+                          << ": " << move_sequence.size() << " moves, expected " << distances[encode(board)] << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    for (std::vector<uint8_t> const& board : boards) {
+        if (!replays_to_goal(board, Search::solve_realtime(board, grid_size))) {
+            std::cerr << "Realtime solution doesn't reach the goal." << std::endl;
+            failures++;
+        }
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <string>
+#include <cstdlib>
+
+#include "../src/Tools/BlockEncoder.hh"
+#include "../src/VK/BlockDecoder.hh"
+
+using namespace Animate;
+
+/**
+ * An RGBA8 image and how far its decoded pixels may stray from it, per channel.
+ */
+struct Image {
+    std::string name;
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> pixels;
+    int max_error;
+    double max_mean_error;
+};
+
+static Image make_image(std::string name, uint32_t width, uint32_t height, int max_error, double max_mean_error)
+{
+    return Image{name, width, height, std::vector<uint8_t>(width * height * 4), max_error, max_mean_error};
+}
+
+/**
+ * Bake an image to ETC2 and decode it again, as devices without ETC2 or BC7 do.
+ *
+ * @return Whether every pixel came back close enough.
+ */
+static bool check_image(Image const& image)
+{
+    uint32_t blocks_across = (image.width + 3) / 4;
+    uint32_t blocks_down = (image.height + 3) / 4;
+    uint32_t block_row_pitch = blocks_across * 16;
+
+    std::vector<uint8_t> blocks(block_row_pitch * blocks_down);
+    Tools::BlockEncoder::encode_etc2_rgba(image.pixels.data(), image.width, image.height, blocks.data(), block_row_pitch);
+
+    //Padded rows, so pixels written past a row's end would show up
+    uint32_t row_pitch = image.width * 4 + 12;
+    std::vector<uint8_t> decoded(row_pitch * image.height, 0xcd);
+    VK::BlockDecoder::decode_etc2_rgba(blocks.data(), block_row_pitch, image.width, image.height, decoded.data(), row_pitch);
+
+    int max_error = 0;
+    uint64_t total_error = 0;
+    for (uint32_t y = 0; y < image.height; y++) {
+        for (uint32_t x = 0; x < image.width * 4; x++) {
+            int error = std::abs(decoded[y * row_pitch + x] - image.pixels[(y * image.width) * 4 + x]);
+            max_error = std::max(max_error, error);
+            total_error += error;
+        }
+
+        for (uint32_t x = image.width * 4; x < row_pitch; x++) {
+            if (decoded[y * row_pitch + x] != 0xcd) {
+                std::cerr << image.name << ": decoded past the end of row " << y << std::endl;
+                return false;
+            }
+        }
+    }
+
+    double mean_error = static_cast<double>(total_error) / (image.width * image.height * 4);
+    if (max_error > image.max_error || mean_error > image.max_mean_error) {
+        std::cerr << image.name << ": error up to " << max_error << ", mean " << mean_error << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * ETC2 round trips through texture-baker's encoder and the runtime fallback decoder.
+ */
+int main(void)
+{
+    std::vector<Image> images;
+
+    //Flat colours, including ones between ETC's 4 and 5 bit steps, edge sized
+    Image solid = make_image("solid", 13, 7, 4, 1.);
+    for (uint32_t i = 0; i < solid.width * solid.height; i++) {
+        uint8_t colour[4] = {200, 37, 91, 255};
+        std::copy(colour, colour + 4, &solid.pixels[i * 4]);
+    }
+    images.push_back(solid);
+
+    //Smooth gradients with a fading alpha, where every block is different
+    Image gradient = make_image("gradient", 64, 48, 24, 4.);
+    for (uint32_t y = 0; y < gradient.height; y++) {
+        for (uint32_t x = 0; x < gradient.width; x++) {
+            uint8_t *pixel = &gradient.pixels[(y * gradient.width + x) * 4];
+            pixel[0] = static_cast<uint8_t>(x * 4);
+            pixel[1] = static_cast<uint8_t>(y * 5);
+            pixel[2] = static_cast<uint8_t>(255 - x * 2);
+            pixel[3] = static_cast<uint8_t>(x * 255 / (gradient.width - 1));
+        }
+    }
+    images.push_back(gradient);
+
+    //Hard edges between light and dark shades, and between opaque and clear
+    Image edges = make_image("edges", 37, 21, 24, 4.);
+    for (uint32_t y = 0; y < edges.height; y++) {
+        for (uint32_t x = 0; x < edges.width; x++) {
+            uint8_t *pixel = &edges.pixels[(y * edges.width + x) * 4];
+            bool dark = (x / 3 + y / 2) % 2 == 0;
+            pixel[0] = dark ? 40 : 200;
+            pixel[1] = dark ? 50 : 210;
+            pixel[2] = dark ? 70 : 230;
+            pixel[3] = dark ? 255 : 0;
+        }
+    }
+    images.push_back(edges);
+
+    //Noise, only checked to be in the right neighbourhood
+    Image noise = make_image("noise", 32, 32, 255, 40.);
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int> distribution(0, 255);
+    for (uint8_t &channel : noise.pixels) {
+        channel = static_cast<uint8_t>(distribution(generator));
+    }
+    images.push_back(noise);
+
+    int failures = 0;
+    for (Image const& image : images) {
+        if (!check_image(image)) {
+            failures++;
+        }
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <queue>
+#include <random>
+#include <cstdlib>
+
+#include "../src/Animation/Minesweeper/Search.hh"
+
+using namespace Animate::Animation::Minesweeper;
+
+static const int fields_per_size = 50;
+
+/**
+ * Solve one random field and replay its operations.
+ *
+ * @return Whether every operation was one a careful player could make.
+ */
+static bool check_field(uint32_t width, uint32_t height, uint32_t mine_count, std::mt19937 &generator)
+{
+    std::uniform_int_distribution<uint32_t> cells(0, width * height - 1);
+    uint32_t first_flip = cells(generator);
+
+    Field field = Field::generate(width, height, mine_count, first_flip, generator);
+
+    std::queue<Operation> move_sequence;
+    MapStatus status = Search::solve(field, first_flip, generator, move_sequence);
+
+    if (move_sequence.empty() || move_sequence.front().type != OperationType::FLIP || move_sequence.front().position != first_flip) {
+        std::cerr << "Solution doesn't start with the first flip." << std::endl;
+        return false;
+    }
+
+    while (!move_sequence.empty()) {
+        Operation operation = move_sequence.front();
+        move_sequence.pop();
+
+        if (field.get_status() != MapStatus::IN_PROGRESS) {
+            std::cerr << "Operation on cell " << operation.position << " after the game ended." << std::endl;
+            return false;
+        }
+
+        TileState tile = field.get_tile(operation.position);
+        if (tile.flipped || tile.flagged) {
+            std::cerr << "Operation on cell " << operation.position << " repeated." << std::endl;
+            return false;
+        }
+
+        if (operation.type == OperationType::FLAG && !tile.mine) {
+            std::cerr << "Safe cell " << operation.position << " flagged." << std::endl;
+            return false;
+        }
+
+        field.apply(operation);
+    }
+
+    if (field.get_status() != status || status == MapStatus::IN_PROGRESS) {
+        std::cerr << "Solution doesn't finish the game." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Minesweeper solves of random fields, from sparse to dense, replayed move by move.
+ */
+int main(void)
+{
+    std::mt19937 generator(1);
+    int failures = 0;
+
+    struct Size {
+        uint32_t width;
+        uint32_t height;
+        uint32_t mine_count;
+    };
+
+    static const Size sizes[] = {
+        {9, 9, 10},
+        {16, 16, 40},
+        {30, 16, 99},
+        {64, 64, 650}
+    };
+
+    for (Size const& size : sizes) {
+        for (int i = 0; i < fields_per_size; i++) {
+            if (!check_field(size.width, size.height, size.mine_count, generator)) {
+                failures++;
+            }
+        }
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}